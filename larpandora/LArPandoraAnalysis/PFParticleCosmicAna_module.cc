@@ -11,6 +11,7 @@
 
 #include "TTree.h"
 
+#include <map>
 #include <string>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -500,6 +501,10 @@ void PFParticleCosmicAna::FillTrueTree(const HitVector &hitVector, const HitsToM
     m_nCosmicHitsNotReconstructed = 0;
     m_nCosmicHitsReconstructed = 0;
 
+    // Evaluate the cosmic score once per reconstructed particle, rather than once per hit
+    typedef std::map< art::Ptr<recob::PFParticle>, float > PFParticleScoreMap;
+    PFParticleScoreMap cosmicScores;
+
     for (HitVector::const_iterator iter2 = hitVector.begin(), iterEnd2 = hitVector.end(); iter2 != iterEnd2; ++iter2)
     {
         const art::Ptr<recob::Hit> hit = *iter2;
@@ -522,7 +527,15 @@ void PFParticleCosmicAna::FillTrueTree(const HitVector &hitVector, const HitsToM
         if (recoHitsToParticles.end() != iter5)
 	{
 	    const art::Ptr<recob::PFParticle> particle = iter5->second;
-            cosmicScore = this->GetCosmicScore(particle, particlesToTracks, tracksToCosmicTags);
+            PFParticleScoreMap::const_iterator iter6 = cosmicScores.find(particle);
+
+            if (cosmicScores.end() == iter6)
+            {
+                const float particleScore(this->GetCosmicScore(particle, particlesToTracks, tracksToCosmicTags));
+                iter6 = cosmicScores.insert(PFParticleScoreMap::value_type(particle, particleScore)).first;
+            }
+
+            cosmicScore = iter6->second;
 	}
 
         ++m_nHits;
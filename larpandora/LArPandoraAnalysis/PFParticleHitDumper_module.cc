@@ -11,8 +11,10 @@
 #include "TTree.h"
 
 #include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
+#include "larpandora/LArPandoraInterface/LArPandoraHitSoA.h"
 
 #include <string>
+#include <vector>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
@@ -65,16 +67,17 @@ private:
      *  @brief Store 2D hits
      *
      *  @param hitVector the input vector of 2D hits
+     *  @param hitSoA the structure-of-arrays snapshot of the 2D hits
      *  @param hitsToParticles mapping between 2D hits and PFParticles
      */
-     void FillReco2D(const HitVector &hitVector, const HitsToPFParticles &hitsToParticles);
+     void FillReco2D(const HitVector &hitVector, const HitSoA &hitSoA, const HitsToPFParticles &hitsToParticles);
     
     /**
      *  @brief Store raw data
      *
-     *  @param wireVector the input vector of reconstructed wires
+     *  @param wireCollection the input view of the reconstructed wires
      */
-     void FillRecoWires(const WireVector &wireVector);
+     void FillRecoWires(const WireCollection &wireCollection);
 
     /**
      *  @brief Conversion from wire ID to U/V/W coordinate
@@ -103,6 +106,18 @@ private:
      */
      double YZtoV(const unsigned int cstat, const unsigned int tpc, const double y, const double z) const;
 
+    /**
+     *  @brief Apply the configured basket size and compression level to all branches of a tree
+     *
+     *  @param pTree the address of the tree
+     */
+     void ConfigureTree(TTree *const pTree) const;
+
+    /**
+     *  @brief Clear the per-event columns of the columnar output
+     */
+     void ClearColumns();
+
      TTree       *m_pRecoTracks;     ///<
      TTree       *m_pReco3D;         ///< 
      TTree       *m_pReco2D;         ///<
@@ -127,6 +142,21 @@ private:
      double       m_z;               ///<
      double       m_q;               ///<
 
+     std::vector<int>   m_particleColumn;   ///< The particle ids of the current event (columnar output)
+     std::vector<int>   m_primaryColumn;    ///< Whether each particle is primary (columnar output)
+     std::vector<int>   m_pdgcodeColumn;    ///< The particle pdg codes (columnar output)
+     std::vector<int>   m_cstatColumn;      ///< The cryostat numbers (columnar output)
+     std::vector<int>   m_tpcColumn;        ///< The tpc numbers (columnar output)
+     std::vector<int>   m_planeColumn;      ///< The plane numbers (columnar output)
+     std::vector<int>   m_wireColumn;       ///< The wire numbers (columnar output)
+     std::vector<float> m_uColumn;          ///< The u coordinates (columnar output)
+     std::vector<float> m_vColumn;          ///< The v coordinates (columnar output)
+     std::vector<float> m_wColumn;          ///< The w coordinates (columnar output)
+     std::vector<float> m_xColumn;          ///< The x coordinates (columnar output)
+     std::vector<float> m_yColumn;          ///< The y coordinates (columnar output)
+     std::vector<float> m_zColumn;          ///< The z coordinates (columnar output)
+     std::vector<float> m_qColumn;          ///< The charges (columnar output)
+
      std::string  m_calwireLabel;    ///<
      std::string  m_hitfinderLabel;  ///<
      std::string  m_spacepointLabel; ///< 
@@ -134,6 +164,9 @@ private:
      std::string  m_trackLabel;      ///<
 
      bool         m_storeWires;      ///<
+     bool         m_columnarOutput;  ///< Whether to write one entry per event, with a vector branch per variable, rather than one per point
+     int          m_basketSize;      ///< The basket size of the output branches [bytes] (0: ROOT default)
+     int          m_compressionLevel; ///< The compression level of the output branches (-1: output file default)
      bool         m_printDebug;      ///< switch for print statements (TODO: use message service!)
 };
 
@@ -168,6 +201,9 @@ DEFINE_ART_MODULE(PFParticleHitDumper)
 #include "lardata/DetectorInfoServices/DetectorPropertiesService.h"
 #include "lardata/Utilities/AssociationUtil.h"
 
+#include "TBranch.h"
+#include "TObjArray.h"
+
 #include <iostream>
 
 namespace lar_pandora
@@ -189,6 +225,9 @@ PFParticleHitDumper::~PFParticleHitDumper()
 void PFParticleHitDumper::reconfigure(fhicl::ParameterSet const &pset)
 {
     m_storeWires      = pset.get<bool>("StoreWires", false);
+    m_columnarOutput  = pset.get<bool>("ColumnarOutput", false);
+    m_basketSize      = pset.get<int>("BasketSize", 0);
+    m_compressionLevel = pset.get<int>("CompressionLevel", -1);
     m_trackLabel      = pset.get<std::string>("TrackModule", "pandora");
     m_particleLabel   = pset.get<std::string>("PFParticleModule", "pandora");
     m_spacepointLabel = pset.get<std::string>("SpacePointModule", "pandora");
@@ -207,51 +246,106 @@ void PFParticleHitDumper::beginJob()
     art::ServiceHandle<art::TFileService> tfs;
 
     m_pRecoTracks = tfs->make<TTree>("pandoraTracks", "LAr Reco Tracks");
-    m_pRecoTracks->Branch("run", &m_run,"run/I");
-    m_pRecoTracks->Branch("event", &m_event,"event/I");
-    m_pRecoTracks->Branch("particle", &m_particle, "particle/I");
-    m_pRecoTracks->Branch("x", &m_x, "x/D");
-    m_pRecoTracks->Branch("y", &m_y, "y/D");
-    m_pRecoTracks->Branch("z", &m_z, "z/D");
-
     m_pReco3D = tfs->make<TTree>("pandora3D", "LAr Reco 3D");
-    m_pReco3D->Branch("run", &m_run,"run/I");
-    m_pReco3D->Branch("event", &m_event,"event/I");
-    m_pReco3D->Branch("particle", &m_particle, "particle/I");
-    m_pReco3D->Branch("primary", &m_primary, "primary/I");
-    m_pReco3D->Branch("pdgcode", &m_pdgcode, "pdgcode/I");
-    m_pReco3D->Branch("cstat", &m_cstat, "cstat/I");
-    m_pReco3D->Branch("tpc", &m_tpc, "tpc/I");
-    m_pReco3D->Branch("plane", &m_plane, "plane/I");
-    m_pReco3D->Branch("x", &m_x, "x/D");
-    m_pReco3D->Branch("y", &m_y, "y/D");
-    m_pReco3D->Branch("u", &m_u, "u/D");
-    m_pReco3D->Branch("v", &m_v, "v/D");
-    m_pReco3D->Branch("z", &m_z, "z/D");
-
     m_pReco2D = tfs->make<TTree>("pandora2D", "LAr Reco 2D");
-    m_pReco2D->Branch("run", &m_run,"run/I");
-    m_pReco2D->Branch("event", &m_event,"event/I");
-    m_pReco2D->Branch("particle", &m_particle, "particle/I");
-    m_pReco2D->Branch("pdgcode", &m_pdgcode, "pdgcode/I");
-    m_pReco2D->Branch("cstat", &m_cstat, "cstat/I");
-    m_pReco2D->Branch("tpc", &m_tpc, "tpc/I");
-    m_pReco2D->Branch("plane", &m_plane, "plane/I");
-    m_pReco2D->Branch("wire", &m_wire, "wire/I");
-    m_pReco2D->Branch("x", &m_x, "x/D");
-    m_pReco2D->Branch("w", &m_w, "w/D");
-    m_pReco2D->Branch("q", &m_q, "q/D");
-
     m_pRecoWire = tfs->make<TTree>("rawdata", "LAr Reco Wires");
-    m_pRecoWire->Branch("run", &m_run,"run/I");
-    m_pRecoWire->Branch("event", &m_event,"event/I");
-    m_pRecoWire->Branch("cstat", &m_cstat, "cstat/I");
-    m_pRecoWire->Branch("tpc", &m_tpc, "tpc/I");
-    m_pRecoWire->Branch("plane", &m_plane, "plane/I");
-    m_pRecoWire->Branch("wire", &m_wire, "wire/I");
-    m_pRecoWire->Branch("x", &m_x, "x/D");
-    m_pRecoWire->Branch("w", &m_w, "w/D");
-    m_pRecoWire->Branch("q", &m_q, "q/D");
+
+    if (m_columnarOutput)
+    {
+        // ATTN One entry per event, with a vector of single-precision values per variable
+        m_pRecoTracks->Branch("run", &m_run,"run/I");
+        m_pRecoTracks->Branch("event", &m_event,"event/I");
+        m_pRecoTracks->Branch("particle", &m_particleColumn);
+        m_pRecoTracks->Branch("x", &m_xColumn);
+        m_pRecoTracks->Branch("y", &m_yColumn);
+        m_pRecoTracks->Branch("z", &m_zColumn);
+
+        m_pReco3D->Branch("run", &m_run,"run/I");
+        m_pReco3D->Branch("event", &m_event,"event/I");
+        m_pReco3D->Branch("particle", &m_particleColumn);
+        m_pReco3D->Branch("primary", &m_primaryColumn);
+        m_pReco3D->Branch("pdgcode", &m_pdgcodeColumn);
+        m_pReco3D->Branch("cstat", &m_cstatColumn);
+        m_pReco3D->Branch("tpc", &m_tpcColumn);
+        m_pReco3D->Branch("plane", &m_planeColumn);
+        m_pReco3D->Branch("x", &m_xColumn);
+        m_pReco3D->Branch("y", &m_yColumn);
+        m_pReco3D->Branch("u", &m_uColumn);
+        m_pReco3D->Branch("v", &m_vColumn);
+        m_pReco3D->Branch("z", &m_zColumn);
+
+        m_pReco2D->Branch("run", &m_run,"run/I");
+        m_pReco2D->Branch("event", &m_event,"event/I");
+        m_pReco2D->Branch("particle", &m_particleColumn);
+        m_pReco2D->Branch("pdgcode", &m_pdgcodeColumn);
+        m_pReco2D->Branch("cstat", &m_cstatColumn);
+        m_pReco2D->Branch("tpc", &m_tpcColumn);
+        m_pReco2D->Branch("plane", &m_planeColumn);
+        m_pReco2D->Branch("wire", &m_wireColumn);
+        m_pReco2D->Branch("x", &m_xColumn);
+        m_pReco2D->Branch("w", &m_wColumn);
+        m_pReco2D->Branch("q", &m_qColumn);
+
+        m_pRecoWire->Branch("run", &m_run,"run/I");
+        m_pRecoWire->Branch("event", &m_event,"event/I");
+        m_pRecoWire->Branch("cstat", &m_cstatColumn);
+        m_pRecoWire->Branch("tpc", &m_tpcColumn);
+        m_pRecoWire->Branch("plane", &m_planeColumn);
+        m_pRecoWire->Branch("wire", &m_wireColumn);
+        m_pRecoWire->Branch("x", &m_xColumn);
+        m_pRecoWire->Branch("w", &m_wColumn);
+        m_pRecoWire->Branch("q", &m_qColumn);
+    }
+    else
+    {
+        m_pRecoTracks->Branch("run", &m_run,"run/I");
+        m_pRecoTracks->Branch("event", &m_event,"event/I");
+        m_pRecoTracks->Branch("particle", &m_particle, "particle/I");
+        m_pRecoTracks->Branch("x", &m_x, "x/D");
+        m_pRecoTracks->Branch("y", &m_y, "y/D");
+        m_pRecoTracks->Branch("z", &m_z, "z/D");
+
+        m_pReco3D->Branch("run", &m_run,"run/I");
+        m_pReco3D->Branch("event", &m_event,"event/I");
+        m_pReco3D->Branch("particle", &m_particle, "particle/I");
+        m_pReco3D->Branch("primary", &m_primary, "primary/I");
+        m_pReco3D->Branch("pdgcode", &m_pdgcode, "pdgcode/I");
+        m_pReco3D->Branch("cstat", &m_cstat, "cstat/I");
+        m_pReco3D->Branch("tpc", &m_tpc, "tpc/I");
+        m_pReco3D->Branch("plane", &m_plane, "plane/I");
+        m_pReco3D->Branch("x", &m_x, "x/D");
+        m_pReco3D->Branch("y", &m_y, "y/D");
+        m_pReco3D->Branch("u", &m_u, "u/D");
+        m_pReco3D->Branch("v", &m_v, "v/D");
+        m_pReco3D->Branch("z", &m_z, "z/D");
+
+        m_pReco2D->Branch("run", &m_run,"run/I");
+        m_pReco2D->Branch("event", &m_event,"event/I");
+        m_pReco2D->Branch("particle", &m_particle, "particle/I");
+        m_pReco2D->Branch("pdgcode", &m_pdgcode, "pdgcode/I");
+        m_pReco2D->Branch("cstat", &m_cstat, "cstat/I");
+        m_pReco2D->Branch("tpc", &m_tpc, "tpc/I");
+        m_pReco2D->Branch("plane", &m_plane, "plane/I");
+        m_pReco2D->Branch("wire", &m_wire, "wire/I");
+        m_pReco2D->Branch("x", &m_x, "x/D");
+        m_pReco2D->Branch("w", &m_w, "w/D");
+        m_pReco2D->Branch("q", &m_q, "q/D");
+
+        m_pRecoWire->Branch("run", &m_run,"run/I");
+        m_pRecoWire->Branch("event", &m_event,"event/I");
+        m_pRecoWire->Branch("cstat", &m_cstat, "cstat/I");
+        m_pRecoWire->Branch("tpc", &m_tpc, "tpc/I");
+        m_pRecoWire->Branch("plane", &m_plane, "plane/I");
+        m_pRecoWire->Branch("wire", &m_wire, "wire/I");
+        m_pRecoWire->Branch("x", &m_x, "x/D");
+        m_pRecoWire->Branch("w", &m_w, "w/D");
+        m_pRecoWire->Branch("q", &m_q, "q/D");
+    }
+
+    this->ConfigureTree(m_pRecoTracks);
+    this->ConfigureTree(m_pReco3D);
+    this->ConfigureTree(m_pReco2D);
+    this->ConfigureTree(m_pRecoWire);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -305,7 +399,7 @@ void PFParticleHitDumper::analyze(const art::Event &evt)
     PFParticleVector         particleVector;
     SpacePointVector         spacePointVector;
     HitVector                hitVector;
-    WireVector               wireVector;
+    WireCollection           wireCollection;
 
     PFParticlesToTracks      particlesToTracks;
     PFParticlesToSpacePoints particlesToSpacePoints;
@@ -320,7 +414,7 @@ void PFParticleHitDumper::analyze(const art::Event &evt)
     LArPandoraHelper::BuildPFParticleHitMaps(evt, m_particleLabel, m_spacepointLabel, particlesToHits, hitsToParticles);
 
     if (m_storeWires)
-        LArPandoraHelper::CollectWires(evt, m_calwireLabel, wireVector);
+        LArPandoraHelper::CollectWires(evt, m_calwireLabel, wireCollection);
 
     if (m_printDebug)
         std::cout << "  PFParticles: " << particleVector.size() << std::endl; 
@@ -341,13 +435,14 @@ void PFParticleHitDumper::analyze(const art::Event &evt)
     // ==================================
     if (m_printDebug)
         std::cout << "   PFParticleHitDumper::FillReco2D(...) " << std::endl;
-    this->FillReco2D(hitVector, hitsToParticles);
+    const HitSoA hitSoA(hitVector);
+    this->FillReco2D(hitVector, hitSoA, hitsToParticles);
 
     // Loop over Wires (Fill Reco Wire Tree)
     // =====================================
     if (m_printDebug)
         std::cout << "   PFParticleHitDumper::FillRecoWires(...) " << std::endl;
-    this->FillRecoWires(wireVector);
+    this->FillRecoWires(wireCollection);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -360,8 +455,11 @@ void PFParticleHitDumper::FillRecoTracks(const PFParticlesToTracks &particlesToT
     m_y = 0.0;
     m_z = 0.0;
 
+    if (m_columnarOutput)
+        this->ClearColumns();
+
     // Create dummy entry if there are no particles
-    if (particlesToTracks.empty())
+    if (particlesToTracks.empty() && !m_columnarOutput)
     {
         m_pRecoTracks->Fill();
     }
@@ -391,10 +489,23 @@ void PFParticleHitDumper::FillRecoTracks(const PFParticlesToTracks &particlesToT
                 m_y = position.y();
                 m_z = position.z();
 
-                m_pRecoTracks->Fill();
+                if (m_columnarOutput)
+                {
+                    m_particleColumn.push_back(m_particle);
+                    m_xColumn.push_back(m_x);
+                    m_yColumn.push_back(m_y);
+                    m_zColumn.push_back(m_z);
+                }
+                else
+                {
+                    m_pRecoTracks->Fill();
+                }
 	    }
 	}
     }
+
+    if (m_columnarOutput)
+        m_pRecoTracks->Fill();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -415,8 +526,11 @@ void PFParticleHitDumper::FillReco3D(const PFParticleVector &particleVector, con
     m_y = 0.0;
     m_z = 0.0;
 
+    if (m_columnarOutput)
+        this->ClearColumns();
+
     // Create dummy entry if there are no particles
-    if (particleVector.empty())
+    if (particleVector.empty() && !m_columnarOutput)
     {
         m_pReco3D->Fill();
     }
@@ -482,14 +596,34 @@ void PFParticleHitDumper::FillReco3D(const PFParticleVector &particleVector, con
             m_u = this->YZtoU(m_cstat, m_tpc, m_y, m_z);
             m_v = this->YZtoV(m_cstat, m_tpc, m_y, m_z);
 
-            m_pReco3D->Fill();
+            if (m_columnarOutput)
+            {
+                m_particleColumn.push_back(m_particle);
+                m_primaryColumn.push_back(m_primary);
+                m_pdgcodeColumn.push_back(m_pdgcode);
+                m_cstatColumn.push_back(m_cstat);
+                m_tpcColumn.push_back(m_tpc);
+                m_planeColumn.push_back(m_plane);
+                m_xColumn.push_back(m_x);
+                m_yColumn.push_back(m_y);
+                m_uColumn.push_back(m_u);
+                m_vColumn.push_back(m_v);
+                m_zColumn.push_back(m_z);
+            }
+            else
+            {
+                m_pReco3D->Fill();
+            }
         }
     }
+
+    if (m_columnarOutput)
+        m_pReco3D->Fill();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-void PFParticleHitDumper::FillReco2D(const HitVector &hitVector, const HitsToPFParticles &hitsToParticles)
+void PFParticleHitDumper::FillReco2D(const HitVector &hitVector, const HitSoA &hitSoA, const HitsToPFParticles &hitsToParticles)
 { 
     // Initialise variables
     m_particle = -1;
@@ -502,8 +636,22 @@ void PFParticleHitDumper::FillReco2D(const HitVector &hitVector, const HitsToPFP
     m_w = 0.0;
     m_q = 0.0;
 
+    if (m_columnarOutput)
+    {
+        this->ClearColumns();
+        m_particleColumn.reserve(hitVector.size());
+        m_pdgcodeColumn.reserve(hitVector.size());
+        m_cstatColumn.reserve(hitVector.size());
+        m_tpcColumn.reserve(hitVector.size());
+        m_planeColumn.reserve(hitVector.size());
+        m_wireColumn.reserve(hitVector.size());
+        m_xColumn.reserve(hitVector.size());
+        m_wColumn.reserve(hitVector.size());
+        m_qColumn.reserve(hitVector.size());
+    }
+
     // Create dummy entry if there are no 2D hits 
-    if (hitVector.empty())
+    if (hitVector.empty() && !m_columnarOutput)
     {
         m_pReco2D->Fill();
     }
@@ -511,6 +659,9 @@ void PFParticleHitDumper::FillReco2D(const HitVector &hitVector, const HitsToPFP
     // Need DetectorProperties service to convert from ticks to X
     auto const* theDetector = lar::providerFrom<detinfo::DetectorPropertiesService>();
 
+    const std::vector<float> &hitPeakTimes(hitSoA.GetPeakTimes());
+    const std::vector<float> &hitIntegrals(hitSoA.GetIntegrals());
+
     // Loop over 2D hits
     for (unsigned int i = 0; i<hitVector.size(); ++i)
     {
@@ -527,27 +678,47 @@ void PFParticleHitDumper::FillReco2D(const HitVector &hitVector, const HitsToPFP
             m_pdgcode = particle->PdgCode();
         }
                 
-        const geo::WireID &wireID(hit->WireID());
+        const geo::WireID wireID(hitSoA.GetWireID(i));
         m_cstat = wireID.Cryostat;
         m_tpc   = wireID.TPC;
         m_plane = wireID.Plane;
         m_wire  = wireID.Wire; 
 
-        m_q = hit->Integral();
-        m_x = theDetector->ConvertTicksToX(hit->PeakTime(), wireID.Plane, wireID.TPC, wireID.Cryostat);
+        m_q = hitIntegrals[i];
+        m_x = theDetector->ConvertTicksToX(hitPeakTimes[i], wireID.Plane, wireID.TPC, wireID.Cryostat);
         m_w = this->GetUVW(wireID);
      
-        m_pReco2D->Fill();
+        if (m_columnarOutput)
+        {
+            m_particleColumn.push_back(m_particle);
+            m_pdgcodeColumn.push_back(m_pdgcode);
+            m_cstatColumn.push_back(m_cstat);
+            m_tpcColumn.push_back(m_tpc);
+            m_planeColumn.push_back(m_plane);
+            m_wireColumn.push_back(m_wire);
+            m_xColumn.push_back(m_x);
+            m_wColumn.push_back(m_w);
+            m_qColumn.push_back(m_q);
+        }
+        else
+        {
+            m_pReco2D->Fill();
+        }
     }
+
+    if (m_columnarOutput)
+        m_pReco2D->Fill();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-void PFParticleHitDumper::FillRecoWires(const WireVector &wireVector)
+void PFParticleHitDumper::FillRecoWires(const WireCollection &wireCollection)
 {
+    if (m_columnarOutput)
+        this->ClearColumns();
 
     // Create dummy entry if there are no wires
-    if (wireVector.empty())
+    if (wireCollection.empty() && !m_columnarOutput)
     {
         m_pRecoWire->Fill();
     }
@@ -561,15 +732,13 @@ void PFParticleHitDumper::FillRecoWires(const WireVector &wireVector)
     // Loop over wires
     int signalCounter(0);
 
-    for (unsigned int i = 0; i<wireVector.size(); ++i)
+    for (const recob::Wire &wire : wireCollection)
     {
-        const art::Ptr<recob::Wire> wire = wireVector.at(i);
-       
-        const std::vector<float> &signals(wire->Signal());
-        const std::vector<geo::WireID> wireIds = theGeometry->ChannelToWire(wire->Channel());
+        const std::vector<float> &signals(wire.Signal());
+        const std::vector<geo::WireID> wireIds = theGeometry->ChannelToWire(wire.Channel());
 
         if ((signalCounter++) < 10 && m_printDebug)
-          std::cout << "    numWires=" << wireVector.size() << " numSignals=" << signals.size() << std::endl;
+          std::cout << "    numWires=" << wireCollection.size() << " numSignals=" << signals.size() << std::endl;
 
         double time(0.0);
 
@@ -594,10 +763,26 @@ void PFParticleHitDumper::FillRecoWires(const WireVector &wireVector)
                 m_x = theDetector->ConvertTicksToX(time, wireID.Plane, wireID.TPC, wireID.Cryostat);
                 m_w = this->GetUVW(wireID);
 
-                m_pRecoWire->Fill();
+                if (m_columnarOutput)
+                {
+                    m_cstatColumn.push_back(m_cstat);
+                    m_tpcColumn.push_back(m_tpc);
+                    m_planeColumn.push_back(m_plane);
+                    m_wireColumn.push_back(m_wire);
+                    m_xColumn.push_back(m_x);
+                    m_wColumn.push_back(m_w);
+                    m_qColumn.push_back(m_q);
+                }
+                else
+                {
+                    m_pRecoWire->Fill();
+                }
             }
         }
     } 
+
+    if (m_columnarOutput)
+        m_pRecoWire->Fill();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -650,4 +835,40 @@ double PFParticleHitDumper::YZtoV(const unsigned int cstat, const unsigned int t
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
+void PFParticleHitDumper::ConfigureTree(TTree *const pTree) const
+{
+    if (m_basketSize > 0)
+        pTree->SetBasketSize("*", m_basketSize);
+
+    if (m_compressionLevel < 0)
+        return;
+
+    TObjArray *const pBranchArray(pTree->GetListOfBranches());
+
+    for (int i = 0; i < pBranchArray->GetEntriesFast(); ++i)
+        static_cast<TBranch*>(pBranchArray->At(i))->SetCompressionLevel(m_compressionLevel);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PFParticleHitDumper::ClearColumns()
+{
+    m_particleColumn.clear();
+    m_primaryColumn.clear();
+    m_pdgcodeColumn.clear();
+    m_cstatColumn.clear();
+    m_tpcColumn.clear();
+    m_planeColumn.clear();
+    m_wireColumn.clear();
+    m_uColumn.clear();
+    m_vColumn.clear();
+    m_wColumn.clear();
+    m_xColumn.clear();
+    m_yColumn.clear();
+    m_zColumn.clear();
+    m_qColumn.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
 } //namespace lar_pandora
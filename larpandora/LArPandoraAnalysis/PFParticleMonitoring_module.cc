@@ -11,6 +11,7 @@
 #include "TTree.h"
 
 #include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
+#include "larpandora/LArPandoraInterface/LArPandoraSharedHitMatrix.h"
 
 #include <string>
 
@@ -44,9 +45,8 @@ public:
 
 private:
 
-    typedef std::set< art::Ptr<recob::PFParticle> > PFParticleSet;
-    typedef std::set< art::Ptr<simb::MCParticle> > MCParticleSet;
-    typedef std::set< art::Ptr<simb::MCTruth> > MCTruthSet;
+    typedef std::map< art::Ptr<simb::MCTruth>, HitViewCounts > MCTruthToHitCounts;
+    typedef std::map< art::Ptr<simb::MCParticle>, HitViewCounts > MCParticlesToHitCounts;
 
     /**
      *  @brief  Build mapping from true neutrinos to hits
@@ -73,50 +73,22 @@ private:
     /**
      *  @brief Perform matching between true and reconstructed neutrino events
      *
-     *  @param recoNeutrinosToHits  the mapping from reconstructed neutrino events to hits
-     *  @param trueHitsToNeutrinos  the mapping from hits to true neutrino events
+     *  @param sharedHitMatrix  the hits shared by reconstructed and true neutrino events
      *  @param matchedNeutrinos  the output matches between reconstructed and true neutrinos
-     *  @param matchedNeutrinoHits  the output matches between reconstructed neutrinos and hits
+     *  @param matchedNeutrinoHits  the output number of hits shared by the matched neutrinos
      */
-     void GetRecoToTrueMatches(const PFParticlesToHits &recoNeutrinosToHits, const HitsToMCTruth &trueHitsToNeutrinos,
-         MCTruthToPFParticles &matchedNeutrinos, MCTruthToHits &matchedNeutrinoHits) const;
-
-    /**
-     *  @brief Perform matching between true and reconstructed neutrino events
-     *
-     *  @param recoNeutrinosToHits  the mapping from reconstructed neutrino events to hits
-     *  @param trueHitsToNeutrinos  the mapping from hits to true neutrino events
-     *  @param matchedNeutrinos  the output matches between reconstructed and true neutrinos
-     *  @param matchedNeutrinoHits  the output matches between reconstructed neutrinos and hits
-     *  @param recoVeto  the veto list for reconstructed particles
-     *  @param trueVeto  the veto list for true particles
-     */
-     void GetRecoToTrueMatches(const PFParticlesToHits &recoNeutrinosToHits, const HitsToMCTruth &trueHitsToNeutrinos,
-         MCTruthToPFParticles &matchedNeutrinos, MCTruthToHits &matchedNeutrinoHits, PFParticleSet &recoVeto, MCTruthSet &trueVeto) const;
+     void GetRecoToTrueMatches(const MCTruthHitMatrix &sharedHitMatrix, MCTruthToPFParticles &matchedNeutrinos,
+         MCTruthToHitCounts &matchedNeutrinoHits) const;
 
     /**
      *  @brief Perform matching between true and reconstructed particles
      *
-     *  @param recoParticlesToHits the mapping from reconstructed particles to hits
-     *  @param trueHitsToParticles the mapping from hits to true particles
+     *  @param sharedHitMatrix the hits shared by reconstructed and true particles
      *  @param matchedParticles the output matches between reconstructed and true particles
-     *  @param matchedHits the output matches between reconstructed particles and hits
+     *  @param matchedHits the output number of hits shared by the matched particles
      */
-     void GetRecoToTrueMatches(const PFParticlesToHits &recoParticlesToHits, const HitsToMCParticles &trueHitsToParticles,
-         MCParticlesToPFParticles &matchedParticles, MCParticlesToHits &matchedHits) const;
-
-    /**
-     *  @brief Perform matching between true and reconstructed particles
-     *
-     *  @param recoParticlesToHits the mapping from reconstructed particles to hits
-     *  @param trueHitsToParticles the mapping from hits to true particles
-     *  @param matchedParticles the output matches between reconstructed and true particles
-     *  @param matchedHits the output matches between reconstructed particles and hits
-     *  @param recoVeto the veto list for reconstructed particles
-     *  @param trueVeto the veto list for true particles
-     */
-     void GetRecoToTrueMatches(const PFParticlesToHits &recoParticlesToHits, const HitsToMCParticles &trueHitsToParticles,
-         MCParticlesToPFParticles &matchedParticles, MCParticlesToHits &matchedHits, PFParticleSet &recoVeto, MCParticleSet &trueVeto) const;
+     void GetRecoToTrueMatches(const MCParticleHitMatrix &sharedHitMatrix, MCParticlesToPFParticles &matchedParticles,
+         MCParticlesToHitCounts &matchedHits) const;
 
     /**
      *  @brief Build particle maps for reconstructed particles
@@ -252,6 +224,7 @@ private:
      bool         m_addDaughterMCParticles; ///<
      bool         m_recursiveMatching;      ///<
      bool         m_printDebug;             ///< switch for print statements (TODO: use message service!)
+     unsigned int m_nMatchingThreads;       ///< Number of threads used to build the shared hit matrices (0: all cores)
 };
 
 DEFINE_ART_MODULE(PFParticleMonitoring)
@@ -317,6 +290,7 @@ void PFParticleMonitoring::reconfigure(fhicl::ParameterSet const &pset)
     m_addDaughterMCParticles = pset.get<bool>("AddDaughterMCParticles",true);
     m_recursiveMatching = pset.get<bool>("RecursiveMatching",false);
     m_printDebug = pset.get<bool>("PrintDebug",false);
+    m_nMatchingThreads = pset.get<unsigned int>("NMatchingThreads",1);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -609,9 +583,11 @@ void PFParticleMonitoring::analyze(const art::Event &evt)
     this->BuildRecoNeutrinoHitMaps(recoParticleMap, recoParticlesToHits, recoNeutrinosToHits, recoHitsToNeutrinos);
     this->BuildTrueNeutrinoHitMaps(truthToParticles, trueParticlesToHits, trueNeutrinosToHits, trueHitsToNeutrinos);
 
+    const MCTruthHitMatrix neutrinoHitMatrix(recoNeutrinosToHits, trueHitsToNeutrinos, m_nMatchingThreads);
+
     MCTruthToPFParticles matchedNeutrinos;
-    MCTruthToHits matchedNeutrinoHits;
-    this->GetRecoToTrueMatches(recoNeutrinosToHits, trueHitsToNeutrinos, matchedNeutrinos, matchedNeutrinoHits);
+    MCTruthToHitCounts matchedNeutrinoHits;
+    this->GetRecoToTrueMatches(neutrinoHitMatrix, matchedNeutrinos, matchedNeutrinoHits);
 
     for (MCTruthToHits::const_iterator iter = trueNeutrinosToHits.begin(), iterEnd = trueNeutrinosToHits.end(); iter != iterEnd; ++iter)
     {
@@ -718,20 +694,20 @@ void PFParticleMonitoring::analyze(const art::Event &evt)
             {
                 const HitVector &recoHitVector = pIter2->second;
 
-                MCTruthToHits::const_iterator pIter3 = matchedNeutrinoHits.find(trueEvent);
+                MCTruthToHitCounts::const_iterator pIter3 = matchedNeutrinoHits.find(trueEvent);
                 if (matchedNeutrinoHits.end() != pIter3)
                 {
-                    const HitVector &matchedHitVector = pIter3->second;
+                    const HitViewCounts &matchedHitCounts = pIter3->second;
 
                     m_nPfoHits = recoHitVector.size();
                     m_nPfoHitsU = this->CountHitsByType(geo::kU, recoHitVector);
                     m_nPfoHitsV = this->CountHitsByType(geo::kV, recoHitVector);
                     m_nPfoHitsW = this->CountHitsByType(geo::kW, recoHitVector);
 
-                    m_nMatchedHits = matchedHitVector.size();
-                    m_nMatchedHitsU = this->CountHitsByType(geo::kU, matchedHitVector);
-                    m_nMatchedHitsV = this->CountHitsByType(geo::kV, matchedHitVector);
-                    m_nMatchedHitsW = this->CountHitsByType(geo::kW, matchedHitVector);
+                    m_nMatchedHits = matchedHitCounts.m_nHitsTotal;
+                    m_nMatchedHitsU = matchedHitCounts.m_nHitsU;
+                    m_nMatchedHitsV = matchedHitCounts.m_nHitsV;
+                    m_nMatchedHitsW = matchedHitCounts.m_nHitsW;
 
                     PFParticlesToVertices::const_iterator pIter4 = recoParticlesToVertices.find(recoParticle);
                     if (recoParticlesToVertices.end() != pIter4)
@@ -772,9 +748,11 @@ void PFParticleMonitoring::analyze(const art::Event &evt)
 
     // Match Reco Particles to True Particles
     // ======================================
+    const MCParticleHitMatrix particleHitMatrix(recoParticlesToHits, trueHitsToParticles, m_nMatchingThreads);
+
     MCParticlesToPFParticles matchedParticles;
-    MCParticlesToHits matchedParticleHits;
-    this->GetRecoToTrueMatches(recoParticlesToHits, trueHitsToParticles, matchedParticles, matchedParticleHits);
+    MCParticlesToHitCounts matchedParticleHits;
+    this->GetRecoToTrueMatches(particleHitMatrix, matchedParticles, matchedParticleHits);
 
     // Compare true and reconstructed particles
     for (MCParticlesToHits::const_iterator iter = trueParticlesToHits.begin(), iterEnd = trueParticlesToHits.end(); iter != iterEnd; ++iter)
@@ -975,21 +953,21 @@ void PFParticleMonitoring::analyze(const art::Event &evt)
 
             const HitVector &recoHitVector = pIter2->second;
 
-            MCParticlesToHits::const_iterator pIter3 = matchedParticleHits.find(trueParticle);
+            MCParticlesToHitCounts::const_iterator pIter3 = matchedParticleHits.find(trueParticle);
             if (matchedParticleHits.end() == pIter3)
                 throw cet::exception("LArPandora") << " PFParticleMonitoring::analyze --- Found a matched true particle without matched hits ";
 
-            const HitVector &matchedHitVector = pIter3->second;
+            const HitViewCounts &matchedHitCounts = pIter3->second;
 
             m_nPfoHits = recoHitVector.size();
             m_nPfoHitsU = this->CountHitsByType(geo::kU, recoHitVector);
             m_nPfoHitsV = this->CountHitsByType(geo::kV, recoHitVector);
             m_nPfoHitsW = this->CountHitsByType(geo::kW, recoHitVector);
 
-            m_nMatchedHits = matchedHitVector.size();
-            m_nMatchedHitsU = this->CountHitsByType(geo::kU, matchedHitVector);
-            m_nMatchedHitsV = this->CountHitsByType(geo::kV, matchedHitVector);
-            m_nMatchedHitsW = this->CountHitsByType(geo::kW, matchedHitVector);
+            m_nMatchedHits = matchedHitCounts.m_nHitsTotal;
+            m_nMatchedHitsU = matchedHitCounts.m_nHitsU;
+            m_nMatchedHitsV = matchedHitCounts.m_nHitsV;
+            m_nMatchedHitsW = matchedHitCounts.m_nHitsW;
 
             PFParticlesToVertices::const_iterator pIter4 = recoParticlesToVertices.find(recoParticle);
             if (recoParticlesToVertices.end() != pIter4)
@@ -1114,168 +1092,42 @@ void PFParticleMonitoring::BuildRecoNeutrinoHitMaps(const PFParticleMap &recoPar
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-void PFParticleMonitoring::GetRecoToTrueMatches(const PFParticlesToHits &recoNeutrinosToHits, const HitsToMCTruth &trueHitsToNeutrinos,
-    MCTruthToPFParticles &matchedNeutrinos, MCTruthToHits &matchedNeutrinoHits) const
-{
-    PFParticleSet recoVeto; MCTruthSet trueVeto;
-
-    this->GetRecoToTrueMatches(recoNeutrinosToHits, trueHitsToNeutrinos, matchedNeutrinos, matchedNeutrinoHits, recoVeto, trueVeto);
-}
-
-//------------------------------------------------------------------------------------------------------------------------------------------
-
-void PFParticleMonitoring::GetRecoToTrueMatches(const PFParticlesToHits &recoNeutrinosToHits, const HitsToMCTruth &trueHitsToNeutrinos,
-    MCTruthToPFParticles &matchedNeutrinos, MCTruthToHits &matchedNeutrinoHits, PFParticleSet &vetoReco, MCTruthSet &vetoTrue) const
+void PFParticleMonitoring::GetRecoToTrueMatches(const MCTruthHitMatrix &sharedHitMatrix, MCTruthToPFParticles &matchedNeutrinos,
+    MCTruthToHitCounts &matchedNeutrinoHits) const
 {
-    bool foundMatches(false);
+    MCTruthHitMatrix::IndexVector matchedCells;
+    sharedHitMatrix.GetBestMatches(m_recursiveMatching, matchedCells);
 
-    for (PFParticlesToHits::const_iterator iter1 = recoNeutrinosToHits.begin(), iterEnd1 = recoNeutrinosToHits.end();
-        iter1 != iterEnd1; ++iter1)
+    for (size_t trueIndex = 0; trueIndex < matchedCells.size(); ++trueIndex)
     {
-        const art::Ptr<recob::PFParticle> recoNeutrino = iter1->first;
-        if (vetoReco.count(recoNeutrino) > 0)
+        const size_t cellIndex(matchedCells[trueIndex]);
+        if (MCTruthHitMatrix::NO_MATCH == cellIndex)
             continue;
 
-        const HitVector &hitVector = iter1->second;
-
-        MCTruthToHits truthContributionMap;
-
-        for (HitVector::const_iterator iter2 = hitVector.begin(), iterEnd2 = hitVector.end(); iter2 != iterEnd2; ++iter2)
-        {
-            const art::Ptr<recob::Hit> hit = *iter2;
-
-            HitsToMCTruth::const_iterator iter3 = trueHitsToNeutrinos.find(hit);
-            if (trueHitsToNeutrinos.end() == iter3)
-                continue;
-
-            const art::Ptr<simb::MCTruth> trueNeutrino = iter3->second;
-            if (vetoTrue.count(trueNeutrino) > 0)
-                continue;
-
-            truthContributionMap[trueNeutrino].push_back(hit);
-        }
-
-        MCTruthToHits::const_iterator mIter = truthContributionMap.end();
-
-        for (MCTruthToHits::const_iterator iter4 = truthContributionMap.begin(), iterEnd4 = truthContributionMap.end();
-            iter4 != iterEnd4; ++iter4)
-        {
-            if ((truthContributionMap.end() == mIter) || (iter4->second.size() > mIter->second.size()))
-            {
-                mIter = iter4;
-            }
-        }
-
-        if (truthContributionMap.end() != mIter)
-        {
-            const art::Ptr<simb::MCTruth> trueNeutrino = mIter->first;
-
-            MCTruthToHits::const_iterator iter5 = matchedNeutrinoHits.find(trueNeutrino);
-
-            if ((matchedNeutrinoHits.end() == iter5) || (mIter->second.size() > iter5->second.size()))
-            {
-                matchedNeutrinos[trueNeutrino] = recoNeutrino;
-                matchedNeutrinoHits[trueNeutrino] = mIter->second;
-                foundMatches = true;
-            }
-        }
-    }
-
-    if (!foundMatches)
-        return;
-
-    for (MCTruthToPFParticles::const_iterator pIter = matchedNeutrinos.begin(), pIterEnd = matchedNeutrinos.end();
-        pIter != pIterEnd; ++pIter)
-    {
-        vetoTrue.insert(pIter->first);
-        vetoReco.insert(pIter->second);
+        const art::Ptr<simb::MCTruth> trueNeutrino = sharedHitMatrix.GetTrueParticle(trueIndex);
+        matchedNeutrinos[trueNeutrino] = sharedHitMatrix.GetRecoParticle(sharedHitMatrix.GetCellRecoIndex(cellIndex));
+        matchedNeutrinoHits[trueNeutrino] = sharedHitMatrix.GetSharedHits(cellIndex);
     }
-
-    if (m_recursiveMatching)
-        this->GetRecoToTrueMatches(recoNeutrinosToHits, trueHitsToNeutrinos, matchedNeutrinos, matchedNeutrinoHits, vetoReco, vetoTrue);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-void PFParticleMonitoring::GetRecoToTrueMatches(const PFParticlesToHits &recoParticlesToHits, const HitsToMCParticles &trueHitsToParticles,
-    MCParticlesToPFParticles &matchedParticles, MCParticlesToHits &matchedHits) const
+void PFParticleMonitoring::GetRecoToTrueMatches(const MCParticleHitMatrix &sharedHitMatrix, MCParticlesToPFParticles &matchedParticles,
+    MCParticlesToHitCounts &matchedHits) const
 {
-    PFParticleSet recoVeto; MCParticleSet trueVeto;
-
-    this->GetRecoToTrueMatches(recoParticlesToHits, trueHitsToParticles, matchedParticles, matchedHits, recoVeto, trueVeto);
-}
-
-//------------------------------------------------------------------------------------------------------------------------------------------
+    MCParticleHitMatrix::IndexVector matchedCells;
+    sharedHitMatrix.GetBestMatches(m_recursiveMatching, matchedCells);
 
-void PFParticleMonitoring::GetRecoToTrueMatches(const PFParticlesToHits &recoParticlesToHits, const HitsToMCParticles &trueHitsToParticles,
-    MCParticlesToPFParticles &matchedParticles, MCParticlesToHits &matchedHits, PFParticleSet &vetoReco, MCParticleSet &vetoTrue) const
-{
-    bool foundMatches(false);
-
-    for (PFParticlesToHits::const_iterator iter1 = recoParticlesToHits.begin(), iterEnd1 = recoParticlesToHits.end();
-        iter1 != iterEnd1; ++iter1)
+    for (size_t trueIndex = 0; trueIndex < matchedCells.size(); ++trueIndex)
     {
-        const art::Ptr<recob::PFParticle> recoParticle = iter1->first;
-        if (vetoReco.count(recoParticle) > 0)
+        const size_t cellIndex(matchedCells[trueIndex]);
+        if (MCParticleHitMatrix::NO_MATCH == cellIndex)
             continue;
 
-        const HitVector &hitVector = iter1->second;
-
-        MCParticlesToHits truthContributionMap;
-
-        for (HitVector::const_iterator iter2 = hitVector.begin(), iterEnd2 = hitVector.end(); iter2 != iterEnd2; ++iter2)
-        {
-            const art::Ptr<recob::Hit> hit = *iter2;
-
-            HitsToMCParticles::const_iterator iter3 = trueHitsToParticles.find(hit);
-            if (trueHitsToParticles.end() == iter3)
-                continue;
-
-            const art::Ptr<simb::MCParticle> trueParticle = iter3->second;
-            if (vetoTrue.count(trueParticle) > 0)
-                continue;
-
-            truthContributionMap[trueParticle].push_back(hit);
-        }
-
-        MCParticlesToHits::const_iterator mIter = truthContributionMap.end();
-
-        for (MCParticlesToHits::const_iterator iter4 = truthContributionMap.begin(), iterEnd4 = truthContributionMap.end();
-            iter4 != iterEnd4; ++iter4)
-        {
-            if ((truthContributionMap.end() == mIter) || (iter4->second.size() > mIter->second.size()))
-            {
-                mIter = iter4;
-            }
-        }
-
-        if (truthContributionMap.end() != mIter)
-        {
-            const art::Ptr<simb::MCParticle> trueParticle = mIter->first;
-
-            MCParticlesToHits::const_iterator iter5 = matchedHits.find(trueParticle);
-
-            if ((matchedHits.end() == iter5) || (mIter->second.size() > iter5->second.size()))
-            {
-                matchedParticles[trueParticle] = recoParticle;
-                matchedHits[trueParticle] = mIter->second;
-                foundMatches = true;
-            }
-        }
-    }
-
-    if (!foundMatches)
-        return;
-
-    for (MCParticlesToPFParticles::const_iterator pIter = matchedParticles.begin(), pIterEnd = matchedParticles.end(); 
-        pIter != pIterEnd; ++pIter)
-    {
-        vetoTrue.insert(pIter->first);
-        vetoReco.insert(pIter->second);
+        const art::Ptr<simb::MCParticle> trueParticle = sharedHitMatrix.GetTrueParticle(trueIndex);
+        matchedParticles[trueParticle] = sharedHitMatrix.GetRecoParticle(sharedHitMatrix.GetCellRecoIndex(cellIndex));
+        matchedHits[trueParticle] = sharedHitMatrix.GetSharedHits(cellIndex);
     }
- 
-    if (m_recursiveMatching)
-        this->GetRecoToTrueMatches(recoParticlesToHits, trueHitsToParticles, matchedParticles, matchedHits, vetoReco, vetoTrue);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
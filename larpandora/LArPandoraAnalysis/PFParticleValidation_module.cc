@@ -9,8 +9,13 @@
 #include "art/Framework/Core/EDAnalyzer.h"
 
 #include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
+#include "larpandora/LArPandoraInterface/LArPandoraSharedHitMatrix.h"
+
+#include "TH1.h"
+#include "TTree.h"
 
 #include <string>
+#include <unordered_map>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
@@ -120,43 +125,39 @@ private:
     typedef std::map<int, MatchingDetails> MatchingDetailsMap;
     typedef std::map<SimpleMCPrimary, SimpleMatchedPfoList> MCPrimaryMatchingMap; // SimpleMCPrimary has a defined operator<
 
-    typedef std::map< art::Ptr<recob::PFParticle>, HitVector > PFParticleToMatchedHits;
-    typedef std::map< art::Ptr<simb::MCParticle>,  PFParticleToMatchedHits > MCParticleMatchingMap;
-
-    /**
-     *  @brief  Performing matching between true and reconstructed particles
-     *
-     *  @param  recoParticlesToHits the mapping from reconstructed particles to hits
-     *  @param  trueParticlesToHits the mapping from true particles to hits
-     *  @param  hitsToTrueParticles the mapping from hits to true particles
-     *  @param  mcParticleMatchingMap the output matches between all reconstructed and true particles
-     */
-    void GetMCParticleMatchingMap(const PFParticlesToHits &recoParticlesToHits, const MCParticlesToHits &trueParticlesToHits,
-        const HitsToMCParticles &hitsToTrueParticles, MCParticleMatchingMap &mcParticleMatchingMap) const;
+    typedef std::unordered_map<const simb::MCParticle*, size_t> MCParticleAddressMap;
+    typedef std::unordered_map<const recob::PFParticle*, SimpleMatchedPfo> SimpleMatchedPfoMap;
 
     /**
      *  @brief  Extract details of each mc primary (ordered by number of true hits)
      * 
      *  @param  evt the event
      *  @param  mcParticlesToHits the mc primary to hits map
-     *  @param  hitsToMCParticles the hits to mc particles map
-     *  @param  mcParticleMatchingMap the mc to particle to pf particle matching map (to record number of matched pf particles)
+     *  @param  sharedHitMatrix the hits shared by pf particles and mc particles (to record number of matched pf particles)
      *  @param  simpleMCPrimaryList to receive the populated simple mc primary list
      */
-    void GetSimpleMCPrimaryList(const art::Event &evt, const MCParticlesToHits &mcParticlesToHits, const HitsToMCParticles &hitsToMCParticles,
-        const MCParticleMatchingMap &mcParticleMatchingMap, SimpleMCPrimaryList &simpleMCPrimaryList) const;
+    void GetSimpleMCPrimaryList(const art::Event &evt, const MCParticlesToHits &mcParticlesToHits, const MCParticleHitMatrix &sharedHitMatrix,
+        SimpleMCPrimaryList &simpleMCPrimaryList) const;
 
     /**
      *  @brief  Obtain a sorted list of matched pfos for each mc primary
      * 
      *  @param  simpleMCPrimaryList the simple mc primary list
-     *  @param  mcToFullPfoMatchingMap the mc to full pfo matching map
+     *  @param  sharedHitMatrix the hits shared by pf particles and mc particles
      *  @param  pfoToHitListMap the pfo to hit list map
      *  @param  mcPrimaryMatchingMap to receive the populated mc primary matching map
      */
-    void GetMCPrimaryMatchingMap(const SimpleMCPrimaryList &simpleMCPrimaryList, const MCParticleMatchingMap &mcParticleMatchingMap,
+    void GetMCPrimaryMatchingMap(const SimpleMCPrimaryList &simpleMCPrimaryList, const MCParticleHitMatrix &sharedHitMatrix,
         const PFParticlesToHits &pfParticlesToHits, MCPrimaryMatchingMap &mcPrimaryMatchingMap) const;
 
+    /**
+     *  @brief  Extract the details of each pfo that do not depend on the matched mc primary, indexed by pfo address
+     *
+     *  @param  pfParticlesToHits the pfo to hits map
+     *  @param  simpleMatchedPfoMap to receive the simple matched pfos, with their parent id, pdg code and pfo hit counts filled
+     */
+    void GetSimpleMatchedPfoMap(const PFParticlesToHits &pfParticlesToHits, SimpleMatchedPfoMap &simpleMatchedPfoMap) const;
+
     /**
      *  @brief  Whether a mc particle is neutrino induced
      * 
@@ -229,6 +230,15 @@ private:
      */
     void PrintMatchingOutput(const MCPrimaryMatchingMap &mcPrimaryMatchingMap, const MatchingDetailsMap &matchingDetailsMap) const;
 
+    /**
+     *  @brief  Write the results of the matching procedure to the output tree, one entry per event, and add them to the summary histograms
+     *
+     *  @param  evt the event
+     *  @param  mcPrimaryMatchingMap the input/raw mc primary matching map
+     *  @param  matchingDetailsMap the matching details map
+     */
+    void WriteMatchingOutput(const art::Event &evt, const MCPrimaryMatchingMap &mcPrimaryMatchingMap, const MatchingDetailsMap &matchingDetailsMap);
+
     /**
      *  @brief  Whether a provided mc primary passes selection, based on number of "good" hits
      * 
@@ -260,14 +270,14 @@ private:
     bool IsGoodMatch(const SimpleMCPrimary &simpleMCPrimary, const SimpleMatchedPfo &simpleMatchedPfo) const;
 
     /**
-     *  @brief  Count the number of hits, in a provided vector, of a specified view
+     *  @brief  Count the number of hits, in a provided vector, of each view, in a single pass
      *
-     *  @param  view the view
      *  @param  hitVector the hit vector
-     *
-     *  @return the number of hits of the specified view
+     *  @param  nHitsU to receive the number of u hits
+     *  @param  nHitsV to receive the number of v hits
+     *  @param  nHitsW to receive the number of w hits
      */
-    unsigned int CountHitsByType(const geo::View_t view, const HitVector &hitVector) const;
+    void CountHitsByView(const HitVector &hitVector, int &nHitsU, int &nHitsV, int &nHitsW) const;
 
     /**
      *  @brief  Sort simple mc primaries by number of mc hits
@@ -289,6 +299,15 @@ private:
      */
     static bool SortSimpleMatchedPfos(const SimpleMatchedPfo &lhs, const SimpleMatchedPfo &rhs);
 
+    /**
+     *  @brief  Get the type of a mc primary, as used to bin the summary histograms
+     *
+     *  @param  pdgCode the pdg code
+     *
+     *  @return the type (0: muon, 1: proton, 2: charged pion, 3: electron, 4: photon, 5: other)
+     */
+    static int GetPrimaryType(const int pdgCode);
+
     std::string         m_hitfinderLabel;               ///< The name/label of the hit producer module
     std::string         m_clusterLabel;                 ///< The name/label of the cluster producer module
     std::string         m_particleLabel;                ///< The name/label of the particle producer module
@@ -307,6 +326,40 @@ private:
     int                 m_matchingMinSharedHits;        ///< The minimum number of shared hits used in matching scheme
     float               m_matchingMinCompleteness;      ///< The minimum particle completeness to declare a match
     float               m_matchingMinPurity;            ///< The minimum particle purity to declare a match
+
+    unsigned int        m_nMatchingThreads;             ///< The number of threads used to build the hit maps and shared hit matrix (0: all cores)
+
+    bool                m_writeToTree;                  ///< Whether to write the matching output to a tree, with summary histograms
+
+    TTree              *m_pValidationTree;              ///< The output tree, with one entry per event
+    int                 m_run;                          ///< The run number
+    int                 m_event;                        ///< The event number
+    int                 m_isCorrect;                    ///< Whether every target mc primary has exactly one good match
+    int                 m_isCalculable;                 ///< Whether the event has any (non-neutron) primaries to assess
+    std::vector<int>    m_mcPrimaryId;                  ///< The id of each mc primary
+    std::vector<int>    m_mcPdg;                        ///< The pdg code of each mc primary
+    std::vector<float>  m_mcEnergy;                     ///< The energy of each mc primary
+    std::vector<int>    m_mcNHits;                      ///< The total number of hits of each mc primary
+    std::vector<int>    m_mcNHitsU;                     ///< The number of u hits of each mc primary
+    std::vector<int>    m_mcNHitsV;                     ///< The number of v hits of each mc primary
+    std::vector<int>    m_mcNHitsW;                     ///< The number of w hits of each mc primary
+    std::vector<int>    m_mcIsTarget;                   ///< Whether each mc primary is a target for the matching
+    std::vector<int>    m_mcNSharedPfos;                ///< The number of pfos sharing hits with each mc primary
+    std::vector<int>    m_mcNGoodMatches;               ///< The number of good matches assigned to each mc primary
+    std::vector<int>    m_pfoId;                        ///< The id of the strongest pfo assigned to each mc primary (-1: none)
+    std::vector<int>    m_pfoPdg;                       ///< The pdg code of the strongest assigned pfo
+    std::vector<int>    m_pfoNHits;                     ///< The total number of hits of the strongest assigned pfo
+    std::vector<int>    m_pfoNMatchedHits;              ///< The number of hits shared by the mc primary and the strongest assigned pfo
+    std::vector<float>  m_completeness;                 ///< The completeness of the strongest assigned pfo
+    std::vector<float>  m_purity;                       ///< The purity of the strongest assigned pfo
+
+    TH1F               *m_hEventOutcome;                ///< The number of events (bin 0), calculable events (bin 1) and correct events (bin 2)
+    TH1F               *m_hTargetPrimaryType;           ///< The number of target mc primaries, by type
+    TH1F               *m_hCorrectPrimaryType;          ///< The number of target mc primaries with exactly one good match, by type
+    TH1F               *m_hTargetPrimaryHits;           ///< The number of target mc primaries, by number of hits
+    TH1F               *m_hCorrectPrimaryHits;          ///< The number of target mc primaries with exactly one good match, by number of hits
+    TH1F               *m_hCompleteness;                ///< The completeness of the strongest pfo assigned to each target mc primary
+    TH1F               *m_hPurity;                      ///< The purity of the strongest pfo assigned to each target mc primary
 };
 
 DEFINE_ART_MODULE(PFParticleValidation)
@@ -317,6 +370,8 @@ DEFINE_ART_MODULE(PFParticleValidation)
 
 
 #include "art/Framework/Principal/Event.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "art/Framework/Services/Optional/TFileService.h"
 
 #include "fhiclcpp/ParameterSet.h"
 
@@ -327,13 +382,26 @@ DEFINE_ART_MODULE(PFParticleValidation)
 #include "lardataobj/RecoBase/PFParticle.h"
 
 #include <algorithm>
+#include <cstdlib>
 #include <iostream>
 
 namespace lar_pandora
 {
 
 PFParticleValidation::PFParticleValidation(fhicl::ParameterSet const &pset) :
-    art::EDAnalyzer(pset)
+    art::EDAnalyzer(pset),
+    m_pValidationTree(nullptr),
+    m_run(0),
+    m_event(0),
+    m_isCorrect(0),
+    m_isCalculable(0),
+    m_hEventOutcome(nullptr),
+    m_hTargetPrimaryType(nullptr),
+    m_hCorrectPrimaryType(nullptr),
+    m_hTargetPrimaryHits(nullptr),
+    m_hCorrectPrimaryHits(nullptr),
+    m_hCompleteness(nullptr),
+    m_hPurity(nullptr)
 {
     this->reconfigure(pset);
 }
@@ -362,12 +430,49 @@ void PFParticleValidation::reconfigure(fhicl::ParameterSet const &pset)
     m_matchingMinSharedHits = pset.get<int>("MatchingMinSharedHits", 5);
     m_matchingMinCompleteness = pset.get<float>("MatchingMinCompleteness", 0.1f);
     m_matchingMinPurity = pset.get<float>("MatchingMinPurity", 0.5f);
+    m_nMatchingThreads = pset.get<unsigned int>("NMatchingThreads", 1);
+    m_writeToTree = pset.get<bool>("WriteToTree", false);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
 void PFParticleValidation::beginJob()
 {
+    if (!m_writeToTree)
+        return;
+
+    art::ServiceHandle<art::TFileService> tfs;
+
+    m_pValidationTree = tfs->make<TTree>("validation", "PFParticle validation");
+    m_pValidationTree->Branch("run", &m_run, "run/I");
+    m_pValidationTree->Branch("event", &m_event, "event/I");
+    m_pValidationTree->Branch("isCorrect", &m_isCorrect, "isCorrect/I");
+    m_pValidationTree->Branch("isCalculable", &m_isCalculable, "isCalculable/I");
+    m_pValidationTree->Branch("mcPrimaryId", &m_mcPrimaryId);
+    m_pValidationTree->Branch("mcPdg", &m_mcPdg);
+    m_pValidationTree->Branch("mcEnergy", &m_mcEnergy);
+    m_pValidationTree->Branch("mcNHits", &m_mcNHits);
+    m_pValidationTree->Branch("mcNHitsU", &m_mcNHitsU);
+    m_pValidationTree->Branch("mcNHitsV", &m_mcNHitsV);
+    m_pValidationTree->Branch("mcNHitsW", &m_mcNHitsW);
+    m_pValidationTree->Branch("mcIsTarget", &m_mcIsTarget);
+    m_pValidationTree->Branch("mcNSharedPfos", &m_mcNSharedPfos);
+    m_pValidationTree->Branch("mcNGoodMatches", &m_mcNGoodMatches);
+    m_pValidationTree->Branch("pfoId", &m_pfoId);
+    m_pValidationTree->Branch("pfoPdg", &m_pfoPdg);
+    m_pValidationTree->Branch("pfoNHits", &m_pfoNHits);
+    m_pValidationTree->Branch("pfoNMatchedHits", &m_pfoNMatchedHits);
+    m_pValidationTree->Branch("completeness", &m_completeness);
+    m_pValidationTree->Branch("purity", &m_purity);
+
+    // ATTN Histograms of counts, rather than ratios, so that the outputs of separate jobs can simply be added
+    m_hEventOutcome = tfs->make<TH1F>("hEventOutcome", "Events (0), calculable events (1), correct events (2)", 3, -0.5, 2.5);
+    m_hTargetPrimaryType = tfs->make<TH1F>("hTargetPrimaryType", "Target primaries (0: mu, 1: p, 2: pi, 3: e, 4: gamma, 5: other)", 6, -0.5, 5.5);
+    m_hCorrectPrimaryType = tfs->make<TH1F>("hCorrectPrimaryType", "Correctly matched target primaries, by type", 6, -0.5, 5.5);
+    m_hTargetPrimaryHits = tfs->make<TH1F>("hTargetPrimaryHits", "Target primaries;nMCHits", 50, 0., 2000.);
+    m_hCorrectPrimaryHits = tfs->make<TH1F>("hCorrectPrimaryHits", "Correctly matched target primaries;nMCHits", 50, 0., 2000.);
+    m_hCompleteness = tfs->make<TH1F>("hCompleteness", "Strongest assigned pfo;completeness", 50, 0., 1.0001);
+    m_hPurity = tfs->make<TH1F>("hPurity", "Strongest assigned pfo;purity", 50, 0., 1.0001);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -385,20 +490,20 @@ void PFParticleValidation::analyze(const art::Event &evt)
 
     PFParticlesToHits pfParticlesToHits;
     HitsToPFParticles hitsToPfParticles;
-    LArPandoraHelper::BuildPFParticleHitMaps(evt, m_particleLabel, m_clusterLabel, pfParticlesToHits, hitsToPfParticles, LArPandoraHelper::kAddDaughters);
+    LArPandoraHelper::BuildPFParticleHitMaps(evt, m_particleLabel, m_clusterLabel, pfParticlesToHits, hitsToPfParticles, LArPandoraHelper::kAddDaughters,
+        true, m_nMatchingThreads);
 
     MCParticlesToHits mcParticlesToHits;
     HitsToMCParticles hitsToMCParticles;
     LArPandoraHelper::BuildMCParticleHitMaps(evt, m_geantModuleLabel, hitVector, mcParticlesToHits, hitsToMCParticles, LArPandoraHelper::kAddDaughters);
 
-    MCParticleMatchingMap mcParticleMatchingMap;
-    this->GetMCParticleMatchingMap(pfParticlesToHits, mcParticlesToHits, hitsToMCParticles, mcParticleMatchingMap);
+    const MCParticleHitMatrix sharedHitMatrix(pfParticlesToHits, hitsToMCParticles, m_nMatchingThreads);
 
     SimpleMCPrimaryList simpleMCPrimaryList;
-    this->GetSimpleMCPrimaryList(evt, mcParticlesToHits, hitsToMCParticles, mcParticleMatchingMap, simpleMCPrimaryList);
+    this->GetSimpleMCPrimaryList(evt, mcParticlesToHits, sharedHitMatrix, simpleMCPrimaryList);
 
     MCPrimaryMatchingMap mcPrimaryMatchingMap;
-    this->GetMCPrimaryMatchingMap(simpleMCPrimaryList, mcParticleMatchingMap, pfParticlesToHits, mcPrimaryMatchingMap);
+    this->GetMCPrimaryMatchingMap(simpleMCPrimaryList, sharedHitMatrix, pfParticlesToHits, mcPrimaryMatchingMap);
 
     MCTruthVector mcTruthVector;
     this->GetMCTruth(evt, mcTruthVector);
@@ -409,49 +514,23 @@ void PFParticleValidation::analyze(const art::Event &evt)
     if (m_printAllToScreen)
         this->PrintAllOutput(mcTruthVector, recoNeutrinoVector, mcPrimaryMatchingMap);
 
-    if (m_printMatchingToScreen)
+    if (m_printMatchingToScreen || m_writeToTree)
     {
         MatchingDetailsMap matchingDetailsMap;
         this->PerformMatching(mcPrimaryMatchingMap, matchingDetailsMap);
-        this->PrintMatchingOutput(mcPrimaryMatchingMap, matchingDetailsMap);
-    }
-}
-
-//------------------------------------------------------------------------------------------------------------------------------------------
-
-void PFParticleValidation::GetMCParticleMatchingMap(const PFParticlesToHits &pfParticlesToHits, const MCParticlesToHits &mcParticlesToHits,
-    const HitsToMCParticles &hitsToMCParticles, MCParticleMatchingMap &mcParticleMatchingMap) const
-{
-    // Create a placeholder entry for all mc particles with >0 hits
-    for (const MCParticlesToHits::value_type &mcParticleToHitsEntry : mcParticlesToHits)
-    {
-        if (!mcParticleToHitsEntry.second.empty())
-            (void) mcParticleMatchingMap.insert(MCParticleMatchingMap::value_type(mcParticleToHitsEntry.first, PFParticleToMatchedHits()));
-    }
-
-    // Store true to reco matching details
-    for (const PFParticlesToHits::value_type &recoParticleToHits : pfParticlesToHits)
-    {
-        const art::Ptr<recob::PFParticle> pRecoParticle(recoParticleToHits.first);
-        const HitVector &hitVector(recoParticleToHits.second);
-
-        for (const art::Ptr<recob::Hit> pHit : hitVector)
-        {
-            HitsToMCParticles::const_iterator mcParticleIter = hitsToMCParticles.find(pHit);
 
-            if (hitsToMCParticles.end() == mcParticleIter)
-                continue;
+        if (m_printMatchingToScreen)
+            this->PrintMatchingOutput(mcPrimaryMatchingMap, matchingDetailsMap);
 
-            const art::Ptr<simb::MCParticle> pTrueParticle = mcParticleIter->second;    
-            mcParticleMatchingMap[pTrueParticle][pRecoParticle].push_back(pHit);
-        }
+        if (m_writeToTree)
+            this->WriteMatchingOutput(evt, mcPrimaryMatchingMap, matchingDetailsMap);
     }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
 void PFParticleValidation::GetSimpleMCPrimaryList(const art::Event &evt, const MCParticlesToHits &mcParticlesToHits,
-    const HitsToMCParticles &hitsToMCParticles, const MCParticleMatchingMap &mcParticleMatchingMap, SimpleMCPrimaryList &simpleMCPrimaryList) const
+    const MCParticleHitMatrix &sharedHitMatrix, SimpleMCPrimaryList &simpleMCPrimaryList) const
 {
     MCTruthToMCParticles artMCTruthToMCParticles;
     MCParticlesToMCTruth artMCParticlesToMCTruth;
@@ -470,21 +549,14 @@ void PFParticleValidation::GetSimpleMCPrimaryList(const art::Event &evt, const M
         simpleMCPrimary.m_pdgCode = pMCPrimary->PdgCode();
         simpleMCPrimary.m_energy = pMCPrimary->E();
 
-        MCParticlesToHits::const_iterator trueHitsIter = mcParticlesToHits.find(pMCPrimary);
+        const HitVector &hitVector(mapEntry.second);
+        simpleMCPrimary.m_nMCHitsTotal = hitVector.size();
+        this->CountHitsByView(hitVector, simpleMCPrimary.m_nMCHitsU, simpleMCPrimary.m_nMCHitsV, simpleMCPrimary.m_nMCHitsW);
 
-        if (mcParticlesToHits.end() != trueHitsIter)
-        {
-            const HitVector &hitVector(trueHitsIter->second);
-            simpleMCPrimary.m_nMCHitsTotal = hitVector.size();
-            simpleMCPrimary.m_nMCHitsU = this->CountHitsByType(geo::kU, hitVector);
-            simpleMCPrimary.m_nMCHitsV = this->CountHitsByType(geo::kV, hitVector);
-            simpleMCPrimary.m_nMCHitsW = this->CountHitsByType(geo::kW, hitVector);
-        }
-
-        MCParticleMatchingMap::const_iterator matchedPfoIter = mcParticleMatchingMap.find(pMCPrimary);
+        size_t trueIndex(0);
 
-        if (mcParticleMatchingMap.end() != matchedPfoIter)
-            simpleMCPrimary.m_nMatchedPfos = matchedPfoIter->second.size();
+        if (sharedHitMatrix.GetTrueIndex(pMCPrimary, trueIndex))
+            simpleMCPrimary.m_nMatchedPfos = sharedHitMatrix.GetNColumnCells(trueIndex);
 
         simpleMCPrimaryList.push_back(simpleMCPrimary);
     }
@@ -511,68 +583,43 @@ bool PFParticleValidation::IsNeutrinoInduced(const art::Ptr<simb::MCParticle> pM
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-void PFParticleValidation::GetMCPrimaryMatchingMap(const SimpleMCPrimaryList &simpleMCPrimaryList, const MCParticleMatchingMap &mcParticleMatchingMap,
+void PFParticleValidation::GetMCPrimaryMatchingMap(const SimpleMCPrimaryList &simpleMCPrimaryList, const MCParticleHitMatrix &sharedHitMatrix,
     const PFParticlesToHits &pfParticlesToHits, MCPrimaryMatchingMap &mcPrimaryMatchingMap) const
 {
+    // Index the matrix columns by mc particle address, as only the address is retained by the simple mc primaries
+    MCParticleAddressMap mcParticleAddressMap;
+
+    for (size_t trueIndex = 0; trueIndex < sharedHitMatrix.GetNTrueParticles(); ++trueIndex)
+        (void) mcParticleAddressMap.insert(MCParticleAddressMap::value_type(sharedHitMatrix.GetTrueParticle(trueIndex).get(), trueIndex));
+
+    SimpleMatchedPfoMap simpleMatchedPfoMap;
+    this->GetSimpleMatchedPfoMap(pfParticlesToHits, simpleMatchedPfoMap);
+
     for (const SimpleMCPrimary &simpleMCPrimary : simpleMCPrimaryList)
     {
         SimpleMatchedPfoList simpleMatchedPfoList;
-        MCParticleMatchingMap::const_iterator matchedPfoIter = mcParticleMatchingMap.end();
+        MCParticleAddressMap::const_iterator matchedPfoIter = mcParticleAddressMap.find(simpleMCPrimary.m_pAddress);
 
-        // ATTN Nasty workaround I
-        for (MCParticleMatchingMap::const_iterator iter = mcParticleMatchingMap.begin(), iterEnd = mcParticleMatchingMap.end(); iter != iterEnd; ++iter)
+        if (mcParticleAddressMap.end() != matchedPfoIter)
         {
-            if (simpleMCPrimary.m_pAddress == iter->first.get())
-            {
-                matchedPfoIter = iter;
-                break;
-            };
-        }
+            MCParticleHitMatrix::IndexVector cellIndices;
+            sharedHitMatrix.GetColumnCells(matchedPfoIter->second, cellIndices);
 
-        if (mcParticleMatchingMap.end() != matchedPfoIter)
-        {
-            for (const PFParticleToMatchedHits::value_type &contribution : matchedPfoIter->second)
+            for (const size_t cellIndex : cellIndices)
             {
-                const art::Ptr<recob::PFParticle> pMatchedPfo(contribution.first);
-                const HitVector &matchedHitVector(contribution.second);
-
-                SimpleMatchedPfo simpleMatchedPfo;
-                simpleMatchedPfo.m_pAddress = pMatchedPfo.get();
-                simpleMatchedPfo.m_id = pMatchedPfo->Self();
-
-                // ATTN Assume pfos have either zero or one parents. Ignore parent neutrino.
-                PFParticlesToHits::const_iterator parentPfoIter = pfParticlesToHits.end();
-
-                // ATTN Nasty workaround II, bad place for another loop.
-                for (PFParticlesToHits::const_iterator iter = pfParticlesToHits.begin(), iterEnd = pfParticlesToHits.end(); iter != iterEnd; ++iter)
-                {
-                    if (pMatchedPfo->Parent() == iter->first->Self())
-                    {
-                        parentPfoIter = iter;
-                        break;
-                    };
-                }
-
-                if ((pfParticlesToHits.end() != parentPfoIter) && !LArPandoraHelper::IsNeutrino(parentPfoIter->first))
-                    simpleMatchedPfo.m_parentId = parentPfoIter->first->Self();
-
-                simpleMatchedPfo.m_pdgCode = pMatchedPfo->PdgCode();
-                simpleMatchedPfo.m_nMatchedHitsTotal = matchedHitVector.size();
-                simpleMatchedPfo.m_nMatchedHitsU = this->CountHitsByType(geo::kU, matchedHitVector);
-                simpleMatchedPfo.m_nMatchedHitsV = this->CountHitsByType(geo::kV, matchedHitVector);
-                simpleMatchedPfo.m_nMatchedHitsW = this->CountHitsByType(geo::kW, matchedHitVector);
-
-                PFParticlesToHits::const_iterator pfoHitsIter = pfParticlesToHits.find(pMatchedPfo);
-
-                if (pfParticlesToHits.end() == pfoHitsIter)
-                    throw cet::exception("LArPandora") << " PFParticleValidation::analyze --- Presence of PFParticle in map mandatory.";
+                const art::Ptr<recob::PFParticle> pMatchedPfo(sharedHitMatrix.GetRecoParticle(sharedHitMatrix.GetCellRecoIndex(cellIndex)));
+                const HitViewCounts &matchedHitCounts(sharedHitMatrix.GetSharedHits(cellIndex));
 
-                const HitVector &pfoHitVector(pfoHitsIter->second);
+                SimpleMatchedPfoMap::const_iterator pfoIter = simpleMatchedPfoMap.find(pMatchedPfo.get());
+
+                if (simpleMatchedPfoMap.end() == pfoIter)
+                    throw cet::exception("LArPandora") << " PFParticleValidation::analyze --- Presence of PFParticle in map mandatory.";
 
-                simpleMatchedPfo.m_nPfoHitsTotal = pfoHitVector.size();
-                simpleMatchedPfo.m_nPfoHitsU = this->CountHitsByType(geo::kU, pfoHitVector);
-                simpleMatchedPfo.m_nPfoHitsV = this->CountHitsByType(geo::kV, pfoHitVector);
-                simpleMatchedPfo.m_nPfoHitsW = this->CountHitsByType(geo::kW, pfoHitVector);
+                SimpleMatchedPfo simpleMatchedPfo(pfoIter->second);
+                simpleMatchedPfo.m_nMatchedHitsTotal = matchedHitCounts.m_nHitsTotal;
+                simpleMatchedPfo.m_nMatchedHitsU = matchedHitCounts.m_nHitsU;
+                simpleMatchedPfo.m_nMatchedHitsV = matchedHitCounts.m_nHitsV;
+                simpleMatchedPfo.m_nMatchedHitsW = matchedHitCounts.m_nHitsW;
 
                 simpleMatchedPfoList.push_back(simpleMatchedPfo);
             }
@@ -588,6 +635,39 @@ void PFParticleValidation::GetMCPrimaryMatchingMap(const SimpleMCPrimaryList &si
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
+void PFParticleValidation::GetSimpleMatchedPfoMap(const PFParticlesToHits &pfParticlesToHits, SimpleMatchedPfoMap &simpleMatchedPfoMap) const
+{
+    // Index the pfos by Self(), for parent navigation
+    PFParticleMap pfParticleMap;
+
+    for (const PFParticlesToHits::value_type &mapEntry : pfParticlesToHits)
+        pfParticleMap[mapEntry.first->Self()] = mapEntry.first;
+
+    for (const PFParticlesToHits::value_type &mapEntry : pfParticlesToHits)
+    {
+        const art::Ptr<recob::PFParticle> pPfo(mapEntry.first);
+        const HitVector &pfoHitVector(mapEntry.second);
+
+        SimpleMatchedPfo simpleMatchedPfo;
+        simpleMatchedPfo.m_pAddress = pPfo.get();
+        simpleMatchedPfo.m_id = pPfo->Self();
+
+        // ATTN Assume pfos have either zero or one parents. Ignore parent neutrino.
+        PFParticleMap::const_iterator parentPfoIter = pfParticleMap.find(pPfo->Parent());
+
+        if ((pfParticleMap.end() != parentPfoIter) && !LArPandoraHelper::IsNeutrino(parentPfoIter->second))
+            simpleMatchedPfo.m_parentId = parentPfoIter->second->Self();
+
+        simpleMatchedPfo.m_pdgCode = pPfo->PdgCode();
+        simpleMatchedPfo.m_nPfoHitsTotal = pfoHitVector.size();
+        this->CountHitsByView(pfoHitVector, simpleMatchedPfo.m_nPfoHitsU, simpleMatchedPfo.m_nPfoHitsV, simpleMatchedPfo.m_nPfoHitsW);
+
+        (void) simpleMatchedPfoMap.insert(SimpleMatchedPfoMap::value_type(pPfo.get(), simpleMatchedPfo));
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
 void PFParticleValidation::GetMCTruth(const art::Event &evt, MCTruthVector &mcTruthVector) const
 {
     MCTruthToMCParticles artMCTruthToMCParticles;
@@ -800,6 +880,110 @@ void PFParticleValidation::PrintMatchingOutput(const MCPrimaryMatchingMap &mcPri
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
+void PFParticleValidation::WriteMatchingOutput(const art::Event &evt, const MCPrimaryMatchingMap &mcPrimaryMatchingMap,
+    const MatchingDetailsMap &matchingDetailsMap)
+{
+    m_run = evt.run();
+    m_event = evt.id().event();
+
+    m_mcPrimaryId.clear(); m_mcPdg.clear(); m_mcEnergy.clear(); m_mcNHits.clear(); m_mcNHitsU.clear(); m_mcNHitsV.clear(); m_mcNHitsW.clear();
+    m_mcIsTarget.clear(); m_mcNSharedPfos.clear(); m_mcNGoodMatches.clear();
+    m_pfoId.clear(); m_pfoPdg.clear(); m_pfoNHits.clear(); m_pfoNMatchedHits.clear(); m_completeness.clear(); m_purity.clear();
+
+    bool isCorrect(true), isCalculable(false);
+
+    for (const MCPrimaryMatchingMap::value_type &mapValue : mcPrimaryMatchingMap)
+    {
+        const SimpleMCPrimary &simpleMCPrimary(mapValue.first);
+        const bool isTargetPrimary(this->IsGoodMCPrimary(simpleMCPrimary) && (2112 != simpleMCPrimary.m_pdgCode));
+
+        // Consider only the pfos assigned to this primary; the list is ordered by number of matched hits, so the first is the strongest
+        const SimpleMatchedPfo *pStrongestPfo(nullptr);
+        int nMatches(0);
+
+        for (const SimpleMatchedPfo &simpleMatchedPfo : mapValue.second)
+        {
+            MatchingDetailsMap::const_iterator detailsIter = matchingDetailsMap.find(simpleMatchedPfo.m_id);
+
+            if ((matchingDetailsMap.end() == detailsIter) || (simpleMCPrimary.m_id != detailsIter->second.m_matchedPrimaryId))
+                continue;
+
+            if (!pStrongestPfo)
+                pStrongestPfo = &simpleMatchedPfo;
+
+            if (this->IsGoodMatch(simpleMCPrimary, simpleMatchedPfo))
+                ++nMatches;
+        }
+
+        // ATTN Follow the event-level definitions used by PrintMatchingOutput
+        if (pStrongestPfo || isTargetPrimary)
+        {
+            if (2112 != simpleMCPrimary.m_pdgCode)
+                isCalculable = true;
+
+            if (isTargetPrimary && (1 != nMatches))
+                isCorrect = false;
+        }
+
+        m_mcPrimaryId.push_back(simpleMCPrimary.m_id);
+        m_mcPdg.push_back(simpleMCPrimary.m_pdgCode);
+        m_mcEnergy.push_back(simpleMCPrimary.m_energy);
+        m_mcNHits.push_back(simpleMCPrimary.m_nMCHitsTotal);
+        m_mcNHitsU.push_back(simpleMCPrimary.m_nMCHitsU);
+        m_mcNHitsV.push_back(simpleMCPrimary.m_nMCHitsV);
+        m_mcNHitsW.push_back(simpleMCPrimary.m_nMCHitsW);
+        m_mcIsTarget.push_back(isTargetPrimary ? 1 : 0);
+        m_mcNSharedPfos.push_back(simpleMCPrimary.m_nMatchedPfos);
+        m_mcNGoodMatches.push_back(nMatches);
+
+        const int nMatchedHits(pStrongestPfo ? pStrongestPfo->m_nMatchedHitsTotal : 0);
+        const int nPfoHits(pStrongestPfo ? pStrongestPfo->m_nPfoHitsTotal : 0);
+        const float completeness((simpleMCPrimary.m_nMCHitsTotal > 0) ? static_cast<float>(nMatchedHits) / static_cast<float>(simpleMCPrimary.m_nMCHitsTotal) : 0.f);
+        const float purity((nPfoHits > 0) ? static_cast<float>(nMatchedHits) / static_cast<float>(nPfoHits) : 0.f);
+
+        m_pfoId.push_back(pStrongestPfo ? pStrongestPfo->m_id : -1);
+        m_pfoPdg.push_back(pStrongestPfo ? pStrongestPfo->m_pdgCode : 0);
+        m_pfoNHits.push_back(nPfoHits);
+        m_pfoNMatchedHits.push_back(nMatchedHits);
+        m_completeness.push_back(completeness);
+        m_purity.push_back(purity);
+
+        if (!isTargetPrimary)
+            continue;
+
+        const int primaryType(PFParticleValidation::GetPrimaryType(simpleMCPrimary.m_pdgCode));
+        m_hTargetPrimaryType->Fill(primaryType);
+        m_hTargetPrimaryHits->Fill(simpleMCPrimary.m_nMCHitsTotal);
+
+        if (1 == nMatches)
+        {
+            m_hCorrectPrimaryType->Fill(primaryType);
+            m_hCorrectPrimaryHits->Fill(simpleMCPrimary.m_nMCHitsTotal);
+        }
+
+        if (pStrongestPfo)
+        {
+            m_hCompleteness->Fill(completeness);
+            m_hPurity->Fill(purity);
+        }
+    }
+
+    m_isCorrect = ((isCorrect && isCalculable) ? 1 : 0);
+    m_isCalculable = (isCalculable ? 1 : 0);
+
+    m_hEventOutcome->Fill(0);
+
+    if (isCalculable)
+        m_hEventOutcome->Fill(1);
+
+    if (m_isCorrect)
+        m_hEventOutcome->Fill(2);
+
+    m_pValidationTree->Fill();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
 bool PFParticleValidation::IsGoodMCPrimary(const SimpleMCPrimary &simpleMCPrimary) const
 {
     if (simpleMCPrimary.m_nMCHitsTotal < m_matchingMinPrimaryHits)
@@ -842,17 +1026,27 @@ bool PFParticleValidation::IsGoodMatch(const SimpleMCPrimary &simpleMCPrimary, c
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-unsigned int PFParticleValidation::CountHitsByType(const geo::View_t view, const HitVector &hitVector) const
+void PFParticleValidation::CountHitsByView(const HitVector &hitVector, int &nHitsU, int &nHitsV, int &nHitsW) const
 {
-    unsigned int nHitsOfSpecifiedType(0);
+    nHitsU = 0; nHitsV = 0; nHitsW = 0;
 
     for (const art::Ptr<recob::Hit> pHit : hitVector)
     {
-        if (view == pHit->View())
-            ++nHitsOfSpecifiedType;
-    }
+        const geo::View_t view(pHit->View());
 
-    return nHitsOfSpecifiedType;
+        if (geo::kU == view)
+        {
+            ++nHitsU;
+        }
+        else if (geo::kV == view)
+        {
+            ++nHitsV;
+        }
+        else if (geo::kW == view)
+        {
+            ++nHitsW;
+        }
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -878,6 +1072,21 @@ bool PFParticleValidation::SortSimpleMatchedPfos(const SimpleMatchedPfo &lhs, co
     return (lhs.m_id < rhs.m_id);
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+int PFParticleValidation::GetPrimaryType(const int pdgCode)
+{
+    switch (std::abs(pdgCode))
+    {
+        case 13:   return 0;
+        case 2212: return 1;
+        case 211:  return 2;
+        case 11:   return 3;
+        case 22:   return 4;
+        default:   return 5;
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 //------------------------------------------------------------------------------------------------------------------------------------------
 
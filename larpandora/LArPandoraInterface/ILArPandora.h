@@ -9,6 +9,8 @@
 
 #include "art/Framework/Core/EDProducer.h"
 
+#include <vector>
+
 namespace recob {class Hit;}
 namespace pandora {class Pandora;}
 
@@ -18,6 +20,7 @@ namespace lar_pandora
 {
 
 typedef std::map< int, art::Ptr<recob::Hit> > IdToHitMap;
+typedef std::map< const pandora::Pandora*, unsigned int > PandoraInstanceHitCountMap;
 
 /**
  *  @brief  ILArPandora class
@@ -45,6 +48,40 @@ public:
      */
     virtual int GetVolumeIdNumber(const unsigned int cryostat, const unsigned int tpc) const = 0;
 
+    /**
+     *  @brief  Get the id numbers of the volumes receiving input from the given cryostat and tpc numbers, within a range of z coordinates.
+     *          Input in the overlap between neighbouring volumes is passed to each of them. By default, this is the single volume given by
+     *          GetVolumeIdNumber.
+     *
+     *  @param  cryostat the cryostat number
+     *  @param  tpc the tpc number
+     *  @param  minZ the minimum z coordinate
+     *  @param  maxZ the maximum z coordinate
+     *  @param  volumeIdNumbers to receive the volume id numbers
+     */
+    virtual void GetVolumeIdNumbers(const unsigned int cryostat, const unsigned int tpc, const double minZ, const double maxZ,
+        std::vector<int> &volumeIdNumbers) const;
+
+    /**
+     *  @brief  Get the id numbers of the volumes receiving input from the given cryostat and tpc numbers, within a range of z coordinates
+     *          and at a given drift time. By default, volumes are not divided in time and this is the same as the time-independent result.
+     *
+     *  @param  cryostat the cryostat number
+     *  @param  tpc the tpc number
+     *  @param  minZ the minimum z coordinate
+     *  @param  maxZ the maximum z coordinate
+     *  @param  time the drift time [ticks]
+     *  @param  volumeIdNumbers to receive the volume id numbers
+     */
+    virtual void GetVolumeIdNumbers(const unsigned int cryostat, const unsigned int tpc, const double minZ, const double maxZ, const double time,
+        std::vector<int> &volumeIdNumbers) const;
+
+    /**
+     *  @brief  Whether the volumes receiving input depend only on the cryostat and tpc numbers, i.e. volumes are not divided in z or in
+     *          drift time, so that the volume id numbers need only be evaluated once per tpc. By default, this is the case.
+     */
+    virtual bool IsInputRoutedByTpc() const;
+
 protected:
     /**
      *  @brief  Create pandora instances
@@ -98,6 +135,29 @@ inline ILArPandora::~ILArPandora()
 {
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline void ILArPandora::GetVolumeIdNumbers(const unsigned int cryostat, const unsigned int tpc, const double /*minZ*/, const double /*maxZ*/,
+    std::vector<int> &volumeIdNumbers) const
+{
+    volumeIdNumbers.push_back(this->GetVolumeIdNumber(cryostat, tpc));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline void ILArPandora::GetVolumeIdNumbers(const unsigned int cryostat, const unsigned int tpc, const double minZ, const double maxZ,
+    const double /*time*/, std::vector<int> &volumeIdNumbers) const
+{
+    this->GetVolumeIdNumbers(cryostat, tpc, minZ, maxZ, volumeIdNumbers);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline bool ILArPandora::IsInputRoutedByTpc() const
+{
+    return true;
+}
+
 } // namespace lar_pandora
 
 #endif // #ifndef I_LAR_PANDORA_H
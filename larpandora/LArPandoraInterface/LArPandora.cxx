@@ -32,11 +32,16 @@
 
 #include "larpandora/LArPandoraInterface/LArPandora.h"
 #include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
+#include "larpandora/LArPandoraInterface/LArPandoraHitCacheService.h"
+#include "larpandora/LArPandoraInterface/LArPandoraHitInput.h"
+#include "larpandora/LArPandoraInterface/LArPandoraHitSoA.h"
 #include "larpandora/LArPandoraInterface/LArPandoraInput.h"
 #include "larpandora/LArPandoraInterface/LArPandoraOutput.h"
 
 #include "larpandora/LArPandoraShowers/PCAShowerParticleBuildingAlgorithm.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 namespace lar_pandora
@@ -45,7 +50,9 @@ namespace lar_pandora
 LArPandora::LArPandora(fhicl::ParameterSet const &pset) :
     ILArPandora(pset)
 {
-    m_configFile = pset.get<std::string>("ConfigFile");
+    m_enableTwoDOnly = pset.get<bool>("EnableTwoDOnly", false);
+    m_configFile = m_enableTwoDOnly ? pset.get<std::string>("TwoDOnlyConfigFile", pset.get<std::string>("ConfigFile")) :
+        pset.get<std::string>("ConfigFile");
     m_stitchingConfigFile = pset.get<std::string>("StitchingConfigFile", "No_File_Provided");
     
     // prepare the optional cluster energy algorithm
@@ -70,22 +77,37 @@ LArPandora::LArPandora(fhicl::ParameterSet const &pset) :
     m_outputSettings.m_buildTracks = pset.get<bool>("BuildTracks", true);
     m_outputSettings.m_buildShowers = pset.get<bool>("BuildShowers", true);
     m_outputSettings.m_buildStitchedParticles = pset.get<bool>("BuildStitchedParticles", false);
-    m_outputSettings.m_buildSingleVolumeParticles = pset.get<bool>("BuildSingleVolumeParticles", true);
+    m_outputSettings.m_buildSingleVolumeParticles = m_enableTwoDOnly || pset.get<bool>("BuildSingleVolumeParticles", true);
+    m_outputSettings.m_twoDClusterListNames = pset.get<std::vector<std::string>>("TwoDClusterListNames",
+        m_outputSettings.m_twoDClusterListNames);
     m_outputSettings.m_showerEnergyAlg = m_showerEnergyAlg.get(); // may be nullptr
 
-    m_runStitchingInstance = pset.get<bool>("RunStitchingInstance", true);
+    // In the 2D-only mode there are no 3D particles to stitch between drift volumes
+    m_runStitchingInstance = !m_enableTwoDOnly && pset.get<bool>("RunStitchingInstance", true);
     m_enableProduction = pset.get<bool>("EnableProduction", true);
     m_enableLineGaps = pset.get<bool>("EnableLineGaps", true);
     m_lineGapsCreated = false;
     m_enableMCParticles = pset.get<bool>("EnableMCParticles", false);
     m_enableMonitoring = pset.get<bool>("EnableMonitoring", false);
+    m_useHitCacheService = pset.get<bool>("UseHitCacheService", false);
+    m_nProcessingThreads = pset.get<unsigned int>("NProcessingThreads", 1);
+    m_processingCostPerHit = pset.get<float>("ProcessingCostPerHit", 1.e-5f);
+    m_processingCostExponent = pset.get<float>("ProcessingCostExponent", 1.f);
+    m_eventTimeBudget = pset.get<float>("EventTimeBudget", 0.f);
+    m_volumeTimeBudget = pset.get<float>("VolumeTimeBudget", 0.f);
+    m_degraded = 0;
 
     m_geantModuleLabel = pset.get<std::string>("GeantModuleLabel", "largeant");
     m_hitfinderModuleLabel = pset.get<std::string>("HitFinderModuleLabel", "gaushit");
     m_spacepointModuleLabel = pset.get<std::string>("SpacePointModuleLabel", "pandora");
     m_pandoraModuleLabel = pset.get<std::string>("PFParticleModuleLabel", "pandora");
 
-    if (m_enableProduction)
+    if (m_enableProduction && m_enableTwoDOnly)
+    {
+        produces< std::vector<recob::Cluster> >();
+        produces< art::Assns<recob::Cluster, recob::Hit> >();
+    }
+    else if (m_enableProduction)
     {
         produces< std::vector<recob::PFParticle> >();
         produces< std::vector<recob::SpacePoint> >();
@@ -167,6 +189,7 @@ void LArPandora::produce(art::Event &evt)
         );
     } // if
     
+    m_eventStartTime = std::chrono::steady_clock::now();
     
     IdToHitMap idToHitMap;
     this->CreatePandoraInput(evt, idToHitMap);
@@ -188,33 +211,35 @@ void LArPandora::produce(art::Event &evt)
 
 void LArPandora::CreatePandoraInput(art::Event &evt, IdToHitMap &idToHitMap)
 {
-    // ATTN Should complete gap creation in begin job callback, but channel status service functionality unavailable at that point
-    if (!m_lineGapsCreated && m_enableLineGaps)
-    {
-        LArPandoraInput::CreatePandoraLineGaps(m_inputSettings);
-        m_lineGapsCreated = true;
-    }
-
     cet::cpu_timer theClock;
 
     if (m_enableMonitoring)
         theClock.start();
 
-    HitVector artHits;
     SimChannelVector artSimChannels;
     HitsToTrackIDEs artHitsToTrackIDEs;
     MCParticleVector artMCParticleVector;
     MCTruthToMCParticles artMCTruthToMCParticles;
     MCParticlesToMCTruth artMCParticlesToMCTruth;
 
-    LArPandoraHelper::CollectHits(evt, m_hitfinderModuleLabel, artHits);
+    // The hits are collected and calibrated once per event, by whichever producer requests them first if the cache service is enabled
+    std::unique_ptr<HitInput> pLocalHitInput;
+
+    if (!m_useHitCacheService)
+        pLocalHitInput.reset(new HitInput(evt, m_hitfinderModuleLabel, m_inputSettings));
+
+    const HitInput &hitInput(m_useHitCacheService ?
+        art::ServiceHandle<LArPandoraHitCacheService>()->GetHitInput(evt, m_hitfinderModuleLabel, m_inputSettings) : *pLocalHitInput);
+
+    const HitVector &artHits(hitInput.GetHitVector());
+    const HitSoA &artHitSoA(hitInput.GetHitSoA());
 
     if (m_enableMCParticles && !evt.isRealData())
     {
         LArPandoraHelper::CollectMCParticles(evt, m_geantModuleLabel, artMCParticleVector);
         LArPandoraHelper::CollectMCParticles(evt, m_geantModuleLabel, artMCTruthToMCParticles, artMCParticlesToMCTruth);
         LArPandoraHelper::CollectSimChannels(evt, m_geantModuleLabel, artSimChannels);
-        LArPandoraHelper::BuildMCParticleHitMaps(artHits, artSimChannels, artHitsToTrackIDEs);
+        LArPandoraHelper::BuildMCParticleHitMaps(artHits, artHitSoA, artSimChannels, artHitsToTrackIDEs);
     }
 
     if (m_enableMonitoring)
@@ -225,13 +250,38 @@ void LArPandora::CreatePandoraInput(art::Event &evt, IdToHitMap &idToHitMap)
         theClock.start();
     }
 
-    LArPandoraInput::CreatePandoraHits2D(m_inputSettings, artHits, idToHitMap);
+    PandoraInstanceList newPandoraInstances;
+    this->PreparePandoraInstances(artHitSoA, hitInput.GetHitInputSoA(), newPandoraInstances);
+
+    // The primary instance is recreated if idle daughter instances are evicted
+    m_inputSettings.m_pPrimaryPandora = m_pPrimaryPandora;
+    m_outputSettings.m_pPrimaryPandora = m_pPrimaryPandora;
+
+    // ATTN Should complete gap creation in begin job callback, but channel status service functionality unavailable at that point
+    if (m_enableLineGaps)
+    {
+        if (!m_lineGapsCreated)
+        {
+            LArPandoraInput::CreatePandoraLineGaps(m_inputSettings);
+            m_lineGapsCreated = true;
+        }
+        else
+        {
+            for (const pandora::Pandora *const pPandora : newPandoraInstances)
+                LArPandoraInput::CreatePandoraLineGaps(m_inputSettings, pPandora);
+        }
+    }
+
+    m_instanceHitCountMap.clear();
+    PandoraInstanceList hitInstanceList;
+    LArPandoraInput::CreatePandoraHits2D(m_inputSettings, artHits, artHitSoA, hitInput.GetHitInputSoA(), idToHitMap, m_instanceHitCountMap,
+        hitInstanceList);
 
     if (m_enableMCParticles && !evt.isRealData())
     {
         LArPandoraInput::CreatePandoraMCParticles(m_inputSettings, artMCTruthToMCParticles, artMCParticlesToMCTruth);
         LArPandoraInput::CreatePandoraMCParticles2D(m_inputSettings, artMCParticleVector);
-        LArPandoraInput::CreatePandoraMCLinks2D(m_inputSettings, idToHitMap, artHitsToTrackIDEs);
+        LArPandoraInput::CreatePandoraMCLinks2D(m_inputSettings, idToHitMap, hitInstanceList, artHitsToTrackIDEs);
     }
 
     if (m_enableMonitoring)
@@ -252,8 +302,14 @@ void LArPandora::ProcessPandoraOutput(art::Event &evt, const IdToHitMap &idToHit
     if (m_enableMonitoring)
         theClock.start();
 
-    if (m_enableProduction)
+    if (m_enableProduction && m_enableTwoDOnly)
+    {
+        LArPandoraOutput::ProduceTwoDArtOutput(m_outputSettings, idToHitMap, m_reconstructedInstances, evt);
+    }
+    else if (m_enableProduction)
+    {
         LArPandoraOutput::ProduceArtOutput(m_outputSettings, idToHitMap, evt);
+    }
 
     if (m_enableMonitoring)
     {
@@ -274,14 +330,119 @@ void LArPandora::RunPandoraInstances()
 
     const PandoraInstanceList &daughterInstances(MultiPandoraApi::GetDaughterPandoraInstanceList(m_pPrimaryPandora));
 
-    for (const pandora::Pandora *const pPandora : daughterInstances)
+    // Predict the cost of each daughter instance from its number of input hits, then start the most expensive instances first
+    std::vector<const pandora::Pandora*> instanceVector(daughterInstances.begin(), daughterInstances.end());
+    std::vector<int> hitCounts;
+
+    for (const pandora::Pandora *const pPandora : instanceVector)
+    {
+        PandoraInstanceHitCountMap::const_iterator iter = m_instanceHitCountMap.find(pPandora);
+        hitCounts.push_back((m_instanceHitCountMap.end() != iter) ? static_cast<int>(iter->second) : 0);
+    }
+
+    std::vector<size_t> processingOrder(instanceVector.size());
+
+    for (size_t index = 0; index < processingOrder.size(); ++index)
+        processingOrder[index] = index;
+
+    std::stable_sort(processingOrder.begin(), processingOrder.end(), [&hitCounts](const size_t lhs, const size_t rhs)
+        {return (hitCounts[lhs] > hitCounts[rhs]);});
+
+    std::vector<float> processTimes(instanceVector.size(), 0.f);
+    std::vector<int> volumeStatus(instanceVector.size(), VOLUME_PROCESSED);
+
+    for (size_t instanceIndex = 0; instanceIndex < instanceVector.size(); ++instanceIndex)
     {
-        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::ProcessEvent(*pPandora));
-        this->SetParticleX0Values(pPandora);        
+        if (this->IsFallbackPandoraInstance(instanceVector[instanceIndex]))
+            volumeStatus[instanceIndex] = VOLUME_FALLBACK;
     }
 
-    if (m_runStitchingInstance || daughterInstances.empty())
+    LArPandoraHelper::ProcessQueueInParallel(processingOrder.size(), m_nProcessingThreads, [&](const size_t index)
+    {
+        const size_t instanceIndex(processingOrder[index]);
+
+        // ATTN A running instance cannot be interrupted, so the time budget is enforced as each instance starts. Skipped instances give no pfos
+        if (this->IsOverTimeBudget(hitCounts[instanceIndex], VOLUME_FALLBACK == volumeStatus[instanceIndex]))
+        {
+            volumeStatus[instanceIndex] = VOLUME_SKIPPED;
+            return;
+        }
+
+        cet::cpu_timer instanceClock;
+        instanceClock.start();
+        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::ProcessEvent(*instanceVector[instanceIndex]));
+        instanceClock.stop();
+        processTimes[instanceIndex] = instanceClock.accumulated_real_time();
+    });
+
+    // ATTN The x0 values are held in the shared multi-pandora maps, so are only set once all instances have finished
+    for (const pandora::Pandora *const pPandora : instanceVector)
+        this->SetParticleX0Values(pPandora);
+
+    // Record the instances that reconstructed input hits, which are those expected to hold output
+    m_reconstructedInstances.clear();
+
+    for (const size_t instanceIndex : processingOrder)
+    {
+        if ((VOLUME_SKIPPED != volumeStatus[instanceIndex]) && (hitCounts[instanceIndex] > 0))
+            m_reconstructedInstances.push_back(instanceVector[instanceIndex]);
+    }
+
+    m_degraded = 0;
+
+    for (const size_t instanceIndex : processingOrder)
+    {
+        if (VOLUME_PROCESSED == volumeStatus[instanceIndex])
+            continue;
+
+        m_degraded = 1;
+        mf::LogWarning("LArPandora") << " Volume " << MultiPandoraApi::GetVolumeInfo(instanceVector[instanceIndex]).GetIdNumber() << " with "
+            << hitCounts[instanceIndex] << " hits exceeds the processing time budget, "
+            << ((VOLUME_FALLBACK == volumeStatus[instanceIndex]) ? "reconstructed with fallback settings" : "skipped") << std::endl;
+    }
+
+    if (m_enableMonitoring)
+    {
+        m_volumeIds.clear();
+        m_volumeHits.clear();
+        m_volumePredictedTimes.clear();
+        m_volumeProcessTimes.clear();
+        m_volumeStatus.clear();
+
+        for (const size_t instanceIndex : processingOrder)
+        {
+            const int nHits(hitCounts[instanceIndex]);
+            m_volumeIds.push_back(MultiPandoraApi::GetVolumeInfo(instanceVector[instanceIndex]).GetIdNumber());
+            m_volumeHits.push_back(nHits);
+            m_volumePredictedTimes.push_back(this->GetPredictedProcessingTime(nHits));
+            m_volumeProcessTimes.push_back(processTimes[instanceIndex]);
+            m_volumeStatus.push_back(volumeStatus[instanceIndex]);
+        }
+    }
+
+    // Without daughter instances, the primary instance reconstructs the whole event and is subject to the same time budget
+    if (daughterInstances.empty())
+    {
+        PandoraInstanceHitCountMap::const_iterator iter = m_instanceHitCountMap.find(m_pPrimaryPandora);
+        const unsigned int nHits((m_instanceHitCountMap.end() != iter) ? iter->second : 0);
+
+        if (this->IsOverTimeBudget(nHits, false))
+        {
+            m_degraded = 1;
+            mf::LogWarning("LArPandora") << " Event with " << nHits << " hits exceeds the processing time budget, skipped " << std::endl;
+        }
+        else
+        {
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::ProcessEvent(*m_pPrimaryPandora));
+
+            if (nHits > 0)
+                m_reconstructedInstances.push_back(m_pPrimaryPandora);
+        }
+    }
+    else if (m_runStitchingInstance)
+    {
         PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::ProcessEvent(*m_pPrimaryPandora));
+    }
 
     if (m_enableMonitoring)
     { 
@@ -331,6 +492,13 @@ const pandora::Pandora *LArPandora::CreateNewPandora() const
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
+void LArPandora::PreparePandoraInstances(const HitSoA &/*hitSoA*/, const HitInputSoA &/*hitInputSoA*/,
+    PandoraInstanceList &/*newPandoraInstances*/)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
 void LArPandora::SetParticleX0Values(const pandora::Pandora *const pPandora) const
 {
     // ATTN Just a placeholder for a proper treatment
@@ -346,6 +514,38 @@ void LArPandora::SetParticleX0Values(const pandora::Pandora *const pPandora) con
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
+bool LArPandora::IsFallbackPandoraInstance(const pandora::Pandora *const /*pPandora*/) const
+{
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+float LArPandora::GetPredictedProcessingTime(const unsigned int nHits) const
+{
+    return (m_processingCostPerHit * std::pow(static_cast<float>(nHits), m_processingCostExponent));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool LArPandora::IsOverTimeBudget(const unsigned int nHits, const bool isFallbackInstance) const
+{
+    if (!isFallbackInstance && (m_volumeTimeBudget > 0.f) && (this->GetPredictedProcessingTime(nHits) > m_volumeTimeBudget))
+        return true;
+
+    if (m_eventTimeBudget > 0.f)
+    {
+        const std::chrono::duration<float> elapsedTime(std::chrono::steady_clock::now() - m_eventStartTime);
+
+        if (elapsedTime.count() > m_eventTimeBudget)
+            return true;
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
 void LArPandora::InitializeMonitoring()
 {
     art::ServiceHandle<art::TFileService> tfs;
@@ -358,6 +558,12 @@ void LArPandora::InitializeMonitoring()
     m_pRecoTree->Branch("inputTime", &m_inputTime, "inputTime/F");
     m_pRecoTree->Branch("processTime", &m_processTime, "processTime/F");
     m_pRecoTree->Branch("outputTime", &m_outputTime, "outputTime/F");
+    m_pRecoTree->Branch("volumeIds", &m_volumeIds);
+    m_pRecoTree->Branch("volumeHits", &m_volumeHits);
+    m_pRecoTree->Branch("volumePredictedTimes", &m_volumePredictedTimes);
+    m_pRecoTree->Branch("volumeProcessTimes", &m_volumeProcessTimes);
+    m_pRecoTree->Branch("volumeStatus", &m_volumeStatus);
+    m_pRecoTree->Branch("degraded", &m_degraded, "degraded/I");
 }
 
 } // namespace lar_pandora
@@ -9,11 +9,16 @@
 #define LAR_PANDORA_H 1
 
 #include "larpandora/LArPandoraInterface/ILArPandora.h"
+#include "larpandora/LArPandoraInterface/LArPandoraHitInput.h"
 #include "larpandora/LArPandoraInterface/LArPandoraInput.h"
 #include "larpandora/LArPandoraInterface/LArPandoraOutput.h"
 #include "larreco/Calorimetry/LinearEnergyAlg.h"
 
+#include "larpandoracontent/LArStitching/MultiPandoraApi.h"
+
+#include <chrono>
 #include <string>
+#include <vector>
 #include <memory> // std::unique_ptr<>
 
 class TTree;
@@ -59,12 +64,41 @@ protected:
     const pandora::Pandora *CreateNewPandora() const;
 
     /**
-     *  @brief  Set x0 values for all pfos created by the specified pandora isntance
+     *  @brief  Make sure that the pandora instances needed to reconstruct the event exist, before the input hits are created.
+     *          By default, all instances are created at the start of the job and there is nothing to do.
+     *
+     *  @param  hitSoA the hits in the event
+     *  @param  hitInputSoA the pandora 2D hit inputs of the hits in the event
+     *  @param  newPandoraInstances to receive the addresses of any pandora instances created for this event
+     */
+    virtual void PreparePandoraInstances(const HitSoA &hitSoA, const HitInputSoA &hitInputSoA, PandoraInstanceList &newPandoraInstances);
+
+    /**
+     *  @brief  Set x0 values for all pfos created by the specified pandora isntance. The values are held per instance, so are local to
+     *          the drift volume (or time slice) reconstructed by that instance. No t0 is determined for a time slice, whose hits are
+     *          placed using their full drift time, so its x0 values are zero.
      *
      *  @param  pPandora the address of the relevant pandora instance
      */
     void SetParticleX0Values(const pandora::Pandora *const pPandora) const;
 
+    /**
+     *  @brief  Whether a daughter pandora instance reconstructs its volume with the lighter fallback settings, in which case it is exempt
+     *          from the per-volume processing time budget. By default, there are no fallback instances.
+     *
+     *  @param  pPandora the address of the relevant pandora instance
+     */
+    virtual bool IsFallbackPandoraInstance(const pandora::Pandora *const pPandora) const;
+
+    /**
+     *  @brief  Get the predicted processing time of a pandora instance
+     *
+     *  @param  nHits the number of input hits passed to the instance
+     *
+     *  @return the predicted processing time [s]
+     */
+    float GetPredictedProcessingTime(const unsigned int nHits) const;
+
     /**
      *  @brief Initialize the internal monitoring
      */
@@ -72,8 +106,27 @@ protected:
 
     std::string                 m_configFile;               ///<
     std::string                 m_stitchingConfigFile;      ///<
+    float                       m_volumeTimeBudget;         ///< The predicted processing time above which a volume is degraded [s] (0: none)
 
 private:
+    /**
+     *  @brief  The processing status of each volume
+     */
+    enum VolumeStatus
+    {
+        VOLUME_PROCESSED = 0,                               ///< Reconstructed with the standard settings
+        VOLUME_FALLBACK = 1,                                ///< Reconstructed with the fallback settings
+        VOLUME_SKIPPED = 2                                  ///< Not reconstructed, giving an empty result
+    };
+
+    /**
+     *  @brief  Whether a pandora instance must be skipped, as it would exceed the processing time budget of the volume or of the event
+     *
+     *  @param  nHits the number of input hits passed to the instance
+     *  @param  isFallbackInstance whether the instance uses the fallback settings
+     */
+    bool IsOverTimeBudget(const unsigned int nHits, const bool isFallbackInstance) const;
+
     LArPandoraInput::Settings   m_inputSettings;            ///< 
     LArPandoraOutput::Settings  m_outputSettings;           ///<    
 
@@ -81,10 +134,20 @@ private:
                                                             ///< Optional cluster energy algorithm.
     bool                        m_runStitchingInstance;     ///<
     bool                        m_enableProduction;         ///<
+    bool                        m_enableTwoDOnly;           ///< Whether to run the reduced 2D-only reconstruction, writing only clusters
     bool                        m_enableLineGaps;           ///<
     bool                        m_lineGapsCreated;          ///<
     bool                        m_enableMCParticles;        ///<
     bool                        m_enableMonitoring;         ///<
+    bool                        m_useHitCacheService;       ///< Whether to share the converted input hits with other producers in the job
+    unsigned int                m_nProcessingThreads;       ///< The maximum number of daughter instances to process concurrently
+    float                       m_processingCostPerHit;     ///< Scale of the predicted processing time per input hit [s]
+    float                       m_processingCostExponent;   ///< Exponent of the number of input hits in the predicted processing time
+    float                       m_eventTimeBudget;          ///< The wall-clock time after which no further volumes are started [s] (0: none)
+    std::chrono::steady_clock::time_point m_eventStartTime; ///< The wall-clock time at the start of the current event
+
+    PandoraInstanceHitCountMap  m_instanceHitCountMap;      ///< The number of input hits passed to each pandora instance in this event
+    PandoraInstanceList         m_reconstructedInstances;   ///< The pandora instances that reconstructed input hits in this event
 
     std::string                 m_geantModuleLabel;         ///<
     std::string                 m_hitfinderModuleLabel;     ///<
@@ -100,6 +163,12 @@ private:
     float                       m_inputTime;                ///<
     float                       m_processTime;              ///<
     float                       m_outputTime;               ///<
+    std::vector<int>            m_volumeIds;                ///< The volume id of each daughter instance, in processing order
+    std::vector<int>            m_volumeHits;               ///< The number of input hits for each daughter instance
+    std::vector<float>          m_volumePredictedTimes;     ///< The predicted processing time for each daughter instance
+    std::vector<float>          m_volumeProcessTimes;       ///< The actual processing time for each daughter instance
+    std::vector<int>            m_volumeStatus;             ///< The processing status of each daughter instance
+    int                         m_degraded;                 ///< Whether any volume was degraded to meet the processing time budget
 };
 
 } // namespace lar_pandora
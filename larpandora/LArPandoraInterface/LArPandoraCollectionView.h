@@ -0,0 +1,190 @@
+/**
+ *  @file   larpandora/LArPandoraInterface/LArPandoraCollectionView.h
+ *
+ *  @brief  Lightweight read-only view of a data product collection in the ART event record
+ */
+
+#ifndef LAR_PANDORA_COLLECTION_VIEW_H
+#define LAR_PANDORA_COLLECTION_VIEW_H 1
+
+#include "art/Framework/Principal/Handle.h"
+#include "canvas/Persistency/Common/Ptr.h"
+
+#include <vector>
+
+namespace lar_pandora
+{
+
+/**
+ *  @brief  CollectionView class, wrapping the handle to a collection and creating art::Ptr objects only on request
+ */
+template <typename T>
+class CollectionView
+{
+public:
+    typedef typename std::vector<T>::const_iterator const_iterator;
+
+    /**
+     *  @brief  Default constructor, creating an empty view
+     */
+    CollectionView();
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  handle the handle to the collection
+     */
+    CollectionView(const art::Handle< std::vector<T> > &handle);
+
+    /**
+     *  @brief  Whether the view refers to a valid collection
+     */
+    bool IsValid() const;
+
+    /**
+     *  @brief  Return the number of objects in the collection
+     */
+    size_t size() const;
+
+    /**
+     *  @brief  Whether the collection is empty
+     */
+    bool empty() const;
+
+    /**
+     *  @brief  Return the object at a given index, without creating an art::Ptr
+     *
+     *  @param  index the index
+     */
+    const T &operator[](const size_t index) const;
+
+    /**
+     *  @brief  Return an iterator to the first object in the collection
+     */
+    const_iterator begin() const;
+
+    /**
+     *  @brief  Return an iterator past the last object in the collection
+     */
+    const_iterator end() const;
+
+    /**
+     *  @brief  Create an art::Ptr to the object at a given index
+     *
+     *  @param  index the index
+     */
+    art::Ptr<T> GetPtr(const size_t index) const;
+
+    /**
+     *  @brief  Append an art::Ptr to each object in the collection to a vector
+     *
+     *  @param  ptrVector the output vector of art::Ptr objects
+     */
+    void GetPtrVector(std::vector< art::Ptr<T> > &ptrVector) const;
+
+    /**
+     *  @brief  Return the handle to the collection
+     */
+    const art::Handle< std::vector<T> > &GetHandle() const;
+
+private:
+    art::Handle< std::vector<T> >   m_handle;       ///< The handle to the collection
+    const std::vector<T>           *m_pCollection;  ///< Address of the collection, or null if the handle is invalid
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline CollectionView<T>::CollectionView() :
+    m_pCollection(nullptr)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline CollectionView<T>::CollectionView(const art::Handle< std::vector<T> > &handle) :
+    m_handle(handle),
+    m_pCollection(handle.isValid() ? handle.product() : nullptr)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline bool CollectionView<T>::IsValid() const
+{
+    return (nullptr != m_pCollection);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline size_t CollectionView<T>::size() const
+{
+    return (m_pCollection ? m_pCollection->size() : 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline bool CollectionView<T>::empty() const
+{
+    return (0 == this->size());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline const T &CollectionView<T>::operator[](const size_t index) const
+{
+    return (*m_pCollection)[index];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline typename CollectionView<T>::const_iterator CollectionView<T>::begin() const
+{
+    return (m_pCollection ? m_pCollection->begin() : const_iterator());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline typename CollectionView<T>::const_iterator CollectionView<T>::end() const
+{
+    return (m_pCollection ? m_pCollection->end() : const_iterator());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline art::Ptr<T> CollectionView<T>::GetPtr(const size_t index) const
+{
+    return art::Ptr<T>(m_handle, index);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline void CollectionView<T>::GetPtrVector(std::vector< art::Ptr<T> > &ptrVector) const
+{
+    const size_t nObjects(this->size());
+    ptrVector.reserve(ptrVector.size() + nObjects);
+
+    for (size_t i = 0; i < nObjects; ++i)
+        ptrVector.push_back(this->GetPtr(i));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline const art::Handle< std::vector<T> > &CollectionView<T>::GetHandle() const
+{
+    return m_handle;
+}
+
+} // namespace lar_pandora
+
+#endif // #ifndef LAR_PANDORA_COLLECTION_VIEW_H
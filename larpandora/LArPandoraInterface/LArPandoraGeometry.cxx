@@ -16,8 +16,119 @@
 #include "Pandora/PandoraInternal.h" // For pandora::TypeToString
 #include "Xml/tinyxml.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iomanip>
+#include <map>
 #include <sstream>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+/**
+ *  @brief  TpcGeometry class, caching the geometry service quantities used to group a tpc into a drift volume
+ */
+class TpcGeometry
+{
+public:
+    unsigned int    m_tpc;              ///< The tpc number
+    bool            m_isPositiveDrift;  ///< Whether the tpc drifts towards positive x
+    int             m_driftDirection;   ///< The drift direction, as reported by the geometry service
+    double          m_thetaU;           ///< The U wire angle to the vertical
+    double          m_thetaV;           ///< The V wire angle to the vertical
+    double          m_thetaW;           ///< The W wire angle to the vertical (zero for two-view detectors)
+    double          m_minX;             ///< The lower edge of the x interval used for overlap tests
+    double          m_maxX;             ///< The upper edge of the x interval used for overlap tests
+    double          m_driftMinX;        ///< The lower edge of the active volume in x
+    double          m_driftMaxX;        ///< The upper edge of the active volume in x
+    double          m_driftMinY;        ///< The lower edge of the active volume in y
+    double          m_driftMaxY;        ///< The upper edge of the active volume in y
+    double          m_driftMinZ;        ///< The lower edge of the active volume in z
+    double          m_driftMaxZ;        ///< The upper edge of the active volume in z
+};
+
+typedef std::vector<TpcGeometry> TpcGeometryVector;
+typedef std::vector<const TpcGeometry*> TpcGeometrySweepList;
+
+const char GEOMETRY_CACHE_MAGIC[8] = {'L', 'A', 'R', 'P', 'G', 'E', 'O', 'M'};   ///< Identifies a binary geometry cache file
+const uint32_t GEOMETRY_CACHE_VERSION(1);                                       ///< The geometry cache format version
+const uint64_t FNV_OFFSET_BASIS(14695981039346656037ULL);                       ///< The FNV-1a hash initial value
+const uint64_t FNV_PRIME(1099511628211ULL);                                     ///< The FNV-1a hash multiplier
+
+/**
+ *  @brief  Add a sequence of bytes to an FNV-1a hash
+ *
+ *  @param  pBytes the address of the first byte
+ *  @param  nBytes the number of bytes
+ *  @param  hash the hash, to be updated
+ */
+void HashBytes(const char *const pBytes, const size_t nBytes, uint64_t &hash)
+{
+    for (size_t iByte = 0; iByte < nBytes; ++iByte)
+    {
+        hash ^= static_cast<unsigned char>(pBytes[iByte]);
+        hash *= FNV_PRIME;
+    }
+}
+
+/**
+ *  @brief  Add the size and modification time of a file to an FNV-1a hash
+ *
+ *  @param  fileName the file name
+ *  @param  hash the hash, to be updated
+ *
+ *  @return whether the file status could be read
+ */
+bool HashFileStatus(const std::string &fileName, uint64_t &hash)
+{
+    struct stat fileStatus;
+
+    if (0 != stat(fileName.c_str(), &fileStatus))
+        return false;
+
+    const int64_t fileSize(static_cast<int64_t>(fileStatus.st_size));
+    const int64_t modificationTime(static_cast<int64_t>(fileStatus.st_mtime));
+    HashBytes(reinterpret_cast<const char*>(&fileSize), sizeof(fileSize), hash);
+    HashBytes(reinterpret_cast<const char*>(&modificationTime), sizeof(modificationTime), hash);
+
+    return true;
+}
+
+/**
+ *  @brief  Read a plain value from a binary stream
+ *
+ *  @param  inputStream the input stream
+ *  @param  value to receive the value
+ *
+ *  @return whether the value was read successfully
+ */
+template <typename T>
+bool ReadBinaryValue(std::istream &inputStream, T &value)
+{
+    return static_cast<bool>(inputStream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+/**
+ *  @brief  Write a plain value to a binary stream
+ *
+ *  @param  outputStream the output stream
+ *  @param  value the value
+ */
+template <typename T>
+void WriteBinaryValue(std::ostream &outputStream, const T &value)
+{
+    outputStream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+} // namespace
 
 namespace lar_pandora
 {
@@ -31,8 +142,6 @@ void LArPandoraGeometry::LoadGeometry(LArDriftVolumeList &driftVolumeList)
     if (!driftVolumeList.empty())
         throw cet::exception("LArPandora") << " Throwing exception - detector geometry has already been loaded ";
 
-    typedef std::set<unsigned int> UIntSet;
-
     // Load Geometry Service
     art::ServiceHandle<geo::Geometry> theGeometry;
     const unsigned int wirePlanes(theGeometry->MaxPlanes());
@@ -46,83 +155,122 @@ void LArPandoraGeometry::LoadGeometry(LArDriftVolumeList &driftVolumeList)
     // Loop over cryostats
     for (unsigned int icstat = 0; icstat < theGeometry->Ncryostats(); ++icstat)
     {
-        UIntSet cstatList;
+        const unsigned int nTpcs(theGeometry->NTPC(icstat));
+
+        // Query the geometry service once per TPC
+        TpcGeometryVector tpcGeometryVector;
+        tpcGeometryVector.reserve(nTpcs);
+
+        for (unsigned int itpc = 0; itpc < nTpcs; ++itpc)
+        {
+            const geo::TPCGeo &theTpc(theGeometry->TPC(itpc, icstat));
+
+            double localCoord[3] = {0.,0.,0.};
+            double worldCoord[3] = {0.,0.,0.};
+            theTpc.LocalToWorld(localCoord, worldCoord);
+
+            TpcGeometry tpcGeometry;
+            tpcGeometry.m_tpc = itpc;
+            tpcGeometry.m_isPositiveDrift = (theTpc.DriftDirection() == geo::kPosX);
+            tpcGeometry.m_driftDirection = static_cast<int>(theTpc.DriftDirection());
+            tpcGeometry.m_thetaU = theGeometry->WireAngleToVertical(geo::kU, itpc, icstat);
+            tpcGeometry.m_thetaV = theGeometry->WireAngleToVertical(geo::kV, itpc, icstat);
+            tpcGeometry.m_thetaW = ((wirePlanes > 2) ? theGeometry->WireAngleToVertical(geo::kW, itpc, icstat) : 0.0);
+            tpcGeometry.m_minX = worldCoord[0] - 0.5 * theTpc.ActiveHalfWidth();
+            tpcGeometry.m_maxX = worldCoord[0] + 0.5 * theTpc.ActiveHalfWidth();
+            tpcGeometry.m_driftMinX = worldCoord[0] - theTpc.ActiveHalfWidth();
+            tpcGeometry.m_driftMaxX = worldCoord[0] + theTpc.ActiveHalfWidth();
+            tpcGeometry.m_driftMinY = worldCoord[1] - theTpc.ActiveHalfHeight();
+            tpcGeometry.m_driftMaxY = worldCoord[1] + theTpc.ActiveHalfHeight();
+            tpcGeometry.m_driftMinZ = worldCoord[2] - 0.5 * theTpc.ActiveLength();
+            tpcGeometry.m_driftMaxZ = worldCoord[2] + 0.5 * theTpc.ActiveLength();
+            tpcGeometryVector.push_back(tpcGeometry);
+        }
+
+        // Sort the TPCs sharing each drift direction by the lower edge of their X interval
+        std::map<int, TpcGeometrySweepList> sweepListMap;
+        std::map<int, double> maxWidthMap;
+
+        for (const TpcGeometry &tpcGeometry : tpcGeometryVector)
+        {
+            sweepListMap[tpcGeometry.m_driftDirection].push_back(&tpcGeometry);
+            double &maxWidth(maxWidthMap[tpcGeometry.m_driftDirection]);
+            maxWidth = std::max(maxWidth, tpcGeometry.m_maxX - tpcGeometry.m_minX);
+        }
+
+        for (auto &sweepListEntry : sweepListMap)
+        {
+            std::stable_sort(sweepListEntry.second.begin(), sweepListEntry.second.end(),
+                [](const TpcGeometry *const pLhs, const TpcGeometry *const pRhs) { return (pLhs->m_minX < pRhs->m_minX); });
+        }
+
+        std::vector<bool> isAssigned(nTpcs, false);
 
         // Loop over TPCs in in this cryostat
-        for (unsigned int itpc1 = 0; itpc1 < theGeometry->NTPC(icstat); ++itpc1)
+        for (const TpcGeometry &tpcGeometry1 : tpcGeometryVector)
         {
-            if (cstatList.end() != cstatList.find(itpc1))
+            const unsigned int itpc1(tpcGeometry1.m_tpc);
+
+            if (isAssigned[itpc1])
                 continue;
 
             // Use this TPC to seed a drift volume
-            const geo::TPCGeo &theTpc1(theGeometry->TPC(itpc1, icstat));
-            cstatList.insert(itpc1);
+            isAssigned[itpc1] = true;
 
-            const double wireAngleU(0.5f * M_PI - theGeometry->WireAngleToVertical(geo::kU, itpc1, icstat));
-            const double wireAngleV((0.5f * M_PI - theGeometry->WireAngleToVertical(geo::kV, itpc1, icstat)) * -1.f);
-            const double wireAngleW((wirePlanes > 2) ? (0.5f * M_PI - theGeometry->WireAngleToVertical(geo::kW, itpc1, icstat)) : 0.0);
+            const double wireAngleU(0.5f * M_PI - tpcGeometry1.m_thetaU);
+            const double wireAngleV((0.5f * M_PI - tpcGeometry1.m_thetaV) * -1.f);
+            const double wireAngleW((wirePlanes > 2) ? (0.5f * M_PI - tpcGeometry1.m_thetaW) : 0.0);
 
             if (std::fabs(wireAngleW) > maxDeltaTheta)
                 throw cet::exception("LArPandora") << " Throwing exception - the W-wires are not vertical in this detector ";
 
-            double localCoord1[3] = {0.,0.,0.};
-            double worldCoord1[3] = {0.,0.,0.};
-            theTpc1.LocalToWorld(localCoord1, worldCoord1);
+            double driftMinX(tpcGeometry1.m_driftMinX);
+            double driftMaxX(tpcGeometry1.m_driftMaxX);
+            double driftMinY(tpcGeometry1.m_driftMinY);
+            double driftMaxY(tpcGeometry1.m_driftMaxY);
+            double driftMinZ(tpcGeometry1.m_driftMinZ);
+            double driftMaxZ(tpcGeometry1.m_driftMaxZ);
 
-            const double min1(worldCoord1[0] - 0.5 * theTpc1.ActiveHalfWidth());
-            const double max1(worldCoord1[0] + 0.5 * theTpc1.ActiveHalfWidth());
+            std::vector<unsigned int> tpcList(1, itpc1);
 
-            double driftMinX(worldCoord1[0] - theTpc1.ActiveHalfWidth());
-            double driftMaxX(worldCoord1[0] + theTpc1.ActiveHalfWidth());
-            double driftMinY(worldCoord1[1] - theTpc1.ActiveHalfHeight());
-            double driftMaxY(worldCoord1[1] + theTpc1.ActiveHalfHeight());
-            double driftMinZ(worldCoord1[2] - 0.5 * theTpc1.ActiveLength());
-            double driftMaxZ(worldCoord1[2] + 0.5 * theTpc1.ActiveLength());
+            // Now identify the other TPCs associated with this drift volume, sweeping over the TPCs whose X interval can overlap
+            const TpcGeometrySweepList &sweepList(sweepListMap.at(tpcGeometry1.m_driftDirection));
+            const double sweepMinX(tpcGeometry1.m_minX - maxWidthMap.at(tpcGeometry1.m_driftDirection));
 
-            const bool isPositiveDrift(theTpc1.DriftDirection() == geo::kPosX);
+            TpcGeometrySweepList::const_iterator sweepIter(std::lower_bound(sweepList.begin(), sweepList.end(), sweepMinX,
+                [](const TpcGeometry *const pTpcGeometry, const double x) { return (pTpcGeometry->m_minX < x); }));
 
-            UIntSet tpcList;
-            tpcList.insert(itpc1);
-
-            // Now identify the other TPCs associated with this drift volume
-            for (unsigned int itpc2 = itpc1+1; itpc2 < theGeometry->NTPC(icstat); ++itpc2)
+            for (; (sweepList.end() != sweepIter) && ((*sweepIter)->m_minX <= tpcGeometry1.m_maxX); ++sweepIter)
             {
-                if (cstatList.end() != cstatList.find(itpc2))
-                    continue;
-         
-                const geo::TPCGeo &theTpc2(theGeometry->TPC(itpc2, icstat));
+                const TpcGeometry &tpcGeometry2(**sweepIter);
+                const unsigned int itpc2(tpcGeometry2.m_tpc);
 
-                if (theTpc1.DriftDirection() != theTpc2.DriftDirection())
+                if ((itpc2 <= itpc1) || isAssigned[itpc2])
                     continue;
 
-                const double dThetaU(theGeometry->WireAngleToVertical(geo::kU, itpc1, icstat) - theGeometry->WireAngleToVertical(geo::kU, itpc2, icstat));
-                const double dThetaV(theGeometry->WireAngleToVertical(geo::kV, itpc1, icstat) - theGeometry->WireAngleToVertical(geo::kV, itpc2, icstat));
-                const double dThetaW((wirePlanes > 2) ? (theGeometry->WireAngleToVertical(geo::kW, itpc1, icstat) - theGeometry->WireAngleToVertical(geo::kW, itpc2, icstat)) : 0.0);
+                const double dThetaU(tpcGeometry1.m_thetaU - tpcGeometry2.m_thetaU);
+                const double dThetaV(tpcGeometry1.m_thetaV - tpcGeometry2.m_thetaV);
+                const double dThetaW(tpcGeometry1.m_thetaW - tpcGeometry2.m_thetaW);
 
                 if (dThetaU > maxDeltaTheta || dThetaV > maxDeltaTheta || dThetaW > maxDeltaTheta)
                     continue;
 
-                double localCoord2[3] = {0.,0.,0.};
-                double worldCoord2[3] = {0.,0.,0.};
-                theTpc2.LocalToWorld(localCoord2, worldCoord2);
-                const double min2(worldCoord2[0] - 0.5 * theTpc2.ActiveHalfWidth());
-                const double max2(worldCoord2[0] + 0.5 * theTpc2.ActiveHalfWidth());
-
-                if ((min2 > max1) || (min1 > max2))
+                if ((tpcGeometry2.m_minX > tpcGeometry1.m_maxX) || (tpcGeometry1.m_minX > tpcGeometry2.m_maxX))
                     continue;
 
-                cstatList.insert(itpc2);
-                tpcList.insert(itpc2);
+                isAssigned[itpc2] = true;
+                tpcList.push_back(itpc2);
 
-                driftMinX = std::min(driftMinX, worldCoord2[0] - theTpc2.ActiveHalfWidth());
-                driftMaxX = std::max(driftMaxX, worldCoord2[0] + theTpc2.ActiveHalfWidth());
-                driftMinY = std::min(driftMinY, worldCoord2[1] - theTpc2.ActiveHalfHeight());
-                driftMaxY = std::max(driftMaxY, worldCoord2[1] + theTpc2.ActiveHalfHeight());
-                driftMinZ = std::min(driftMinZ, worldCoord2[2] - 0.5 * theTpc2.ActiveLength());
-                driftMaxZ = std::max(driftMaxZ, worldCoord2[2] + 0.5 * theTpc2.ActiveLength());
+                driftMinX = std::min(driftMinX, tpcGeometry2.m_driftMinX);
+                driftMaxX = std::max(driftMaxX, tpcGeometry2.m_driftMaxX);
+                driftMinY = std::min(driftMinY, tpcGeometry2.m_driftMinY);
+                driftMaxY = std::max(driftMaxY, tpcGeometry2.m_driftMaxY);
+                driftMinZ = std::min(driftMinZ, tpcGeometry2.m_driftMinZ);
+                driftMaxZ = std::max(driftMaxZ, tpcGeometry2.m_driftMaxZ);
             }
 
             // Collate the tpc volumes in this drift volume
+            std::sort(tpcList.begin(), tpcList.end());
             LArTpcVolumeList tpcVolumeList;
 
             for(const unsigned int itpc : tpcList)
@@ -131,7 +279,7 @@ void LArPandoraGeometry::LoadGeometry(LArDriftVolumeList &driftVolumeList)
             }
 
             // Create the new drift volume
-            driftVolumeList.push_back(LArDriftVolume(driftVolumeList.size(), isPositiveDrift,
+            driftVolumeList.push_back(LArDriftVolume(driftVolumeList.size(), tpcGeometry1.m_isPositiveDrift,
                 wirePitchU, wirePitchV, wirePitchW, wireAngleU, wireAngleV,
                 0.5 * (driftMaxX + driftMinX), 0.5 * (driftMaxY + driftMinY), 0.5 * (driftMaxZ + driftMinZ),
                 (driftMaxX - driftMinX), (driftMaxY - driftMinY), (driftMaxZ - driftMinZ),
@@ -142,6 +290,42 @@ void LArPandoraGeometry::LoadGeometry(LArDriftVolumeList &driftVolumeList)
     if (driftVolumeList.empty())
         throw cet::exception("LArPandora") << " Throwing exception - failed to find any drift volumes in this detector geometry ";
 }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraGeometry::SplitDriftVolumes(const double segmentLengthZ, const double overlapZ, LArDriftVolumeList &driftVolumeList)
+{
+    if ((overlapZ < 0.) || (segmentLengthZ <= overlapZ))
+        throw cet::exception("LArPandora") << " Throwing exception - z segment length must exceed the (non-negative) z segment overlap ";
+
+    LArDriftVolumeList segmentList;
+
+    for (const LArDriftVolume &driftVolume : driftVolumeList)
+    {
+        // The segment cores tile the drift volume; each segment then extends by half the overlap into its neighbours
+        const double widthZ(driftVolume.GetWidthZ());
+        const double minZ(driftVolume.GetCenterZ() - 0.5 * widthZ);
+        const double maxZ(driftVolume.GetCenterZ() + 0.5 * widthZ);
+        const unsigned int nSegments((widthZ > segmentLengthZ) ?
+            static_cast<unsigned int>(std::ceil((widthZ - overlapZ) / (segmentLengthZ - overlapZ))) : 1);
+        const double coreWidthZ(widthZ / static_cast<double>(nSegments));
+
+        for (unsigned int iSegment = 0; iSegment < nSegments; ++iSegment)
+        {
+            const double segmentMinZ((0 == iSegment) ? minZ : minZ + iSegment * coreWidthZ - 0.5 * overlapZ);
+            const double segmentMaxZ((nSegments == iSegment + 1) ? maxZ : minZ + (iSegment + 1) * coreWidthZ + 0.5 * overlapZ);
+
+            segmentList.push_back(LArDriftVolume(segmentList.size(), driftVolume.IsPositiveDrift(),
+                driftVolume.GetWirePitchU(), driftVolume.GetWirePitchV(), driftVolume.GetWirePitchW(),
+                driftVolume.GetWireAngleU(), driftVolume.GetWireAngleV(),
+                driftVolume.GetCenterX(), driftVolume.GetCenterY(), 0.5 * (segmentMaxZ + segmentMinZ),
+                driftVolume.GetWidthX(), driftVolume.GetWidthY(), (segmentMaxZ - segmentMinZ),
+                driftVolume.GetSigmaUVZ(), driftVolume.GetTpcVolumeList()));
+        }
+    }
+
+    driftVolumeList.swap(segmentList);
+}
  
 //------------------------------------------------------------------------------------------------------------------------------------------
 
@@ -180,7 +364,278 @@ void LArPandoraGeometry::PrintGeometry(const LArDriftVolumeList &driftVolumeList
 void LArPandoraGeometry::WriteGeometry(const std::string &xmlFileName, const LArDriftVolumeList &driftVolumeList)
 {
     pandora::TiXmlDocument xmlDocument;
+    LArPandoraGeometry::FillXmlDocument(driftVolumeList, xmlDocument);
+    xmlDocument.SaveFile(xmlFileName);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool LArPandoraGeometry::GetGeometryHash(uint64_t &geometryHash)
+{
+    // FNV-1a hash of the geometry description, detector layout and geometry file status; bump the cache version if the drift volume
+    // grouping changes
+    art::ServiceHandle<geo::Geometry> theGeometry;
+
+    std::ostringstream oss;
+    oss << "LArDriftVolumeList_v" << GEOMETRY_CACHE_VERSION << ":" << theGeometry->DetectorName() << ":" << theGeometry->GDMLFile() << ":"
+        << theGeometry->ROOTFile() << ":" << theGeometry->MaxPlanes() << ":" << theGeometry->Ncryostats();
+
+    for (unsigned int icstat = 0; icstat < theGeometry->Ncryostats(); ++icstat)
+        oss << ":" << theGeometry->NTPC(icstat);
+
+    const std::string description(oss.str());
+    uint64_t hash(FNV_OFFSET_BASIS);
+    HashBytes(description.data(), description.size(), hash);
+
+    // Hash the file sizes and modification times, rather than just the names, so that a geometry file edited in place invalidates the cache
+    for (const std::string &geometryFileName : {theGeometry->GDMLFile(), theGeometry->ROOTFile()})
+    {
+        if (!HashFileStatus(geometryFileName, hash))
+            return false;
+    }
+
+    geometryHash = hash;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool LArPandoraGeometry::ReadGeometry(const std::string &fileName, const uint64_t geometryHash, LArDriftVolumeList &driftVolumeList)
+{
+    if (!driftVolumeList.empty())
+        throw cet::exception("LArPandora") << " Throwing exception - detector geometry has already been loaded ";
+
+    std::ifstream inputFile(fileName, std::ios::binary);
+
+    if (!inputFile.is_open())
+        return false;
+
+    char magic[sizeof(GEOMETRY_CACHE_MAGIC)] = {0};
+    const bool isBinary(inputFile.read(magic, sizeof(magic)) && (0 == std::memcmp(magic, GEOMETRY_CACHE_MAGIC, sizeof(magic))));
+    inputFile.close();
+
+    const bool success(isBinary ? LArPandoraGeometry::ReadBinaryGeometry(fileName, geometryHash, driftVolumeList) :
+        LArPandoraGeometry::ReadXmlGeometry(fileName, geometryHash, driftVolumeList));
+
+    if (!success || driftVolumeList.empty())
+    {
+        driftVolumeList.clear();
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraGeometry::WriteGeometryCache(const std::string &fileName, const uint64_t geometryHash, const LArDriftVolumeList &driftVolumeList)
+{
+    const std::string xmlExtension(".xml");
+
+    const bool isXml((fileName.size() >= xmlExtension.size()) &&
+        (0 == fileName.compare(fileName.size() - xmlExtension.size(), xmlExtension.size(), xmlExtension)));
 
+    // Write to a unique temporary file in the same directory, then rename it into place, so that a job that crashes, or jobs that write
+    // the cache concurrently, can never leave a partially written cache file behind
+    std::vector<char> tempFileNameBuffer(fileName.begin(), fileName.end());
+    const std::string tempSuffix(".XXXXXX");
+    tempFileNameBuffer.insert(tempFileNameBuffer.end(), tempSuffix.begin(), tempSuffix.end());
+    tempFileNameBuffer.push_back('\0');
+
+    const int fileDescriptor(mkstemp(tempFileNameBuffer.data()));
+
+    if (fileDescriptor < 0)
+        throw cet::exception("LArPandora") << " Throwing exception - could not create a temporary geometry cache file for " << fileName;
+
+    fchmod(fileDescriptor, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    close(fileDescriptor);
+
+    const std::string tempFileName(tempFileNameBuffer.data());
+
+    try
+    {
+        LArPandoraGeometry::WriteGeometryFile(tempFileName, isXml, geometryHash, driftVolumeList);
+    }
+    catch (...)
+    {
+        std::remove(tempFileName.c_str());
+        throw;
+    }
+
+    if (0 != std::rename(tempFileName.c_str(), fileName.c_str()))
+    {
+        std::remove(tempFileName.c_str());
+        throw cet::exception("LArPandora") << " Throwing exception - could not write geometry cache file " << fileName;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraGeometry::WriteGeometryFile(const std::string &fileName, const bool isXml, const uint64_t geometryHash,
+    const LArDriftVolumeList &driftVolumeList)
+{
+    if (isXml)
+    {
+        pandora::TiXmlDocument xmlDocument;
+
+        pandora::TiXmlElement *const pHashElement = new pandora::TiXmlElement("GeometryHash");
+        pHashElement->LinkEndChild(new pandora::TiXmlText(pandora::TypeToString(geometryHash)));
+        xmlDocument.LinkEndChild(pHashElement);
+
+        LArPandoraGeometry::FillXmlDocument(driftVolumeList, xmlDocument);
+
+        if (!xmlDocument.SaveFile(fileName))
+            throw cet::exception("LArPandora") << " Throwing exception - could not write geometry cache file " << fileName;
+    }
+    else
+    {
+        LArPandoraGeometry::WriteBinaryGeometry(fileName, geometryHash, driftVolumeList);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool LArPandoraGeometry::ReadBinaryGeometry(const std::string &fileName, const uint64_t geometryHash, LArDriftVolumeList &driftVolumeList)
+{
+    std::ifstream inputFile(fileName, std::ios::binary);
+
+    char magic[sizeof(GEOMETRY_CACHE_MAGIC)] = {0};
+    uint32_t version(0), nDriftVolumes(0);
+    uint64_t fileHash(0);
+
+    if (!inputFile.read(magic, sizeof(magic)) || !ReadBinaryValue(inputFile, version) || !ReadBinaryValue(inputFile, fileHash) ||
+        !ReadBinaryValue(inputFile, nDriftVolumes))
+    {
+        return false;
+    }
+
+    if ((GEOMETRY_CACHE_VERSION != version) || (geometryHash != fileHash))
+        return false;
+
+    for (uint32_t iVolume = 0; iVolume < nDriftVolumes; ++iVolume)
+    {
+        uint32_t volumeID(0), nTpcVolumes(0);
+        uint8_t isPositiveDrift(0);
+        double values[12] = {0.};
+
+        if (!ReadBinaryValue(inputFile, volumeID) || !ReadBinaryValue(inputFile, isPositiveDrift) || !ReadBinaryValue(inputFile, values) ||
+            !ReadBinaryValue(inputFile, nTpcVolumes))
+        {
+            return false;
+        }
+
+        LArTpcVolumeList tpcVolumeList;
+
+        for (uint32_t iTpc = 0; iTpc < nTpcVolumes; ++iTpc)
+        {
+            uint32_t cryostat(0), tpc(0);
+
+            if (!ReadBinaryValue(inputFile, cryostat) || !ReadBinaryValue(inputFile, tpc))
+                return false;
+
+            tpcVolumeList.push_back(LArTpcVolume(cryostat, tpc));
+        }
+
+        driftVolumeList.push_back(LArDriftVolume(volumeID, (0 != isPositiveDrift), values[0], values[1], values[2], values[3], values[4],
+            values[5], values[6], values[7], values[8], values[9], values[10], values[11], tpcVolumeList));
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool LArPandoraGeometry::ReadXmlGeometry(const std::string &fileName, const uint64_t geometryHash, LArDriftVolumeList &driftVolumeList)
+{
+    pandora::TiXmlDocument xmlDocument(fileName);
+
+    if (!xmlDocument.LoadFile())
+        return false;
+
+    uint64_t fileHash(0);
+
+    if (!ReadXmlValue(&xmlDocument, "GeometryHash", fileHash) || (geometryHash != fileHash))
+        return false;
+
+    for (const pandora::TiXmlElement *pVolumeElement = xmlDocument.FirstChildElement("LArDriftVolume"); nullptr != pVolumeElement;
+        pVolumeElement = pVolumeElement->NextSiblingElement("LArDriftVolume"))
+    {
+        unsigned int volumeID(0);
+        bool isPositiveDrift(false);
+        double wirePitchU(0.), wirePitchV(0.), wirePitchW(0.), wireAngleU(0.), wireAngleV(0.), centerX(0.), centerY(0.), centerZ(0.),
+            widthX(0.), widthY(0.), widthZ(0.), sigmaUVZ(0.);
+
+        if (!ReadXmlValue(pVolumeElement, "VolumeID", volumeID) || !ReadXmlValue(pVolumeElement, "IsPositiveDrift", isPositiveDrift) ||
+            !ReadXmlValue(pVolumeElement, "WirePitchU", wirePitchU) || !ReadXmlValue(pVolumeElement, "WirePitchV", wirePitchV) ||
+            !ReadXmlValue(pVolumeElement, "WirePitchW", wirePitchW) || !ReadXmlValue(pVolumeElement, "WireAngleU", wireAngleU) ||
+            !ReadXmlValue(pVolumeElement, "WireAngleV", wireAngleV) || !ReadXmlValue(pVolumeElement, "CenterX", centerX) ||
+            !ReadXmlValue(pVolumeElement, "CenterY", centerY) || !ReadXmlValue(pVolumeElement, "CenterZ", centerZ) ||
+            !ReadXmlValue(pVolumeElement, "WidthX", widthX) || !ReadXmlValue(pVolumeElement, "WidthY", widthY) ||
+            !ReadXmlValue(pVolumeElement, "WidthZ", widthZ) || !ReadXmlValue(pVolumeElement, "SigmaUVZ", sigmaUVZ))
+        {
+            return false;
+        }
+
+        LArTpcVolumeList tpcVolumeList;
+
+        for (const pandora::TiXmlElement *pTpcElement = pVolumeElement->FirstChildElement("LArTpcVolume"); nullptr != pTpcElement;
+            pTpcElement = pTpcElement->NextSiblingElement("LArTpcVolume"))
+        {
+            unsigned int cryostat(0), tpc(0);
+
+            if (!ReadXmlValue(pTpcElement, "Cryostat", cryostat) || !ReadXmlValue(pTpcElement, "Tpc", tpc))
+                return false;
+
+            tpcVolumeList.push_back(LArTpcVolume(cryostat, tpc));
+        }
+
+        if (tpcVolumeList.empty())
+            return false;
+
+        driftVolumeList.push_back(LArDriftVolume(volumeID, isPositiveDrift, wirePitchU, wirePitchV, wirePitchW, wireAngleU, wireAngleV,
+            centerX, centerY, centerZ, widthX, widthY, widthZ, sigmaUVZ, tpcVolumeList));
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraGeometry::WriteBinaryGeometry(const std::string &fileName, const uint64_t geometryHash, const LArDriftVolumeList &driftVolumeList)
+{
+    std::ofstream outputFile(fileName, std::ios::binary | std::ios::trunc);
+
+    outputFile.write(GEOMETRY_CACHE_MAGIC, sizeof(GEOMETRY_CACHE_MAGIC));
+    WriteBinaryValue(outputFile, static_cast<uint32_t>(GEOMETRY_CACHE_VERSION));
+    WriteBinaryValue(outputFile, geometryHash);
+    WriteBinaryValue(outputFile, static_cast<uint32_t>(driftVolumeList.size()));
+
+    for (const LArDriftVolume &driftVolume : driftVolumeList)
+    {
+        const double values[12] = {driftVolume.GetWirePitchU(), driftVolume.GetWirePitchV(), driftVolume.GetWirePitchW(),
+            driftVolume.GetWireAngleU(), driftVolume.GetWireAngleV(), driftVolume.GetCenterX(), driftVolume.GetCenterY(),
+            driftVolume.GetCenterZ(), driftVolume.GetWidthX(), driftVolume.GetWidthY(), driftVolume.GetWidthZ(), driftVolume.GetSigmaUVZ()};
+
+        WriteBinaryValue(outputFile, static_cast<uint32_t>(driftVolume.GetVolumeID()));
+        WriteBinaryValue(outputFile, static_cast<uint8_t>(driftVolume.IsPositiveDrift() ? 1 : 0));
+        WriteBinaryValue(outputFile, values);
+        WriteBinaryValue(outputFile, static_cast<uint32_t>(driftVolume.GetTpcVolumeList().size()));
+
+        for (const LArTpcVolume &tpcVolume : driftVolume.GetTpcVolumeList())
+        {
+            WriteBinaryValue(outputFile, static_cast<uint32_t>(tpcVolume.GetCryostat()));
+            WriteBinaryValue(outputFile, static_cast<uint32_t>(tpcVolume.GetTpc()));
+        }
+    }
+
+    if (!outputFile.good())
+        throw cet::exception("LArPandora") << " Throwing exception - could not write geometry cache file " << fileName;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraGeometry::FillXmlDocument(const LArDriftVolumeList &driftVolumeList, pandora::TiXmlDocument &xmlDocument)
+{
     for (const LArDriftVolume &driftVolume : driftVolumeList)
     {
         pandora::TiXmlElement *const pVolumeElement = new pandora::TiXmlElement("LArDriftVolume");
@@ -206,10 +661,36 @@ void LArPandoraGeometry::WriteGeometry(const std::string &xmlFileName, const LAr
         LArPandoraGeometry::WritePrecisionElement(pVolumeElement, "WidthZ", driftVolume.GetWidthZ());
         LArPandoraGeometry::WritePrecisionElement(pVolumeElement, "SigmaUVZ", driftVolume.GetSigmaUVZ());
 
+        for (const LArTpcVolume &tpcVolume : driftVolume.GetTpcVolumeList())
+        {
+            pandora::TiXmlElement *const pTpcElement = new pandora::TiXmlElement("LArTpcVolume");
+
+            pandora::TiXmlElement *const pCryostatElement = new pandora::TiXmlElement("Cryostat");
+            pCryostatElement->LinkEndChild(new pandora::TiXmlText(pandora::TypeToString(tpcVolume.GetCryostat())));
+            pTpcElement->LinkEndChild(pCryostatElement);
+
+            pandora::TiXmlElement *const pTpcIdElement = new pandora::TiXmlElement("Tpc");
+            pTpcIdElement->LinkEndChild(new pandora::TiXmlText(pandora::TypeToString(tpcVolume.GetTpc())));
+            pTpcElement->LinkEndChild(pTpcIdElement);
+
+            pVolumeElement->LinkEndChild(pTpcElement);
+        }
+
         xmlDocument.LinkEndChild(pVolumeElement);
     }
+}
 
-    xmlDocument.SaveFile(xmlFileName);
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+bool LArPandoraGeometry::ReadXmlValue(const pandora::TiXmlNode *const pParentNode, const std::string &elementName, T &value)
+{
+    const pandora::TiXmlElement *const pElement(pParentNode->FirstChildElement(elementName.c_str()));
+
+    if (!pElement || !pElement->GetText())
+        return false;
+
+    return pandora::StringToType(pElement->GetText(), value);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -7,9 +7,12 @@
 #ifndef LAR_PANDORA_GEOMETRY_H
 #define LAR_PANDORA_GEOMETRY_H 1
 
+#include <cstdint>
+#include <map>
 #include <string>
+#include <vector>
 
-namespace pandora { class TiXmlElement; }
+namespace pandora { class TiXmlDocument; class TiXmlElement; class TiXmlNode; }
 
 namespace lar_pandora
 {
@@ -192,6 +195,17 @@ public:
      *  @param  driftVolumeList to receive the populated drift volume list
      */
     static void LoadGeometry(LArDriftVolumeList &driftVolumeList);
+
+    /**
+     *  @brief  Split drift volumes that are long in Z into overlapping Z segments. Each segment is returned as a drift volume in
+     *          its own right, sharing the tpc volumes of its parent; segments of the same parent are contiguous in the output list
+     *          and volume ids are renumbered in list order.
+     * 
+     *  @param  segmentLengthZ the maximum length of a segment in Z
+     *  @param  overlapZ the length in Z of the region shared by neighbouring segments
+     *  @param  driftVolumeList the drift volume list, to be replaced by the list of segments
+     */
+    static void SplitDriftVolumes(const double segmentLengthZ, const double overlapZ, LArDriftVolumeList &driftVolumeList);
  
     /**
      *  @brief  Print out the list of drift volumes
@@ -208,7 +222,99 @@ public:
      */
     static void WriteGeometry(const std::string &xmlFileName, const LArDriftVolumeList &driftVolumeList);
 
+    /**
+     *  @brief  Get a hash identifying the loaded detector geometry and the size and modification time of its geometry files, used to
+     *          validate geometry cache files
+     *
+     *  @param  geometryHash to receive the hash
+     *
+     *  @return whether the geometry files could be found
+     */
+    static bool GetGeometryHash(uint64_t &geometryHash);
+
+    /**
+     *  @brief  Read a list of drift volumes from a geometry cache file, in either binary or xml format
+     * 
+     *  @param  fileName the cache file name
+     *  @param  geometryHash the hash of the loaded detector geometry
+     *  @param  driftVolumeList to receive the populated drift volume list
+     *
+     *  @return whether the file exists, is readable and was written for the loaded detector geometry
+     */
+    static bool ReadGeometry(const std::string &fileName, const uint64_t geometryHash, LArDriftVolumeList &driftVolumeList);
+
+    /**
+     *  @brief  Write a list of drift volumes to a geometry cache file (xml format if the file name ends in .xml, otherwise binary)
+     * 
+     *  @param  fileName the cache file name
+     *  @param  geometryHash the hash of the loaded detector geometry
+     *  @param  driftVolumeList the drift volume list
+     */
+    static void WriteGeometryCache(const std::string &fileName, const uint64_t geometryHash, const LArDriftVolumeList &driftVolumeList);
+
 private:
+    /**
+     *  @brief  Read a list of drift volumes from a binary geometry cache file
+     * 
+     *  @param  fileName the cache file name
+     *  @param  geometryHash the hash of the loaded detector geometry
+     *  @param  driftVolumeList to receive the populated drift volume list
+     *
+     *  @return whether the drift volumes were read successfully
+     */
+    static bool ReadBinaryGeometry(const std::string &fileName, const uint64_t geometryHash, LArDriftVolumeList &driftVolumeList);
+
+    /**
+     *  @brief  Read a list of drift volumes from an xml geometry cache file
+     * 
+     *  @param  fileName the cache file name
+     *  @param  geometryHash the hash of the loaded detector geometry
+     *  @param  driftVolumeList to receive the populated drift volume list
+     *
+     *  @return whether the drift volumes were read successfully
+     */
+    static bool ReadXmlGeometry(const std::string &fileName, const uint64_t geometryHash, LArDriftVolumeList &driftVolumeList);
+
+    /**
+     *  @brief  Write a list of drift volumes to a geometry cache file, in place
+     * 
+     *  @param  fileName the file name
+     *  @param  isXml whether to write in xml, rather than binary, format
+     *  @param  geometryHash the hash of the loaded detector geometry
+     *  @param  driftVolumeList the drift volume list
+     */
+    static void WriteGeometryFile(const std::string &fileName, const bool isXml, const uint64_t geometryHash,
+        const LArDriftVolumeList &driftVolumeList);
+
+    /**
+     *  @brief  Write a list of drift volumes to a binary geometry cache file
+     * 
+     *  @param  fileName the cache file name
+     *  @param  geometryHash the hash of the loaded detector geometry
+     *  @param  driftVolumeList the drift volume list
+     */
+    static void WriteBinaryGeometry(const std::string &fileName, const uint64_t geometryHash, const LArDriftVolumeList &driftVolumeList);
+
+    /**
+     *  @brief  Add the xml elements describing a list of drift volumes to an xml document
+     * 
+     *  @param  driftVolumeList the drift volume list
+     *  @param  xmlDocument the xml document
+     */
+    static void FillXmlDocument(const LArDriftVolumeList &driftVolumeList, pandora::TiXmlDocument &xmlDocument);
+
+    /**
+     *  @brief  Read the value of a named child element of an xml node
+     * 
+     *  @param  pParentNode the parent xml node
+     *  @param  elementName the child element xml name
+     *  @param  value to receive the element value
+     *
+     *  @return whether the child element exists and its value could be parsed
+     */
+    template <typename T>
+    static bool ReadXmlValue(const pandora::TiXmlNode *const pParentNode, const std::string &elementName, T &value);
+
     /**
      *  @brief  Write a double element, above standard precision (required for e.g. wire angle values), under a parent xml element
      * 
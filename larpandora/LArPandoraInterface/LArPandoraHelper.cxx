@@ -31,14 +31,28 @@
 #include "Pandora/PdgTable.h"
 
 #include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
+#include "larpandora/LArPandoraInterface/LArPandoraHitSoA.h"
 
+#include <algorithm>
+#include <atomic>
+#include <future>
 #include <limits>
 #include <iostream>
+#include <thread>
 
 namespace lar_pandora
 {
 
 void LArPandoraHelper::CollectWires(const art::Event &evt, const std::string label, WireVector &wireVector)
+{
+    WireCollection wireCollection;
+    LArPandoraHelper::CollectWires(evt, label, wireCollection);
+    wireCollection.GetPtrVector(wireVector);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraHelper::CollectWires(const art::Event &evt, const std::string label, WireCollection &wireCollection)
 {
     art::Handle< std::vector<recob::Wire> > theWires;
     evt.getByLabel(label, theWires);
@@ -53,16 +67,21 @@ void LArPandoraHelper::CollectWires(const art::Event &evt, const std::string lab
         mf::LogDebug("LArPandora") << "  Found: " << theWires->size() << " Wires " << std::endl;
     }
 
-    for (unsigned int i = 0; i < theWires->size(); ++i)
-    {
-        const art::Ptr<recob::Wire> wire(theWires, i);
-        wireVector.push_back(wire);
-    }
+    wireCollection = WireCollection(theWires);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
 void LArPandoraHelper::CollectHits(const art::Event &evt, const std::string label, HitVector &hitVector)
+{
+    HitCollection hitCollection;
+    LArPandoraHelper::CollectHits(evt, label, hitCollection);
+    hitCollection.GetPtrVector(hitVector);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraHelper::CollectHits(const art::Event &evt, const std::string label, HitCollection &hitCollection)
 {
     art::Handle< std::vector<recob::Hit> > theHits;
     evt.getByLabel(label, theHits);
@@ -77,16 +96,21 @@ void LArPandoraHelper::CollectHits(const art::Event &evt, const std::string labe
         mf::LogDebug("LArPandora") << "  Found: " << theHits->size() << " Hits " << std::endl;
     }
 
-    for (unsigned int i = 0; i < theHits->size(); ++i)
-    {
-        const art::Ptr<recob::Hit> hit(theHits, i);
-        hitVector.push_back(hit);
-    }
+    hitCollection = HitCollection(theHits);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
 void LArPandoraHelper::CollectPFParticles(const art::Event &evt, const std::string label, PFParticleVector &particleVector)
+{
+    PFParticleCollection particleCollection;
+    LArPandoraHelper::CollectPFParticles(evt, label, particleCollection);
+    particleCollection.GetPtrVector(particleVector);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraHelper::CollectPFParticles(const art::Event &evt, const std::string label, PFParticleCollection &particleCollection)
 {
     art::Handle< std::vector<recob::PFParticle> > theParticles;
     evt.getByLabel(label, theParticles);
@@ -101,11 +125,7 @@ void LArPandoraHelper::CollectPFParticles(const art::Event &evt, const std::stri
         mf::LogDebug("LArPandora") << "  Found: " << theParticles->size() << " PFParticles " << std::endl;
     }
 
-    for (unsigned int i = 0; i < theParticles->size(); ++i)
-    {
-        const art::Ptr<recob::PFParticle> particle(theParticles, i);
-        particleVector.push_back(particle);
-    }
+    particleCollection = PFParticleCollection(theParticles);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -438,97 +458,106 @@ void LArPandoraHelper::CollectVertices(const art::Event &evt, const std::string
 
 void LArPandoraHelper::BuildPFParticleHitMaps(const PFParticleVector &particleVector, const PFParticlesToSpacePoints &particlesToSpacePoints, 
     const SpacePointsToHits &spacePointsToHits, PFParticlesToHits &particlesToHits, HitsToPFParticles &hitsToParticles, 
-    const DaughterMode daughterMode)
+    const DaughterMode daughterMode, const unsigned int maxTasks)
 { 
-    // Build mapping from particle to particle ID for parent/daughter navigation
-    PFParticleMap particleMap;
-
-    for (PFParticleVector::const_iterator iter1 = particleVector.begin(), iterEnd1 = particleVector.end(); iter1 != iterEnd1; ++iter1)
-    {
-        const art::Ptr<recob::PFParticle> particle = *iter1;
-        particleMap[particle->Self()] = particle;
-    }
+    // Select the particle that receives the hits of each input particle (navigating the hierarchy here, in a single thread)
+    PFParticleVector inputParticles;
+    std::vector<const SpacePointVector*> inputSpacePoints;
 
-    // Loop over hits and build mapping between reconstructed final-state particles and reconstructed hits
     for (PFParticlesToSpacePoints::const_iterator iter1 = particlesToSpacePoints.begin(), iterEnd1 = particlesToSpacePoints.end();
         iter1 != iterEnd1; ++iter1)
     {
-        const art::Ptr<recob::PFParticle> thisParticle = iter1->first;
-        const art::Ptr<recob::PFParticle> particle((kAddDaughters == daughterMode) ? 
-            LArPandoraHelper::GetFinalStatePFParticle(particleMap, thisParticle) : thisParticle);
+        inputParticles.push_back(iter1->first);
+        inputSpacePoints.push_back(&(iter1->second));
+    }
 
-        if ((kIgnoreDaughters == daughterMode) && !LArPandoraHelper::IsFinalState(particleMap, particle))
-            continue;
+    PFParticleVector outputParticles;
+    LArPandoraHelper::SelectPFParticlesForHitMaps(particleVector, inputParticles, daughterMode, outputParticles);
 
-        const SpacePointVector &spacePointVector = iter1->second;
+    // Loop over hits and build mapping between reconstructed final-state particles and reconstructed hits (one buffer per particle)
+    std::vector<HitVector> hitArray(inputParticles.size());
 
-        for (SpacePointVector::const_iterator iter2 = spacePointVector.begin(), iterEnd2 = spacePointVector.end(); iter2 != iterEnd2; ++iter2)
+    LArPandoraHelper::ProcessInParallel(inputParticles.size(), 16, maxTasks, [&](const size_t begin, const size_t end)
+    {
+        for (size_t index = begin; index < end; ++index)
         {
-            const art::Ptr<recob::SpacePoint> spacepoint = *iter2;
+            if (outputParticles.at(index).isNull())
+                continue;
 
-            SpacePointsToHits::const_iterator iter3 = spacePointsToHits.find(spacepoint);
-            if (spacePointsToHits.end() == iter3)
-                throw cet::exception("LArPandora") << " PandoraCollector::BuildPFParticleHitMaps --- Found a space point without an associated hit ";
+            const SpacePointVector &spacePointVector = *(inputSpacePoints.at(index));
+            HitVector &hitVector = hitArray.at(index);
 
-            const art::Ptr<recob::Hit> hit = iter3->second;
-        
-            particlesToHits[particle].push_back(hit);
-            hitsToParticles[hit] = particle;
+            for (SpacePointVector::const_iterator iter2 = spacePointVector.begin(), iterEnd2 = spacePointVector.end(); iter2 != iterEnd2; ++iter2)
+            {
+                const art::Ptr<recob::SpacePoint> spacepoint = *iter2;
+
+                SpacePointsToHits::const_iterator iter3 = spacePointsToHits.find(spacepoint);
+                if (spacePointsToHits.end() == iter3)
+                    throw cet::exception("LArPandora") << " PandoraCollector::BuildPFParticleHitMaps --- Found a space point without an associated hit ";
+
+                hitVector.push_back(iter3->second);
+            }
         }
-    }
+    });
+
+    LArPandoraHelper::MergePFParticleHitMaps(outputParticles, hitArray, particlesToHits, hitsToParticles);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
 void LArPandoraHelper::BuildPFParticleHitMaps(const PFParticleVector &particleVector, const PFParticlesToClusters &particlesToClusters, 
     const ClustersToHits &clustersToHits, PFParticlesToHits &particlesToHits, HitsToPFParticles &hitsToParticles, 
-    const DaughterMode daughterMode)
+    const DaughterMode daughterMode, const unsigned int maxTasks)
 { 
-    // Build mapping from particle to particle ID for parent/daughter navigation
-    PFParticleMap particleMap;
+    // Select the particle that receives the hits of each input particle (navigating the hierarchy here, in a single thread)
+    PFParticleVector inputParticles;
+    std::vector<const ClusterVector*> inputClusters;
 
-    for (PFParticleVector::const_iterator iter1 = particleVector.begin(), iterEnd1 = particleVector.end(); iter1 != iterEnd1; ++iter1)
-    {
-        const art::Ptr<recob::PFParticle> particle = *iter1;
-        particleMap[particle->Self()] = particle;
-    }
-
-    // Loop over hits and build mapping between reconstructed final-state particles and reconstructed hits
     for (PFParticlesToClusters::const_iterator iter1 = particlesToClusters.begin(), iterEnd1 = particlesToClusters.end();
         iter1 != iterEnd1; ++iter1)
     {
-        const art::Ptr<recob::PFParticle> thisParticle = iter1->first;
-        const art::Ptr<recob::PFParticle> particle((kAddDaughters == daughterMode) ? 
-            LArPandoraHelper::GetFinalStatePFParticle(particleMap, thisParticle) : thisParticle);
+        inputParticles.push_back(iter1->first);
+        inputClusters.push_back(&(iter1->second));
+    }
 
-        if ((kIgnoreDaughters == daughterMode) && !LArPandoraHelper::IsFinalState(particleMap, particle))
-            continue;
+    PFParticleVector outputParticles;
+    LArPandoraHelper::SelectPFParticlesForHitMaps(particleVector, inputParticles, daughterMode, outputParticles);
+
+    // Loop over hits and build mapping between reconstructed final-state particles and reconstructed hits (one buffer per particle)
+    std::vector<HitVector> hitArray(inputParticles.size());
 
-        const ClusterVector &clusterVector = iter1->second;
-        for (ClusterVector::const_iterator iter2 = clusterVector.begin(), iterEnd2 = clusterVector.end(); iter2 != iterEnd2; ++iter2)
+    LArPandoraHelper::ProcessInParallel(inputParticles.size(), 16, maxTasks, [&](const size_t begin, const size_t end)
+    {
+        for (size_t index = begin; index < end; ++index)
         {
-            const art::Ptr<recob::Cluster> cluster = *iter2;
+            if (outputParticles.at(index).isNull())
+                continue;
 
-            ClustersToHits::const_iterator iter3 = clustersToHits.find(cluster);
-            if (clustersToHits.end() == iter3)
-                throw cet::exception("LArPandora") << " PandoraCollector::BuildPFParticleHitMaps --- Found a space point without an associated hit ";
+            const ClusterVector &clusterVector = *(inputClusters.at(index));
+            HitVector &particleHitVector = hitArray.at(index);
 
-            const HitVector &hitVector = iter3->second;
-            for (HitVector::const_iterator iter4 = hitVector.begin(), iterEnd4 = hitVector.end(); iter4 != iterEnd4; ++iter4)
-            { 
-                const art::Ptr<recob::Hit> hit = *iter4;
-        
-                particlesToHits[particle].push_back(hit);
-                hitsToParticles[hit] = particle;
+            for (ClusterVector::const_iterator iter2 = clusterVector.begin(), iterEnd2 = clusterVector.end(); iter2 != iterEnd2; ++iter2)
+            {
+                const art::Ptr<recob::Cluster> cluster = *iter2;
+
+                ClustersToHits::const_iterator iter3 = clustersToHits.find(cluster);
+                if (clustersToHits.end() == iter3)
+                    throw cet::exception("LArPandora") << " PandoraCollector::BuildPFParticleHitMaps --- Found a space point without an associated hit ";
+
+                const HitVector &hitVector = iter3->second;
+                particleHitVector.insert(particleHitVector.end(), hitVector.begin(), hitVector.end());
             }
         }
-    }
+    });
+
+    LArPandoraHelper::MergePFParticleHitMaps(outputParticles, hitArray, particlesToHits, hitsToParticles);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
 void LArPandoraHelper::BuildPFParticleHitMaps(const art::Event &evt, const std::string label_pfpart, const std::string label_middle,
-    PFParticlesToHits &particlesToHits, HitsToPFParticles &hitsToParticles, const DaughterMode daughterMode, const bool useClusters)
+    PFParticlesToHits &particlesToHits, HitsToPFParticles &hitsToParticles, const DaughterMode daughterMode, const bool useClusters,
+    const unsigned int maxTasks)
 {
     // Use intermediate clusters
     if (useClusters)
@@ -543,7 +572,7 @@ void LArPandoraHelper::BuildPFParticleHitMaps(const art::Event &evt, const std::
         LArPandoraHelper::CollectClusters(evt, label_middle, clusterVector, clustersToHits);
 
         LArPandoraHelper::BuildPFParticleHitMaps(particleVector, particlesToClusters, clustersToHits, 
-            particlesToHits, hitsToParticles, daughterMode);
+            particlesToHits, hitsToParticles, daughterMode, maxTasks);
     }
 
     // Use intermediate space points
@@ -559,7 +588,7 @@ void LArPandoraHelper::BuildPFParticleHitMaps(const art::Event &evt, const std::
         LArPandoraHelper::CollectSpacePoints(evt, label_middle, spacePointVector, spacePointsToHits);
 
         LArPandoraHelper::BuildPFParticleHitMaps(particleVector, particlesToSpacePoints, spacePointsToHits, 
-            particlesToHits, hitsToParticles, daughterMode);   
+            particlesToHits, hitsToParticles, daughterMode, maxTasks);   
   }
 }
 
@@ -650,6 +679,15 @@ void LArPandoraHelper::CollectSimChannels(const art::Event &evt, const std::stri
 //------------------------------------------------------------------------------------------------------------------------------------------
 
 void LArPandoraHelper::CollectMCParticles(const art::Event &evt, const std::string label, MCParticleVector &particleVector)
+{
+    MCParticleCollection particleCollection;
+    LArPandoraHelper::CollectMCParticles(evt, label, particleCollection);
+    particleCollection.GetPtrVector(particleVector);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraHelper::CollectMCParticles(const art::Event &evt, const std::string label, MCParticleCollection &particleCollection)
 {
     if (evt.isRealData())
         throw cet::exception("LArPandora") << " PandoraCollector::CollectMCParticles --- Trying to access MC truth from real data ";
@@ -667,11 +705,7 @@ void LArPandoraHelper::CollectMCParticles(const art::Event &evt, const std::stri
         mf::LogDebug("LArPandora") << "  Found: " << theParticles->size() << " MC particles " << std::endl;
     }
 
-    for (unsigned int i = 0; i < theParticles->size(); ++i)
-    {
-        const art::Ptr<simb::MCParticle> particle(theParticles, i);
-        particleVector.push_back(particle);
-    }
+    particleCollection = MCParticleCollection(theParticles);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -712,6 +746,18 @@ void LArPandoraHelper::CollectMCParticles(const art::Event &evt, const std::stri
 void LArPandoraHelper::BuildMCParticleHitMaps(const HitVector &hitVector, const SimChannelVector &simChannelVector, 
     HitsToTrackIDEs &hitsToTrackIDEs)
 {
+    const HitSoA hitSoA(hitVector);
+    LArPandoraHelper::BuildMCParticleHitMaps(hitVector, hitSoA, simChannelVector, hitsToTrackIDEs);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraHelper::BuildMCParticleHitMaps(const HitVector &hitVector, const HitSoA &hitSoA, const SimChannelVector &simChannelVector,
+    HitsToTrackIDEs &hitsToTrackIDEs)
+{
+    if (hitSoA.GetNHits() != hitVector.size())
+        throw cet::exception("LArPandora") << " PandoraCollector::BuildMCParticleHitMaps --- Hit snapshot does not match the input hits ";
+
     auto const* ts = lar::providerFrom<detinfo::DetectorClocksService>();
 
     SimChannelMap simChannelMap;
@@ -722,27 +768,24 @@ void LArPandoraHelper::BuildMCParticleHitMaps(const HitVector &hitVector, const
         simChannelMap.insert(SimChannelMap::value_type(simChannel->Channel(), simChannel));
     }
 
-    for (HitVector::const_iterator iter = hitVector.begin(), iterEnd = hitVector.end(); iter != iterEnd; ++iter)
+    const std::vector<raw::ChannelID_t> &hitChannels(hitSoA.GetChannels());
+
+    for (size_t index = 0, indexEnd = hitSoA.GetNHits(); index < indexEnd; ++index)
     {
-        const art::Ptr<recob::Hit> hit = *iter;
-        
-	SimChannelMap::const_iterator sIter = simChannelMap.find(hit->Channel());
+        SimChannelMap::const_iterator sIter = simChannelMap.find(hitChannels[index]);
         if (simChannelMap.end() == sIter)
-	    continue; // Hit has no truth information [continue]
+            continue; // Hit has no truth information [continue]
 
         const art::Ptr<sim::SimChannel> simChannel = sIter->second;
-        const raw::TDCtick_t start_tdc(ts->TPCTick2TDC(hit->PeakTimeMinusRMS()));
-        const raw::TDCtick_t end_tdc(ts->TPCTick2TDC(hit->PeakTimePlusRMS()));
+        const raw::TDCtick_t start_tdc(ts->TPCTick2TDC(hitSoA.GetPeakTimeMinusRMS(index)));
+        const raw::TDCtick_t end_tdc(ts->TPCTick2TDC(hitSoA.GetPeakTimePlusRMS(index)));
         const TrackIDEVector trackCollection(simChannel->TrackIDEs(start_tdc, end_tdc));
 
         if (trackCollection.empty())
             continue; // Hit has no truth information [continue]
 
-        for (unsigned int iTrack = 0, iTrackEnd = trackCollection.size(); iTrack < iTrackEnd; ++iTrack)
-        {
-            const sim::TrackIDE trackIDE = trackCollection.at(iTrack);
-            hitsToTrackIDEs[hit].push_back(trackIDE);
-        }
+        TrackIDEVector &hitTrackIDEs(hitsToTrackIDEs[hitVector[index]]);
+        hitTrackIDEs.insert(hitTrackIDEs.end(), trackCollection.begin(), trackCollection.end());
     }
 }
 
@@ -901,6 +944,39 @@ art::Ptr<recob::PFParticle> LArPandoraHelper::GetFinalStatePFParticle(const PFPa
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
+art::Ptr<recob::PFParticle> LArPandoraHelper::GetFinalStatePFParticle(const PFParticleMap &particleMap, const art::Ptr<recob::PFParticle> inputParticle,
+    PFParticleMap &finalStateMap)
+{
+    PFParticleMap::const_iterator cIter = finalStateMap.find(inputParticle->Self());
+    if (finalStateMap.end() != cIter)
+        return cIter->second;
+
+    // Same navigation as above: stop below a parent neutrino, or at a primary particle (re-using the answer cached for the parent)
+    int primaryTrackID(inputParticle->Self());
+
+    if (!inputParticle->IsPrimary())
+    {
+        PFParticleMap::const_iterator pIter1 = particleMap.find(inputParticle->Parent());
+        if (particleMap.end() == pIter1)
+            throw cet::exception("LArPandora") << " PandoraCollector::GetFinalStatePFParticle --- Found a PFParticle without a particle ID ";
+
+        const art::Ptr<recob::PFParticle> parentParticle = pIter1->second;
+
+        if (!LArPandoraHelper::IsNeutrino(parentParticle))
+            primaryTrackID = LArPandoraHelper::GetFinalStatePFParticle(particleMap, parentParticle, finalStateMap)->Self();
+    }
+
+    PFParticleMap::const_iterator pIter2 = particleMap.find(primaryTrackID);
+    if (particleMap.end() == pIter2)
+        throw cet::exception("LArPandora") << " PandoraCollector::GetFinalStatePFParticle --- Found a PFParticle without a particle ID ";
+
+    const art::Ptr<recob::PFParticle> outputParticle = pIter2->second;
+    finalStateMap[inputParticle->Self()] = outputParticle;
+    return outputParticle;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
 art::Ptr<simb::MCParticle> LArPandoraHelper::GetParentMCParticle(const MCParticleMap &particleMap, const art::Ptr<simb::MCParticle> inputParticle)
 {
     // Navigate upward through MC daughter/parent links - return the top-level MC particle
@@ -1097,4 +1173,140 @@ bool LArPandoraHelper::IsVisible(const art::Ptr<simb::MCParticle> particle)
     return false;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraHelper::ProcessInParallel(const size_t nItems, const size_t minItemsPerTask, const std::function<void(const size_t, const size_t)> &processRange)
+{
+    LArPandoraHelper::ProcessInParallel(nItems, minItemsPerTask, 0, processRange);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraHelper::ProcessInParallel(const size_t nItems, const size_t minItemsPerTask, const unsigned int maxTasks,
+    const std::function<void(const size_t, const size_t)> &processRange)
+{
+    const size_t nThreads((maxTasks > 0) ? maxTasks : std::max(1u, std::thread::hardware_concurrency()));
+    const size_t nTasks(std::min(nThreads, nItems / std::max(static_cast<size_t>(1), minItemsPerTask)));
+
+    if (nTasks < 2)
+    {
+        processRange(0, nItems);
+        return;
+    }
+
+    const size_t itemsPerTask((nItems + nTasks - 1) / nTasks);
+    std::vector< std::future<void> > taskVector;
+
+    for (size_t begin = 0; begin < nItems; begin += itemsPerTask)
+        taskVector.push_back(std::async(std::launch::async, processRange, begin, std::min(nItems, begin + itemsPerTask)));
+
+    // Wait for every task before propagating any exception, as the tasks reference the caller's data
+    for (std::future<void> &task : taskVector)
+        task.wait();
+
+    for (std::future<void> &task : taskVector)
+        task.get();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraHelper::ProcessQueueInParallel(const size_t nItems, const unsigned int maxTasks, const std::function<void(const size_t)> &processItem)
+{
+    const size_t nThreads((maxTasks > 0) ? maxTasks : std::max(1u, std::thread::hardware_concurrency()));
+    const size_t nTasks(std::min(nThreads, nItems));
+
+    if (nTasks < 2)
+    {
+        for (size_t index = 0; index < nItems; ++index)
+            processItem(index);
+
+        return;
+    }
+
+    std::atomic<size_t> nextIndex(0);
+    std::atomic<bool> abort(false);
+
+    const auto processQueue = [&]()
+    {
+        try
+        {
+            for (size_t index = nextIndex++; (index < nItems) && !abort; index = nextIndex++)
+                processItem(index);
+        }
+        catch (...)
+        {
+            // Stop the other tasks taking new items, then report the exception via the future
+            abort = true;
+            throw;
+        }
+    };
+
+    std::vector< std::future<void> > taskVector;
+
+    for (size_t iTask = 0; iTask < nTasks; ++iTask)
+        taskVector.push_back(std::async(std::launch::async, processQueue));
+
+    // Wait for every task before propagating any exception, as the tasks reference the caller's data
+    for (std::future<void> &task : taskVector)
+        task.wait();
+
+    for (std::future<void> &task : taskVector)
+        task.get();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraHelper::SelectPFParticlesForHitMaps(const PFParticleVector &particleVector, const PFParticleVector &inputParticles,
+    const DaughterMode daughterMode, PFParticleVector &outputParticles)
+{
+    // Build mapping from particle to particle ID for parent/daughter navigation
+    PFParticleMap particleMap;
+
+    for (PFParticleVector::const_iterator iter1 = particleVector.begin(), iterEnd1 = particleVector.end(); iter1 != iterEnd1; ++iter1)
+    {
+        const art::Ptr<recob::PFParticle> particle = *iter1;
+        particleMap[particle->Self()] = particle;
+    }
+
+    // Final-state parents are shared by all particles in a hierarchy, so navigate each hierarchy once
+    PFParticleMap finalStateMap;
+
+    for (PFParticleVector::const_iterator iter1 = inputParticles.begin(), iterEnd1 = inputParticles.end(); iter1 != iterEnd1; ++iter1)
+    {
+        const art::Ptr<recob::PFParticle> thisParticle = *iter1;
+        const art::Ptr<recob::PFParticle> particle((kAddDaughters == daughterMode) ? 
+            LArPandoraHelper::GetFinalStatePFParticle(particleMap, thisParticle, finalStateMap) : thisParticle);
+
+        if ((kIgnoreDaughters == daughterMode) && !LArPandoraHelper::IsFinalState(particleMap, particle))
+        {
+            outputParticles.push_back(art::Ptr<recob::PFParticle>());
+            continue;
+        }
+
+        outputParticles.push_back(particle);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraHelper::MergePFParticleHitMaps(const PFParticleVector &outputParticles, const std::vector<HitVector> &hitArray,
+    PFParticlesToHits &particlesToHits, HitsToPFParticles &hitsToParticles)
+{
+    // Merge in input order, so that the maps are identical to those from a sequential loop over the input particles
+    for (size_t index = 0, indexEnd = outputParticles.size(); index < indexEnd; ++index)
+    {
+        const art::Ptr<recob::PFParticle> particle = outputParticles.at(index);
+        const HitVector &hitVector = hitArray.at(index);
+
+        if (particle.isNull() || hitVector.empty())
+            continue;
+
+        HitVector &particleHits = particlesToHits[particle];
+        particleHits.insert(particleHits.end(), hitVector.begin(), hitVector.end());
+
+        for (HitVector::const_iterator iter = hitVector.begin(), iterEnd = hitVector.end(); iter != iterEnd; ++iter)
+            hitsToParticles[*iter] = particle;
+    }
+}
+
 } // namespace lar_pandora
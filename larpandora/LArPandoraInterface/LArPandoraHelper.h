@@ -11,6 +11,9 @@
 
 #include "lardataobj/Simulation/SimChannel.h"
 
+#include "larpandora/LArPandoraInterface/LArPandoraCollectionView.h"
+
+#include <functional>
 #include <map>
 #include <set>
 #include <vector>
@@ -26,6 +29,8 @@ namespace simb {class MCParticle; class MCTruth;}
 namespace lar_pandora 
 {
 
+class HitSoA;
+
 typedef std::set< art::Ptr<recob::Hit> > HitList;
 
 typedef std::vector< art::Ptr<recob::Wire> >        WireVector;
@@ -43,6 +48,11 @@ typedef std::vector< art::Ptr<sim::SimChannel> >    SimChannelVector;
 typedef std::vector< sim::TrackIDE >                TrackIDEVector;
 typedef std::vector< art::Ptr<anab::CosmicTag> >    CosmicTagVector;
 
+typedef CollectionView<recob::Wire>                 WireCollection;
+typedef CollectionView<recob::Hit>                  HitCollection;
+typedef CollectionView<recob::PFParticle>           PFParticleCollection;
+typedef CollectionView<simb::MCParticle>            MCParticleCollection;
+
 typedef std::map< art::Ptr<recob::PFParticle>, TrackVector >                  PFParticlesToTracks;
 typedef std::map< art::Ptr<recob::PFParticle>, ShowerVector >                 PFParticlesToShowers;
 typedef std::map< art::Ptr<recob::PFParticle>, ClusterVector >                PFParticlesToClusters;
@@ -103,6 +113,15 @@ public:
      */
     static void CollectWires(const art::Event &evt, const std::string label, WireVector &wireVector);
 
+    /**
+     *  @brief Collect a view of the reconstructed wires from the ART event record
+     *
+     *  @param evt the ART event record
+     *  @param label the label for the Wire list in the event
+     *  @param wireCollection the output view of the Wire collection
+     */
+    static void CollectWires(const art::Event &evt, const std::string label, WireCollection &wireCollection);
+
     /**
      *  @brief Collect the reconstructed Hits from the ART event record
      *
@@ -112,6 +131,15 @@ public:
      */
     static void CollectHits(const art::Event &evt, const std::string label, HitVector &hitVector);
 
+    /**
+     *  @brief Collect a view of the reconstructed Hits from the ART event record
+     *
+     *  @param evt the ART event record
+     *  @param label the label for the Hit list in the event
+     *  @param hitCollection the output view of the Hit collection
+     */
+    static void CollectHits(const art::Event &evt, const std::string label, HitCollection &hitCollection);
+
     /**
      *  @brief Collect the reconstructed PFParticles from the ART event record
      *
@@ -121,6 +149,15 @@ public:
      */
     static void CollectPFParticles(const art::Event &evt, const std::string label, PFParticleVector &particleVector);
 
+    /**
+     *  @brief Collect a view of the reconstructed PFParticles from the ART event record
+     *
+     *  @param evt the ART event record
+     *  @param label the label for the PFParticle list in the event
+     *  @param particleCollection the output view of the PFParticle collection
+     */
+    static void CollectPFParticles(const art::Event &evt, const std::string label, PFParticleCollection &particleCollection);
+
     /**
      *  @brief Collect the reconstructed SpacePoints and associated hits from the ART event record
      *
@@ -252,10 +289,11 @@ public:
      *  @param particlesToHits the output map from PFParticle to Hit objects
      *  @param hitsToParticles the output map from Hit to PFParticle objects
      *  @param daughterMode treatment of daughter particles in construction of maps
+     *  @param maxTasks the maximum number of concurrent tasks collecting the hits (zero to use the hardware concurrency)
      */
     static void BuildPFParticleHitMaps(const PFParticleVector &particleVector, const PFParticlesToSpacePoints &particlesToSpacePoints, 
         const SpacePointsToHits &spacePointsToHits, PFParticlesToHits &particlesToHits, HitsToPFParticles &hitsToParticles, 
-        const DaughterMode daughterMode = kUseDaughters);   
+        const DaughterMode daughterMode = kUseDaughters, const unsigned int maxTasks = 1);   
 
     /**
      *  @brief Build mapping between PFParticles and Hits using PFParticle/Cluster/Hit maps
@@ -266,10 +304,11 @@ public:
      *  @param particlesToHits the output map from PFParticle to Hit objects
      *  @param hitsToParticles the output map from Hit to PFParticle objects
      *  @param daughterMode treatment of daughter particles in construction of maps
+     *  @param maxTasks the maximum number of concurrent tasks collecting the hits (zero to use the hardware concurrency)
      */
     static void BuildPFParticleHitMaps(const PFParticleVector &particleVector, const PFParticlesToClusters &particlesToClusters, 
         const ClustersToHits &clustersToHits, PFParticlesToHits &particlesToHits, HitsToPFParticles &hitsToParticles, 
-        const DaughterMode daughterMode = kUseDaughters);
+        const DaughterMode daughterMode = kUseDaughters, const unsigned int maxTasks = 1);
 
     /**
      *  @brief Build mapping between PFParticles and Hits starting from ART event record
@@ -281,10 +320,11 @@ public:
      *  @param hitsToParticles output map from Hit to PFParticle objects
      *  @param daughterMode treatment of daughter particles in construction of maps
      *  @param useClusters choice of intermediate object (true for Clusters, false for SpacePoints)
+     *  @param maxTasks the maximum number of concurrent tasks collecting the hits (zero to use the hardware concurrency)
      */
     static void BuildPFParticleHitMaps(const art::Event &evt, const std::string label_pfpart, const std::string label_mid,
         PFParticlesToHits &particlesToHits, HitsToPFParticles &hitsToParticles, const DaughterMode daughterMode = kUseDaughters,
-        const bool useClusters = true);
+        const bool useClusters = true, const unsigned int maxTasks = 1);
 
     /**
      *  @brief Collect a vector of cosmic tags from the ART event record
@@ -315,6 +355,15 @@ public:
      */
     static void CollectMCParticles(const art::Event &evt, const std::string label, MCParticleVector &particleVector);
 
+    /**
+     *  @brief Collect a view of the MCParticle objects from the ART event record
+     *
+     *  @param evt the ART event record
+     *  @param label the label for the truth information in the event
+     *  @param particleCollection the output view of the MCParticle collection
+     */
+    static void CollectMCParticles(const art::Event &evt, const std::string label, MCParticleCollection &particleCollection);
+
     /**
      *  @brief Collect truth information from the ART event record
      *
@@ -335,6 +384,17 @@ public:
      */
     static void BuildMCParticleHitMaps(const HitVector &hitVector, const SimChannelVector &simChannelVector, HitsToTrackIDEs &hitsToTrackIDEs);
 
+    /**
+     *  @brief Collect the links from reconstructed hits to their true energy deposits, reading hit properties from a snapshot
+     *
+     *  @param hitVector the input vector of reconstructed hits
+     *  @param hitSoA the structure-of-arrays snapshot of the input hits
+     *  @param simChannelVector the input vector of SimChannels
+     *  @param hitsToTrackIDEs the out map from hits to true energy deposits
+     */
+    static void BuildMCParticleHitMaps(const HitVector &hitVector, const HitSoA &hitSoA, const SimChannelVector &simChannelVector,
+        HitsToTrackIDEs &hitsToTrackIDEs);
+
     /**
      *  @brief Build mapping between Hits and MCParticles, starting from Hit/TrackIDE/MCParticle information
      *
@@ -396,6 +456,18 @@ public:
      */
     static art::Ptr<recob::PFParticle> GetFinalStatePFParticle(const PFParticleMap &particleMap, const art::Ptr<recob::PFParticle> daughterParticle);
 
+    /**
+     *  @brief Return the final-state parent particle, caching the result for every particle visited on the way up the hierarchy
+     *
+     *  @param particleMap the mapping between reconstructed particle and particle ID
+     *  @param daughterParticle the input PF particle
+     *  @param finalStateMap the cache of final-state parent particles, indexed by particle ID
+     *
+     *  @return the final-state parent particle
+     */
+    static art::Ptr<recob::PFParticle> GetFinalStatePFParticle(const PFParticleMap &particleMap, const art::Ptr<recob::PFParticle> daughterParticle,
+        PFParticleMap &finalStateMap);
+
     /**
      *  @brief Return the top-level parent particle by navigating up the chain of parent/daughter associations
      *
@@ -489,6 +561,64 @@ public:
      *  @return true/false
      */
     static bool IsVisible(const art::Ptr<simb::MCParticle> particle);
+
+    /**
+     *  @brief Split the index range [0, nItems) into contiguous blocks and process each block in its own task
+     *
+     *  @param nItems the number of items to process
+     *  @param minItemsPerTask the minimum number of items that justifies an additional task
+     *  @param processRange the function processing the items in the half-open index range [begin, end)
+     *
+     *  Blocks are processed concurrently, so processRange must only write to per-item (or per-block) storage. Any exception
+     *  thrown by a task is rethrown in the calling thread, once all tasks have finished.
+     */
+    static void ProcessInParallel(const size_t nItems, const size_t minItemsPerTask, const std::function<void(const size_t, const size_t)> &processRange);
+
+    /**
+     *  @brief Split the index range [0, nItems) into contiguous blocks and process each block in its own task, using at most maxTasks tasks
+     *
+     *  @param nItems the number of items to process
+     *  @param minItemsPerTask the minimum number of items that justifies an additional task
+     *  @param maxTasks the maximum number of concurrent tasks (zero to use the hardware concurrency)
+     *  @param processRange the function processing the items in the half-open index range [begin, end)
+     */
+    static void ProcessInParallel(const size_t nItems, const size_t minItemsPerTask, const unsigned int maxTasks,
+        const std::function<void(const size_t, const size_t)> &processRange);
+
+    /**
+     *  @brief Process the items [0, nItems) using a pool of tasks, each repeatedly taking the next unprocessed item from a shared queue
+     *
+     *  @param nItems the number of items to process
+     *  @param maxTasks the maximum number of concurrent tasks (zero to use the hardware concurrency)
+     *  @param processItem the function processing the item with a given index
+     *
+     *  Items are started in index order, so ordering the items by decreasing cost balances the load between the tasks. As for
+     *  ProcessInParallel, any exception thrown by a task is rethrown in the calling thread, once all tasks have finished.
+     */
+    static void ProcessQueueInParallel(const size_t nItems, const unsigned int maxTasks, const std::function<void(const size_t)> &processItem);
+
+private:
+    /**
+     *  @brief Select the particle to which the hits of each input particle should be assigned, according to the daughter mode
+     *
+     *  @param particleVector the input vector of PFParticle objects
+     *  @param inputParticles the particles for which hits are available
+     *  @param daughterMode treatment of daughter particles in construction of maps
+     *  @param outputParticles the selected particle for each input particle (a null pointer if the input particle is to be ignored)
+     */
+    static void SelectPFParticlesForHitMaps(const PFParticleVector &particleVector, const PFParticleVector &inputParticles,
+        const DaughterMode daughterMode, PFParticleVector &outputParticles);
+
+    /**
+     *  @brief Merge per-particle hit lists into the output maps, in the order of the input particles
+     *
+     *  @param outputParticles the selected particle for each input particle (a null pointer if the input particle is ignored)
+     *  @param hitArray the hits for each input particle, in the same order
+     *  @param particlesToHits the output map from PFParticle to Hit objects
+     *  @param hitsToParticles the output map from Hit to PFParticle objects
+     */
+    static void MergePFParticleHitMaps(const PFParticleVector &outputParticles, const std::vector<HitVector> &hitArray,
+        PFParticlesToHits &particlesToHits, HitsToPFParticles &hitsToParticles);
 };
 
 } // namespace lar_pandora
@@ -0,0 +1,45 @@
+/**
+ *  @file   larpandora/LArPandoraInterface/LArPandoraHitCacheService.cxx
+ *
+ *  @brief  Service sharing the converted pandora hit inputs between the LArPandora producers in a job
+ */
+
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include "larpandora/LArPandoraInterface/LArPandoraHitCacheService.h"
+
+namespace lar_pandora
+{
+
+LArPandoraHitCacheService::LArPandoraHitCacheService(fhicl::ParameterSet const &/*pset*/, art::ActivityRegistry &/*registry*/)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+const HitInput &LArPandoraHitCacheService::GetHitInput(const art::Event &evt, const std::string &label, const LArPandoraInput::Settings &settings)
+{
+    if (evt.id() != m_eventId)
+    {
+        m_hitInputMap.clear();
+        m_eventId = evt.id();
+    }
+
+    // The hit geometry is shared by all producers, but the calibration to MIPs depends on the producer settings
+    const HitInputKey hitInputKey(label, settings.m_dEdX_max, settings.m_dEdX_mip, settings.m_recombination_factor);
+    HitInputMap::const_iterator iter = m_hitInputMap.find(hitInputKey);
+
+    if (m_hitInputMap.end() != iter)
+    {
+        mf::LogDebug("LArPandora") << " LArPandoraHitCacheService: reusing hit inputs for label " << label << std::endl;
+        return *(iter->second);
+    }
+
+    std::unique_ptr<HitInput> pHitInput(new HitInput(evt, label, settings));
+    const HitInput &hitInput(*pHitInput);
+    m_hitInputMap[hitInputKey] = std::move(pHitInput);
+
+    return hitInput;
+}
+
+} // namespace lar_pandora
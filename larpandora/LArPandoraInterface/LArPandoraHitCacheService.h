@@ -0,0 +1,74 @@
+/**
+ *  @file   larpandora/LArPandoraInterface/LArPandoraHitCacheService.h
+ *
+ *  @brief  Service sharing the converted pandora hit inputs between the LArPandora producers in a job
+ */
+
+#ifndef LAR_PANDORA_HIT_CACHE_SERVICE_H
+#define LAR_PANDORA_HIT_CACHE_SERVICE_H 1
+
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Services/Registry/ServiceMacros.h"
+
+#include "larpandora/LArPandoraInterface/LArPandoraHitInput.h"
+#include "larpandora/LArPandoraInterface/LArPandoraInput.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+
+namespace fhicl {class ParameterSet;}
+namespace art {class ActivityRegistry;}
+
+namespace lar_pandora
+{
+
+/**
+ *  @brief  LArPandoraHitCacheService class
+ *
+ *  Several LArPandora producers in one job (e.g. cosmic and neutrino passes) usually read the same hit collection. The first producer to
+ *  request the hits with a given label in an event collects them and evaluates their geometry and calibration; later producers with the
+ *  same hit label and calibration constants reuse the result. The cache only ever holds the current event.
+ *
+ *  Enable it with e.g.
+ *
+ *      services.LArPandoraHitCacheService: {}
+ *
+ *  and UseHitCacheService: true in each producer. There are no configuration parameters.
+ */
+class LArPandoraHitCacheService
+{
+public:
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  pset the parameter set
+     *  @param  registry the activity registry
+     */
+    LArPandoraHitCacheService(fhicl::ParameterSet const &pset, art::ActivityRegistry &registry);
+
+    /**
+     *  @brief  Get the hits with a given label in an event, with their pandora 2D hit inputs, converting them on the first request
+     *
+     *  @param  evt the ART event
+     *  @param  label the hit producer module label
+     *  @param  settings the input settings, providing the calibration constants
+     *
+     *  @return the hits and their pandora 2D hit inputs, valid until the next event is requested
+     */
+    const HitInput &GetHitInput(const art::Event &evt, const std::string &label, const LArPandoraInput::Settings &settings);
+
+private:
+    typedef std::tuple<std::string, double, double, double> HitInputKey;
+    typedef std::map<HitInputKey, std::unique_ptr<HitInput> > HitInputMap;
+
+    art::EventID            m_eventId;          ///< The id of the event for which hit inputs are cached
+    HitInputMap             m_hitInputMap;      ///< The cached hit inputs, per hit label and calibration constants
+};
+
+} // namespace lar_pandora
+
+DECLARE_ART_SERVICE(lar_pandora::LArPandoraHitCacheService, LEGACY)
+
+#endif // #ifndef LAR_PANDORA_HIT_CACHE_SERVICE_H
@@ -0,0 +1,11 @@
+/**
+ *  @file   larpandora/LArPandoraInterface/LArPandoraHitCacheService_service.cc
+ *
+ *  @brief  Service sharing the converted pandora hit inputs between the LArPandora producers in a job (implementation file)
+ *
+ *  Implementation file is required in order to host art service macro.
+ */
+
+#include "larpandora/LArPandoraInterface/LArPandoraHitCacheService.h"
+
+DEFINE_ART_SERVICE(lar_pandora::LArPandoraHitCacheService)
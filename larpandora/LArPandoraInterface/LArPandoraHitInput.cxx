@@ -0,0 +1,63 @@
+/**
+ *  @file   larpandora/LArPandoraInterface/LArPandoraHitInput.cxx
+ *
+ *  @brief  The input hits for the pandora 2D hits, with their geometry and calibration already evaluated
+ */
+
+#include "art/Framework/Principal/Event.h"
+
+#include "lardataobj/RecoBase/Hit.h"
+
+#include "larpandora/LArPandoraInterface/LArPandoraHitInput.h"
+
+namespace lar_pandora
+{
+
+void HitInputSoA::Reserve(const size_t nHits)
+{
+    m_xPositions.reserve(nHits);
+    m_xWidths.reserve(nHits);
+    m_wireYs.reserve(nHits);
+    m_wireZs.reserve(nHits);
+    m_wireMinZs.reserve(nHits);
+    m_wireMaxZs.reserve(nHits);
+    m_wirePitches.reserve(nHits);
+    m_mips.reserve(nHits);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void HitInputSoA::AddHit(const double xPosition, const double xWidth, const double wireY, const double wireZ, const double wireMinZ,
+    const double wireMaxZ, const double wirePitch, const double mips)
+{
+    m_xPositions.push_back(xPosition);
+    m_xWidths.push_back(xWidth);
+    m_wireYs.push_back(wireY);
+    m_wireZs.push_back(wireZ);
+    m_wireMinZs.push_back(wireMinZ);
+    m_wireMaxZs.push_back(wireMaxZ);
+    m_wirePitches.push_back(wirePitch);
+    m_mips.push_back(mips);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+HitInput::HitInput(const art::Event &evt, const std::string &label, const LArPandoraInput::Settings &settings) :
+    m_hitCollection(HitInput::CollectHits(evt, label)),
+    m_hitSoA(m_hitCollection)
+{
+    m_hitCollection.GetPtrVector(m_hitVector);
+    LArPandoraInput::FillHitInputs(settings, m_hitSoA, m_hitInputSoA);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+HitCollection HitInput::CollectHits(const art::Event &evt, const std::string &label)
+{
+    HitCollection hitCollection;
+    LArPandoraHelper::CollectHits(evt, label, hitCollection);
+    return hitCollection;
+}
+
+} // namespace lar_pandora
@@ -0,0 +1,254 @@
+/**
+ *  @file   larpandora/LArPandoraInterface/LArPandoraHitInput.h
+ *
+ *  @brief  The input hits for the pandora 2D hits, with their geometry and calibration already evaluated
+ */
+
+#ifndef LAR_PANDORA_HIT_INPUT_H
+#define LAR_PANDORA_HIT_INPUT_H 1
+
+#include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
+#include "larpandora/LArPandoraInterface/LArPandoraHitSoA.h"
+#include "larpandora/LArPandoraInterface/LArPandoraInput.h"
+
+#include <string>
+#include <vector>
+
+namespace lar_pandora
+{
+
+/**
+ *  @brief  HitInputSoA class, holding the producer-independent properties of the pandora 2D hits in contiguous arrays
+ *
+ *  Entry i of each array describes entry i of the hit snapshot from which the inputs were evaluated.
+ */
+class HitInputSoA
+{
+public:
+    /**
+     *  @brief  Reserve space in each array
+     *
+     *  @param  nHits the number of hits
+     */
+    void Reserve(const size_t nHits);
+
+    /**
+     *  @brief  Append the properties of a hit to each array
+     *
+     *  @param  xPosition the drift coordinate of the hit [cm]
+     *  @param  xWidth the extent of the hit in the drift coordinate [cm]
+     *  @param  wireY the y coordinate of the wire centre [cm]
+     *  @param  wireZ the z coordinate of the wire centre [cm]
+     *  @param  wireMinZ the minimum z coordinate of the wire [cm]
+     *  @param  wireMaxZ the maximum z coordinate of the wire [cm]
+     *  @param  wirePitch the wire pitch of the view [cm]
+     *  @param  mips the calibrated charge [MIPs]
+     */
+    void AddHit(const double xPosition, const double xWidth, const double wireY, const double wireZ, const double wireMinZ,
+        const double wireMaxZ, const double wirePitch, const double mips);
+
+    /**
+     *  @brief  Return the number of hits
+     */
+    size_t GetNHits() const;
+
+    /**
+     *  @brief  Return the array of drift coordinates [cm]
+     */
+    const std::vector<double> &GetXPositions() const;
+
+    /**
+     *  @brief  Return the array of hit extents in the drift coordinate [cm]
+     */
+    const std::vector<double> &GetXWidths() const;
+
+    /**
+     *  @brief  Return the array of wire centre y coordinates [cm]
+     */
+    const std::vector<double> &GetWireYs() const;
+
+    /**
+     *  @brief  Return the array of wire centre z coordinates [cm]
+     */
+    const std::vector<double> &GetWireZs() const;
+
+    /**
+     *  @brief  Return the array of minimum wire z coordinates [cm]
+     */
+    const std::vector<double> &GetWireMinZs() const;
+
+    /**
+     *  @brief  Return the array of maximum wire z coordinates [cm]
+     */
+    const std::vector<double> &GetWireMaxZs() const;
+
+    /**
+     *  @brief  Return the array of wire pitches [cm]
+     */
+    const std::vector<double> &GetWirePitches() const;
+
+    /**
+     *  @brief  Return the array of calibrated charges [MIPs]
+     */
+    const std::vector<double> &GetMips() const;
+
+private:
+    std::vector<double>     m_xPositions;       ///< The drift coordinates
+    std::vector<double>     m_xWidths;          ///< The extents in the drift coordinate
+    std::vector<double>     m_wireYs;           ///< The wire centre y coordinates
+    std::vector<double>     m_wireZs;           ///< The wire centre z coordinates
+    std::vector<double>     m_wireMinZs;        ///< The minimum wire z coordinates
+    std::vector<double>     m_wireMaxZs;        ///< The maximum wire z coordinates
+    std::vector<double>     m_wirePitches;      ///< The wire pitches
+    std::vector<double>     m_mips;             ///< The calibrated charges
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  HitInput class, holding the hits with a given label in an event, together with their pandora 2D hit inputs
+ */
+class HitInput
+{
+public:
+    /**
+     *  @brief  Constructor, collecting the hits and evaluating their geometry and calibration
+     *
+     *  @param  evt the ART event
+     *  @param  label the hit producer module label
+     *  @param  settings the input settings, providing the calibration constants
+     */
+    HitInput(const art::Event &evt, const std::string &label, const LArPandoraInput::Settings &settings);
+
+    /**
+     *  @brief  Return the view of the hit collection
+     */
+    const HitCollection &GetHitCollection() const;
+
+    /**
+     *  @brief  Return the vector of hits
+     */
+    const HitVector &GetHitVector() const;
+
+    /**
+     *  @brief  Return the structure-of-arrays snapshot of the hits
+     */
+    const HitSoA &GetHitSoA() const;
+
+    /**
+     *  @brief  Return the pandora 2D hit inputs
+     */
+    const HitInputSoA &GetHitInputSoA() const;
+
+private:
+    /**
+     *  @brief  Collect the hits with a given label in an event
+     *
+     *  @param  evt the ART event
+     *  @param  label the hit producer module label
+     *
+     *  @return the view of the hit collection
+     */
+    static HitCollection CollectHits(const art::Event &evt, const std::string &label);
+
+    HitCollection           m_hitCollection;    ///< The view of the hit collection
+    HitVector               m_hitVector;        ///< The vector of hits
+    HitSoA                  m_hitSoA;           ///< The structure-of-arrays snapshot of the hits
+    HitInputSoA             m_hitInputSoA;      ///< The pandora 2D hit inputs
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline size_t HitInputSoA::GetNHits() const
+{
+    return m_xPositions.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const std::vector<double> &HitInputSoA::GetXPositions() const
+{
+    return m_xPositions;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const std::vector<double> &HitInputSoA::GetXWidths() const
+{
+    return m_xWidths;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const std::vector<double> &HitInputSoA::GetWireYs() const
+{
+    return m_wireYs;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const std::vector<double> &HitInputSoA::GetWireZs() const
+{
+    return m_wireZs;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const std::vector<double> &HitInputSoA::GetWireMinZs() const
+{
+    return m_wireMinZs;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const std::vector<double> &HitInputSoA::GetWireMaxZs() const
+{
+    return m_wireMaxZs;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const std::vector<double> &HitInputSoA::GetWirePitches() const
+{
+    return m_wirePitches;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const std::vector<double> &HitInputSoA::GetMips() const
+{
+    return m_mips;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const HitCollection &HitInput::GetHitCollection() const
+{
+    return m_hitCollection;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const HitVector &HitInput::GetHitVector() const
+{
+    return m_hitVector;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const HitSoA &HitInput::GetHitSoA() const
+{
+    return m_hitSoA;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const HitInputSoA &HitInput::GetHitInputSoA() const
+{
+    return m_hitInputSoA;
+}
+
+} // namespace lar_pandora
+
+#endif // #ifndef LAR_PANDORA_HIT_INPUT_H
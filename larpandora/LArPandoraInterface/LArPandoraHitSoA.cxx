@@ -0,0 +1,64 @@
+/**
+ *  @file   larpandora/LArPandoraInterface/LArPandoraHitSoA.cxx
+ *
+ *  @brief  Structure-of-arrays snapshot of the hit properties used by the pandora interface and analysis modules
+ */
+
+#include "lardataobj/RecoBase/Hit.h"
+
+#include "larpandora/LArPandoraInterface/LArPandoraHitSoA.h"
+
+namespace lar_pandora
+{
+
+HitSoA::HitSoA(const HitVector &hitVector)
+{
+    this->Reserve(hitVector.size());
+
+    for (const art::Ptr<recob::Hit> &hitPtr : hitVector)
+        this->AddHit(*hitPtr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+HitSoA::HitSoA(const HitCollection &hitCollection)
+{
+    this->Reserve(hitCollection.size());
+
+    for (const recob::Hit &hit : hitCollection)
+        this->AddHit(hit);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void HitSoA::Reserve(const size_t nHits)
+{
+    m_cryostats.reserve(nHits);
+    m_tpcs.reserve(nHits);
+    m_planes.reserve(nHits);
+    m_wires.reserve(nHits);
+    m_channels.reserve(nHits);
+    m_views.reserve(nHits);
+    m_peakTimes.reserve(nHits);
+    m_rmss.reserve(nHits);
+    m_integrals.reserve(nHits);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void HitSoA::AddHit(const recob::Hit &hit)
+{
+    const geo::WireID hit_WireID(hit.WireID());
+
+    m_cryostats.push_back(hit_WireID.Cryostat);
+    m_tpcs.push_back(hit_WireID.TPC);
+    m_planes.push_back(hit_WireID.Plane);
+    m_wires.push_back(hit_WireID.Wire);
+    m_channels.push_back(hit.Channel());
+    m_views.push_back(hit.View());
+    m_peakTimes.push_back(hit.PeakTime());
+    m_rmss.push_back(hit.RMS());
+    m_integrals.push_back(hit.Integral());
+}
+
+} // namespace lar_pandora
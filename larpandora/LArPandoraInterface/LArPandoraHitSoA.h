@@ -0,0 +1,232 @@
+/**
+ *  @file   larpandora/LArPandoraInterface/LArPandoraHitSoA.h
+ *
+ *  @brief  Structure-of-arrays snapshot of the hit properties used by the pandora interface and analysis modules
+ */
+
+#ifndef LAR_PANDORA_HIT_SOA_H
+#define LAR_PANDORA_HIT_SOA_H 1
+
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+#include "larcoreobj/SimpleTypesAndConstants/RawTypes.h"
+
+#include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
+
+#include <vector>
+
+namespace lar_pandora
+{
+
+/**
+ *  @brief  HitSoA class, holding the frequently-used properties of a vector of hits in contiguous arrays
+ *
+ *  Entry i of each array describes entry i of the hit vector from which the snapshot was built.
+ */
+class HitSoA
+{
+public:
+    /**
+     *  @brief  Constructor, dereferencing each input hit exactly once
+     *
+     *  @param  hitVector the input vector of hits
+     */
+    HitSoA(const HitVector &hitVector);
+
+    /**
+     *  @brief  Constructor, reading the hits directly from a collection view without creating art::Ptr objects
+     *
+     *  @param  hitCollection the input view of the hit collection
+     */
+    HitSoA(const HitCollection &hitCollection);
+
+    /**
+     *  @brief  Return the number of hits
+     */
+    size_t GetNHits() const;
+
+    /**
+     *  @brief  Return the wire ID of a hit
+     *
+     *  @param  index the hit index
+     */
+    geo::WireID GetWireID(const size_t index) const;
+
+    /**
+     *  @brief  Return the peak time of a hit, minus one RMS (matching recob::Hit::PeakTimeMinusRMS)
+     *
+     *  @param  index the hit index
+     */
+    float GetPeakTimeMinusRMS(const size_t index) const;
+
+    /**
+     *  @brief  Return the peak time of a hit, plus one RMS (matching recob::Hit::PeakTimePlusRMS)
+     *
+     *  @param  index the hit index
+     */
+    float GetPeakTimePlusRMS(const size_t index) const;
+
+    /**
+     *  @brief  Return the array of cryostat numbers
+     */
+    const std::vector<unsigned int> &GetCryostats() const;
+
+    /**
+     *  @brief  Return the array of tpc numbers
+     */
+    const std::vector<unsigned int> &GetTpcs() const;
+
+    /**
+     *  @brief  Return the array of plane numbers
+     */
+    const std::vector<unsigned int> &GetPlanes() const;
+
+    /**
+     *  @brief  Return the array of wire numbers
+     */
+    const std::vector<unsigned int> &GetWires() const;
+
+    /**
+     *  @brief  Return the array of readout channels
+     */
+    const std::vector<raw::ChannelID_t> &GetChannels() const;
+
+    /**
+     *  @brief  Return the array of views
+     */
+    const std::vector<geo::View_t> &GetViews() const;
+
+    /**
+     *  @brief  Return the array of peak times [ticks]
+     */
+    const std::vector<float> &GetPeakTimes() const;
+
+    /**
+     *  @brief  Return the array of peak widths [ticks]
+     */
+    const std::vector<float> &GetRMSs() const;
+
+    /**
+     *  @brief  Return the array of integrated charges [ADC]
+     */
+    const std::vector<float> &GetIntegrals() const;
+
+private:
+    /**
+     *  @brief  Reserve space in each array
+     *
+     *  @param  nHits the number of hits
+     */
+    void Reserve(const size_t nHits);
+
+    /**
+     *  @brief  Append the properties of a hit to each array
+     *
+     *  @param  hit the hit
+     */
+    void AddHit(const recob::Hit &hit);
+
+    std::vector<unsigned int>       m_cryostats;        ///< The cryostat numbers
+    std::vector<unsigned int>       m_tpcs;             ///< The tpc numbers
+    std::vector<unsigned int>       m_planes;           ///< The plane numbers
+    std::vector<unsigned int>       m_wires;            ///< The wire numbers
+    std::vector<raw::ChannelID_t>   m_channels;         ///< The readout channels
+    std::vector<geo::View_t>        m_views;            ///< The views
+    std::vector<float>              m_peakTimes;        ///< The peak times
+    std::vector<float>              m_rmss;             ///< The peak widths
+    std::vector<float>              m_integrals;        ///< The integrated charges
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline size_t HitSoA::GetNHits() const
+{
+    return m_peakTimes.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline geo::WireID HitSoA::GetWireID(const size_t index) const
+{
+    return geo::WireID(m_cryostats[index], m_tpcs[index], m_planes[index], m_wires[index]);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline float HitSoA::GetPeakTimeMinusRMS(const size_t index) const
+{
+    return m_peakTimes[index] - m_rmss[index];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline float HitSoA::GetPeakTimePlusRMS(const size_t index) const
+{
+    return m_peakTimes[index] + m_rmss[index];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const std::vector<unsigned int> &HitSoA::GetCryostats() const
+{
+    return m_cryostats;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const std::vector<unsigned int> &HitSoA::GetTpcs() const
+{
+    return m_tpcs;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const std::vector<unsigned int> &HitSoA::GetPlanes() const
+{
+    return m_planes;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const std::vector<unsigned int> &HitSoA::GetWires() const
+{
+    return m_wires;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const std::vector<raw::ChannelID_t> &HitSoA::GetChannels() const
+{
+    return m_channels;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const std::vector<geo::View_t> &HitSoA::GetViews() const
+{
+    return m_views;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const std::vector<float> &HitSoA::GetPeakTimes() const
+{
+    return m_peakTimes;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const std::vector<float> &HitSoA::GetRMSs() const
+{
+    return m_rmss;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const std::vector<float> &HitSoA::GetIntegrals() const
+{
+    return m_integrals;
+}
+
+} // namespace lar_pandora
+
+#endif // #ifndef LAR_PANDORA_HIT_SOA_H
@@ -34,61 +34,118 @@
 #include "larpandoracontent/LArPlugins/LArTransformationPlugin.h"
 
 #include "larpandora/LArPandoraInterface/ILArPandora.h"
+#include "larpandora/LArPandoraInterface/LArPandoraHitInput.h"
 #include "larpandora/LArPandoraInterface/LArPandoraInput.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace lar_pandora
 {
 
 void LArPandoraInput::CreatePandoraHits2D(const Settings &settings, const HitVector &hitVector, IdToHitMap &idToHitMap)
+{
+    const HitSoA hitSoA(hitVector);
+    LArPandoraInput::CreatePandoraHits2D(settings, hitVector, hitSoA, idToHitMap);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraInput::CreatePandoraHits2D(const Settings &settings, const HitVector &hitVector, const HitSoA &hitSoA, IdToHitMap &idToHitMap)
+{
+    PandoraInstanceHitCountMap hitCountMap;
+    LArPandoraInput::CreatePandoraHits2D(settings, hitVector, hitSoA, idToHitMap, hitCountMap);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraInput::CreatePandoraHits2D(const Settings &settings, const HitVector &hitVector, const HitSoA &hitSoA, IdToHitMap &idToHitMap,
+    PandoraInstanceHitCountMap &hitCountMap)
+{
+    HitInputSoA hitInputSoA;
+    LArPandoraInput::FillHitInputs(settings, hitSoA, hitInputSoA);
+
+    PandoraInstanceList hitInstanceList;
+    LArPandoraInput::CreatePandoraHits2D(settings, hitVector, hitSoA, hitInputSoA, idToHitMap, hitCountMap, hitInstanceList);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraInput::CreatePandoraHits2D(const Settings &settings, const HitVector &hitVector, const HitSoA &hitSoA, const HitInputSoA &hitInputSoA,
+    IdToHitMap &idToHitMap, PandoraInstanceHitCountMap &hitCountMap, PandoraInstanceList &hitInstanceList)
 {
     mf::LogDebug("LArPandora") << " *** LArPandoraInput::CreatePandoraHits2D(...) *** " << std::endl;
 
-    if (!settings.m_pPrimaryPandora || !settings.m_pILArPandora)
+    if ((hitSoA.GetNHits() != hitVector.size()) || (hitInputSoA.GetNHits() != hitVector.size()))
         throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
 
-    // Set up ART services
-    art::ServiceHandle<geo::Geometry> theGeometry;
-    auto const* theDetector = lar::providerFrom<detinfo::DetectorPropertiesService>();
+    if (!settings.m_pPrimaryPandora || !settings.m_pILArPandora)
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
 
     // Loop over ART hits
     int hitCounter(0);
-
-    for (HitVector::const_iterator iter = hitVector.begin(), iterEnd = hitVector.end(); iter != iterEnd; ++iter)
+    hitInstanceList.clear();
+    hitInstanceList.reserve(hitVector.size());
+
+    const std::vector<unsigned int> &hitCryostats(hitSoA.GetCryostats());
+    const std::vector<unsigned int> &hitTpcs(hitSoA.GetTpcs());
+    const std::vector<geo::View_t> &hitViews(hitSoA.GetViews());
+    const std::vector<float> &hitPeakTimes(hitSoA.GetPeakTimes());
+    const std::vector<float> &hitIntegrals(hitSoA.GetIntegrals());
+
+    const std::vector<double> &hitXPositions(hitInputSoA.GetXPositions());
+    const std::vector<double> &hitXWidths(hitInputSoA.GetXWidths());
+    const std::vector<double> &hitWireYs(hitInputSoA.GetWireYs());
+    const std::vector<double> &hitWireZs(hitInputSoA.GetWireZs());
+    const std::vector<double> &hitWireMinZs(hitInputSoA.GetWireMinZs());
+    const std::vector<double> &hitWireMaxZs(hitInputSoA.GetWireMaxZs());
+    const std::vector<double> &hitWirePitches(hitInputSoA.GetWirePitches());
+    const std::vector<double> &hitMips(hitInputSoA.GetMips());
+
+    // Unless the volumes are divided in z or drift time, the pandora instances receiving the hits only need to be found once per tpc
+    const bool isInputRoutedByTpc(settings.m_pILArPandora->IsInputRoutedByTpc());
+    TpcToPandoraInstancesMap tpcToInstancesMap;
+    PandoraInstanceList hitPandoraInstanceList;
+
+    for (size_t index = 0, indexEnd = hitSoA.GetNHits(); index < indexEnd; ++index)
     {
-        const art::Ptr<recob::Hit> hit = *iter;
-        const geo::WireID hit_WireID(hit->WireID());
-        const pandora::Pandora *pPandora(nullptr);
+        const PandoraInstanceList *pPandoraInstanceList(&hitPandoraInstanceList);
 
-        try
+        if (isInputRoutedByTpc)
         {
-            const int volumeID(settings.m_pILArPandora->GetVolumeIdNumber(hit_WireID.Cryostat, hit_WireID.TPC));
-            pPandora = MultiPandoraApi::GetDaughterPandoraInstance(settings.m_pPrimaryPandora, volumeID);
+            const std::pair<unsigned int, unsigned int> tpcKey(hitCryostats[index], hitTpcs[index]);
+            TpcToPandoraInstancesMap::iterator tpcIter(tpcToInstancesMap.find(tpcKey));
+
+            if (tpcToInstancesMap.end() == tpcIter)
+            {
+                tpcIter = tpcToInstancesMap.emplace(tpcKey, PandoraInstanceList()).first;
+                LArPandoraInput::GetPandoraInstances(settings, hitCryostats[index], hitTpcs[index], hitWireMinZs[index],
+                    hitWireMaxZs[index], hitPeakTimes[index], tpcIter->second);
+            }
+
+            pPandoraInstanceList = &(tpcIter->second);
         }
-        catch (pandora::StatusCodeException &)
+        else
         {
+            hitPandoraInstanceList.clear();
+            LArPandoraInput::GetPandoraInstances(settings, hitCryostats[index], hitTpcs[index], hitWireMinZs[index], hitWireMaxZs[index],
+                hitPeakTimes[index], hitPandoraInstanceList);
         }
 
-        if (!pPandora)
-            continue;
-
-        const geo::View_t hit_View(hit->View());
-        const double hit_Time(hit->PeakTime());
-        const double hit_Charge(hit->Integral());
-        const double hit_TimeStart(hit->PeakTimeMinusRMS());
-        const double hit_TimeEnd(hit->PeakTimePlusRMS());
-
-        double xyz[3];
-        theGeometry->Cryostat(hit_WireID.Cryostat).TPC(hit_WireID.TPC).Plane(hit_WireID.Plane).Wire(hit_WireID.Wire).GetCenter(xyz);
-        const double y0_cm(xyz[1]);
-        const double z0_cm(xyz[2]);
+        const PandoraInstanceList &pandoraInstanceList(*pPandoraInstanceList);
 
-        const double wire_pitch_cm(theGeometry->WirePitch(hit_View)); // cm
+        if (pandoraInstanceList.empty())
+            continue;
 
-        const double xpos_cm(theDetector->ConvertTicksToX(hit_Time, hit_WireID.Plane, hit_WireID.TPC, hit_WireID.Cryostat));
-        const double dxpos_cm(std::fabs(theDetector->ConvertTicksToX(hit_TimeEnd, hit_WireID.Plane, hit_WireID.TPC, hit_WireID.Cryostat) -
-	    theDetector->ConvertTicksToX(hit_TimeStart, hit_WireID.Plane, hit_WireID.TPC, hit_WireID.Cryostat)));
+        const geo::View_t hit_View(hitViews[index]);
+        const double hit_Charge(hitIntegrals[index]);
 
-        const double mips(LArPandoraInput::GetMips(settings, hit_Charge, hit_View));
+        const double y0_cm(hitWireYs[index]);
+        const double z0_cm(hitWireZs[index]);
+        const double wire_pitch_cm(hitWirePitches[index]);
+        const double xpos_cm(hitXPositions[index]);
+        const double dxpos_cm(hitXWidths[index]);
+        const double mips(hitMips[index]);
 
         // Create Pandora CaloHit
         PandoraApi::CaloHit::Parameters caloHitParameters;
@@ -109,31 +166,6 @@ void LArPandoraInput::CreatePandoraHits2D(const Settings &settings, const HitVec
         caloHitParameters.m_mipEquivalentEnergy = mips;
         caloHitParameters.m_electromagneticEnergy = mips * settings.m_mips_to_gev;
         caloHitParameters.m_hadronicEnergy = mips * settings.m_mips_to_gev;
-        caloHitParameters.m_pParentAddress = (void*)((intptr_t)(++hitCounter));
-
-        if (hit_View == geo::kW)
-        {
-            caloHitParameters.m_hitType = pandora::TPC_VIEW_W;
-            const double wpos_cm(z0_cm);
-            caloHitParameters.m_positionVector = pandora::CartesianVector(xpos_cm, 0., wpos_cm);
-        }
-        else if(hit_View == geo::kU)
-        {
-            caloHitParameters.m_hitType = pandora::TPC_VIEW_U;
-            const double upos_cm(lar_content::LArGeometryHelper::GetLArTransformationPlugin(*pPandora)->YZtoU(y0_cm, z0_cm));
-            caloHitParameters.m_positionVector = pandora::CartesianVector(xpos_cm, 0., upos_cm);
-        }
-        else if(hit_View == geo::kV)
-        {
-            caloHitParameters.m_hitType = pandora::TPC_VIEW_V;
-            const double vpos_cm(lar_content::LArGeometryHelper::GetLArTransformationPlugin(*pPandora)->YZtoV(y0_cm, z0_cm));
-            caloHitParameters.m_positionVector = pandora::CartesianVector(xpos_cm, 0., vpos_cm);
-        }
-        else
-        {
-            mf::LogError("LArPandora") << " --- WARNING: UNKNOWN VIEW !!!  (View=" << hit_View << ")" << std::endl;
-            throw pandora::StatusCodeException(pandora::STATUS_CODE_FAILURE);
-        } 
 
         // Check for unphysical pulse heights
         if (std::isnan(mips))
@@ -142,17 +174,92 @@ void LArPandoraInput::CreatePandoraHits2D(const Settings &settings, const HitVec
             throw pandora::StatusCodeException(pandora::STATUS_CODE_FAILURE);
         }
 
-        // Store the hit address
-        if (hitCounter >= settings.m_uidOffset)
+        // Hits in the overlap between neighbouring volumes are passed to each of the corresponding pandora instances, with a unique id each
+        for (const pandora::Pandora *const pPandora : pandoraInstanceList)
         {
-            mf::LogError("LArPandora") << " --- WARNING: TOO MANY HITS !!! (hitCounter=" << hitCounter << ")" << std::endl;
-            throw pandora::StatusCodeException(pandora::STATUS_CODE_FAILURE);
+            caloHitParameters.m_pParentAddress = (void*)((intptr_t)(++hitCounter));
+
+            if (hit_View == geo::kW)
+            {
+                caloHitParameters.m_hitType = pandora::TPC_VIEW_W;
+                const double wpos_cm(z0_cm);
+                caloHitParameters.m_positionVector = pandora::CartesianVector(xpos_cm, 0., wpos_cm);
+            }
+            else if(hit_View == geo::kU)
+            {
+                caloHitParameters.m_hitType = pandora::TPC_VIEW_U;
+                const double upos_cm(lar_content::LArGeometryHelper::GetLArTransformationPlugin(*pPandora)->YZtoU(y0_cm, z0_cm));
+                caloHitParameters.m_positionVector = pandora::CartesianVector(xpos_cm, 0., upos_cm);
+            }
+            else if(hit_View == geo::kV)
+            {
+                caloHitParameters.m_hitType = pandora::TPC_VIEW_V;
+                const double vpos_cm(lar_content::LArGeometryHelper::GetLArTransformationPlugin(*pPandora)->YZtoV(y0_cm, z0_cm));
+                caloHitParameters.m_positionVector = pandora::CartesianVector(xpos_cm, 0., vpos_cm);
+            }
+            else
+            {
+                mf::LogError("LArPandora") << " --- WARNING: UNKNOWN VIEW !!!  (View=" << hit_View << ")" << std::endl;
+                throw pandora::StatusCodeException(pandora::STATUS_CODE_FAILURE);
+            } 
+
+            // Store the hit address
+            if (hitCounter >= settings.m_uidOffset)
+            {
+                mf::LogError("LArPandora") << " --- WARNING: TOO MANY HITS !!! (hitCounter=" << hitCounter << ")" << std::endl;
+                throw pandora::StatusCodeException(pandora::STATUS_CODE_FAILURE);
+            }
+
+            idToHitMap[hitCounter] = hitVector[index];
+
+            // Create the Pandora hit
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::CaloHit::Create(*pPandora, caloHitParameters));
+            ++hitCountMap[pPandora];
+            hitInstanceList.push_back(pPandora);
         }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraInput::FillHitInputs(const Settings &settings, const HitSoA &hitSoA, HitInputSoA &hitInputSoA)
+{
+    // Set up ART services
+    art::ServiceHandle<geo::Geometry> theGeometry;
+    auto const* theDetector = lar::providerFrom<detinfo::DetectorPropertiesService>();
+
+    const std::vector<geo::View_t> &hitViews(hitSoA.GetViews());
+    const std::vector<float> &hitPeakTimes(hitSoA.GetPeakTimes());
+    const std::vector<float> &hitIntegrals(hitSoA.GetIntegrals());
+
+    hitInputSoA.Reserve(hitSoA.GetNHits());
+
+    for (size_t index = 0, indexEnd = hitSoA.GetNHits(); index < indexEnd; ++index)
+    {
+        const geo::WireID hit_WireID(hitSoA.GetWireID(index));
+        const geo::View_t hit_View(hitViews[index]);
+        const double hit_Time(hitPeakTimes[index]);
+        const double hit_Charge(hitIntegrals[index]);
+        const double hit_TimeStart(hitSoA.GetPeakTimeMinusRMS(index));
+        const double hit_TimeEnd(hitSoA.GetPeakTimePlusRMS(index));
+
+        const geo::WireGeo &wire(theGeometry->Cryostat(hit_WireID.Cryostat).TPC(hit_WireID.TPC).Plane(hit_WireID.Plane).Wire(hit_WireID.Wire));
 
-        idToHitMap[hitCounter] = hit;
+        double xyz[3], startXYZ[3], endXYZ[3];
+        wire.GetCenter(xyz);
+        wire.GetStart(startXYZ);
+        wire.GetEnd(endXYZ);
 
-        // Create the Pandora hit
-        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::CaloHit::Create(*pPandora, caloHitParameters));
+        const double wire_pitch_cm(theGeometry->WirePitch(hit_View)); // cm
+
+        const double xpos_cm(theDetector->ConvertTicksToX(hit_Time, hit_WireID.Plane, hit_WireID.TPC, hit_WireID.Cryostat));
+        const double dxpos_cm(std::fabs(theDetector->ConvertTicksToX(hit_TimeEnd, hit_WireID.Plane, hit_WireID.TPC, hit_WireID.Cryostat) -
+            theDetector->ConvertTicksToX(hit_TimeStart, hit_WireID.Plane, hit_WireID.TPC, hit_WireID.Cryostat)));
+
+        const double mips(LArPandoraInput::GetMips(settings, hit_Charge, hit_View));
+
+        hitInputSoA.AddHit(xpos_cm, dxpos_cm, xyz[1], xyz[2], std::min(startXYZ[2], endXYZ[2]), std::max(startXYZ[2], endXYZ[2]),
+            wire_pitch_cm, mips);
     }
 }
 
@@ -186,18 +293,12 @@ void LArPandoraInput::CreatePandoraHits3D(const Settings &settings, const SpaceP
             throw pandora::StatusCodeException(pandora::STATUS_CODE_FAILURE);
 
         const art::Ptr<recob::Hit> hit = iter2->second;
-        const pandora::Pandora *pPandora(nullptr);
 
-        try
-        {
-            const int volumeID(settings.m_pILArPandora->GetVolumeIdNumber(hit->WireID().Cryostat, hit->WireID().TPC));
-            pPandora = MultiPandoraApi::GetDaughterPandoraInstance(settings.m_pPrimaryPandora, volumeID);
-        }
-        catch (pandora::StatusCodeException &)
-        {
-        }
+        PandoraInstanceList pandoraInstanceList;
+        LArPandoraInput::GetPandoraInstances(settings, hit->WireID().Cryostat, hit->WireID().TPC, zpos_cm, zpos_cm, hit->PeakTime(),
+            pandoraInstanceList);
 
-        if (!pPandora)
+        if (pandoraInstanceList.empty())
             continue;
 
         const geo::View_t hit_View(hit->View());
@@ -226,7 +327,6 @@ void LArPandoraInput::CreatePandoraHits3D(const Settings &settings, const SpaceP
         caloHitParameters.m_mipEquivalentEnergy = mips;
         caloHitParameters.m_electromagneticEnergy = mips * settings.m_mips_to_gev;
         caloHitParameters.m_hadronicEnergy = mips * settings.m_mips_to_gev;
-        caloHitParameters.m_pParentAddress = (void*)((intptr_t)(++spacePointCounter));
 
         // Check for unphysical pulse heights
         if (std::isnan(mips))
@@ -235,17 +335,29 @@ void LArPandoraInput::CreatePandoraHits3D(const Settings &settings, const SpaceP
             throw pandora::StatusCodeException(pandora::STATUS_CODE_FAILURE);
         }
 
-        // Store the hit address
-        spacePointMap[spacePointCounter] = spacepoint;
+        for (const pandora::Pandora *const pPandora : pandoraInstanceList)
+        {
+            caloHitParameters.m_pParentAddress = (void*)((intptr_t)(++spacePointCounter));
+
+            // Store the hit address
+            spacePointMap[spacePointCounter] = spacepoint;
 
-        // Create the Pandora hit
-        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::CaloHit::Create(*pPandora, caloHitParameters));
+            // Create the Pandora hit
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::CaloHit::Create(*pPandora, caloHitParameters));
+        }
     } 
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
 void LArPandoraInput::CreatePandoraLineGaps(const Settings &settings)
+{
+    LArPandoraInput::CreatePandoraLineGaps(settings, nullptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraInput::CreatePandoraLineGaps(const Settings &settings, const pandora::Pandora *const pTargetPandora)
 {
     mf::LogDebug("LArPandora") << " *** LArPandoraInput::CreatePandoraLineGaps(...) *** " << std::endl;
 
@@ -260,82 +372,80 @@ void LArPandoraInput::CreatePandoraLineGaps(const Settings &settings)
         for (unsigned int itpc = 0; itpc < theGeometry->NTPC(icstat); ++itpc)
         {
             const geo::TPCGeo &TPC(theGeometry->TPC(itpc));
-            const pandora::Pandora *pPandora(nullptr);
 
-            try
-            {
-                const int volumeID(settings.m_pILArPandora->GetVolumeIdNumber(icstat, itpc));
-                pPandora = MultiPandoraApi::GetDaughterPandoraInstance(settings.m_pPrimaryPandora, volumeID);
-            }
-            catch (pandora::StatusCodeException &)
-            {
-            }
-
-            if (!pPandora)
-                continue;
+            // A tpc may be split between several volumes (in z or in drift time), each of which receives all of its line gaps
+            PandoraInstanceList pandoraInstanceList;
+            LArPandoraInput::GetPandoraInstances(settings, icstat, itpc, -std::numeric_limits<double>::max(), std::numeric_limits<double>::max(),
+                pandoraInstanceList);
 
-            for (unsigned int iplane = 0; iplane < TPC.Nplanes(); ++iplane)
+            for (const pandora::Pandora *const pPandora : pandoraInstanceList)
             {
-                const geo::PlaneGeo &plane(TPC.Plane(iplane));
-                const float halfWirePitch(0.5f * theGeometry->WirePitch(plane.View()));
-                const unsigned int nWires(theGeometry->Nwires(geo::PlaneID(icstat, itpc, plane.View())));
-
-                int firstBadWire(-1), lastBadWire(-1);
+                if (pTargetPandora && (pTargetPandora != pPandora))
+                    continue;
 
-                for (unsigned int iwire = 0; iwire < nWires; ++iwire)
+                for (unsigned int iplane = 0; iplane < TPC.Nplanes(); ++iplane)
                 {
-                    const raw::ChannelID_t channel(theGeometry->PlaneWireToChannel(plane.View(), iwire, itpc, icstat));
-                    const bool isBadChannel(channelStatus.IsBad(channel));
-                    const bool isLastWire(nWires == (iwire + 1));
-
-                    if (isBadChannel && (firstBadWire < 0))
-                        firstBadWire = iwire;
+                    const geo::PlaneGeo &plane(TPC.Plane(iplane));
+                    const float halfWirePitch(0.5f * theGeometry->WirePitch(plane.View()));
+                    const unsigned int nWires(theGeometry->Nwires(geo::PlaneID(icstat, itpc, plane.View())));
 
-                    if (isBadChannel || isLastWire)
-                        lastBadWire = iwire;
+                    int firstBadWire(-1), lastBadWire(-1);
 
-                    if (isBadChannel && !isLastWire)
-                        continue;
-
-                    if ((firstBadWire < 0) || (lastBadWire < 0))
-                        continue;
-
-                    double firstXYZ[3], lastXYZ[3];
-                    theGeometry->Cryostat(icstat).TPC(itpc).Plane(iplane).Wire(firstBadWire).GetCenter(firstXYZ);
-                    theGeometry->Cryostat(icstat).TPC(itpc).Plane(iplane).Wire(lastBadWire).GetCenter(lastXYZ);
-
-                    PandoraApi::Geometry::LineGap::Parameters parameters;
-
-                    if (iplane == geo::kW)
+                    for (unsigned int iwire = 0; iwire < nWires; ++iwire)
                     {
-                        const float firstW(firstXYZ[2]);
-                        const float lastW(lastXYZ[2]);
-
-                        parameters.m_hitType = pandora::TPC_VIEW_W;
-                        parameters.m_lineStartZ = std::min(firstW, lastW) - halfWirePitch;
-                        parameters.m_lineEndZ = std::max(firstW, lastW) + halfWirePitch;
+                        const raw::ChannelID_t channel(theGeometry->PlaneWireToChannel(plane.View(), iwire, itpc, icstat));
+                        const bool isBadChannel(channelStatus.IsBad(channel));
+                        const bool isLastWire(nWires == (iwire + 1));
+
+                        if (isBadChannel && (firstBadWire < 0))
+                            firstBadWire = iwire;
+
+                        if (isBadChannel || isLastWire)
+                            lastBadWire = iwire;
+
+                        if (isBadChannel && !isLastWire)
+                            continue;
+
+                        if ((firstBadWire < 0) || (lastBadWire < 0))
+                            continue;
+
+                        double firstXYZ[3], lastXYZ[3];
+                        theGeometry->Cryostat(icstat).TPC(itpc).Plane(iplane).Wire(firstBadWire).GetCenter(firstXYZ);
+                        theGeometry->Cryostat(icstat).TPC(itpc).Plane(iplane).Wire(lastBadWire).GetCenter(lastXYZ);
+
+                        PandoraApi::Geometry::LineGap::Parameters parameters;
+
+                        if (iplane == geo::kW)
+                        {
+                            const float firstW(firstXYZ[2]);
+                            const float lastW(lastXYZ[2]);
+
+                            parameters.m_hitType = pandora::TPC_VIEW_W;
+                            parameters.m_lineStartZ = std::min(firstW, lastW) - halfWirePitch;
+                            parameters.m_lineEndZ = std::max(firstW, lastW) + halfWirePitch;
+                        }
+                        else if (iplane == geo::kU)
+                        {
+                            const float firstU(lar_content::LArGeometryHelper::GetLArTransformationPlugin(*pPandora)->YZtoU(firstXYZ[1], firstXYZ[2]));
+                            const float lastU(lar_content::LArGeometryHelper::GetLArTransformationPlugin(*pPandora)->YZtoU(lastXYZ[1], lastXYZ[2]));
+
+                            parameters.m_hitType = pandora::TPC_VIEW_U;
+                            parameters.m_lineStartZ = std::min(firstU, lastU) - halfWirePitch;
+                            parameters.m_lineEndZ = std::max(firstU, lastU) + halfWirePitch;
+                        }
+                        else if (iplane == geo::kV)
+                        {
+                            const float firstV(lar_content::LArGeometryHelper::GetLArTransformationPlugin(*pPandora)->YZtoV(firstXYZ[1], firstXYZ[2]));
+                            const float lastV(lar_content::LArGeometryHelper::GetLArTransformationPlugin(*pPandora)->YZtoV(lastXYZ[1], lastXYZ[2]));
+
+                            parameters.m_hitType = pandora::TPC_VIEW_V;
+                            parameters.m_lineStartZ = std::min(firstV, lastV) - halfWirePitch;
+                            parameters.m_lineEndZ = std::max(firstV, lastV) + halfWirePitch;
+                        }
+
+                        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::Geometry::LineGap::Create(*pPandora, parameters));
+                        firstBadWire = -1; lastBadWire = -1;
                     }
-                    else if (iplane == geo::kU)
-                    {
-                        const float firstU(lar_content::LArGeometryHelper::GetLArTransformationPlugin(*pPandora)->YZtoU(firstXYZ[1], firstXYZ[2]));
-                        const float lastU(lar_content::LArGeometryHelper::GetLArTransformationPlugin(*pPandora)->YZtoU(lastXYZ[1], lastXYZ[2]));
-
-                        parameters.m_hitType = pandora::TPC_VIEW_U;
-                        parameters.m_lineStartZ = std::min(firstU, lastU) - halfWirePitch;
-                        parameters.m_lineEndZ = std::max(firstU, lastU) + halfWirePitch;
-                    }
-                    else if (iplane == geo::kV)
-                    {
-                        const float firstV(lar_content::LArGeometryHelper::GetLArTransformationPlugin(*pPandora)->YZtoV(firstXYZ[1], firstXYZ[2]));
-                        const float lastV(lar_content::LArGeometryHelper::GetLArTransformationPlugin(*pPandora)->YZtoV(lastXYZ[1], lastXYZ[2]));
-
-                        parameters.m_hitType = pandora::TPC_VIEW_V;
-                        parameters.m_lineStartZ = std::min(firstV, lastV) - halfWirePitch;
-                        parameters.m_lineEndZ = std::max(firstV, lastV) + halfWirePitch;
-                    }
-
-                    PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::Geometry::LineGap::Create(*pPandora, parameters));
-                    firstBadWire = -1; lastBadWire = -1;
                 }
             }
         }
@@ -613,20 +723,61 @@ void LArPandoraInput::CreatePandoraMCLinks2D(const Settings &settings, const IdT
     {        
         const int hitID(iterI->first);
         const art::Ptr<recob::Hit> hit(iterI->second);
-        const geo::WireID hit_WireID(hit->WireID());
-        const pandora::Pandora *pPandora(nullptr);
 
-        try
-        {
-            const int volumeID(settings.m_pILArPandora->GetVolumeIdNumber(hit_WireID.Cryostat, hit_WireID.TPC));
-            pPandora = MultiPandoraApi::GetDaughterPandoraInstance(settings.m_pPrimaryPandora, volumeID);
-        }
-        catch (pandora::StatusCodeException &)
+        // ATTN A hit passed to several pandora instances has a different id in each; links to an absent hit id are ignored by pandora
+        PandoraInstanceList pandoraInstanceList;
+        LArPandoraInput::GetPandoraInstances(settings, hit->WireID(), hit->PeakTime(), pandoraInstanceList);
+
+        if (pandoraInstanceList.empty())
+            continue;
+
+        // Get list of associated MC particles
+        HitsToTrackIDEs::const_iterator iterJ = hitToParticleMap.find(hit);
+
+        if (hitToParticleMap.end() == iterJ)
+            continue;
+
+        const TrackIDEVector &trackCollection = iterJ->second;
+
+        if (trackCollection.size() == 0)
+            throw pandora::StatusCodeException(pandora::STATUS_CODE_FAILURE);
+
+        // Create links between hits and MC particles
+        for (unsigned int k = 0; k < trackCollection.size(); ++k)
         {
+            const sim::TrackIDE trackIDE(trackCollection.at(k));
+            const int trackID(std::abs(trackIDE.trackID)); // TODO: Find out why std::abs is needed
+            const float energyFrac(trackIDE.energyFrac);
+
+            for (const pandora::Pandora *const pPandora : pandoraInstanceList)
+            {
+                PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::SetCaloHitToMCParticleRelationship(*pPandora,
+                    (void*)((intptr_t)hitID), (void*)((intptr_t)trackID), energyFrac));
+            }
         }
+    }
+}
 
-        if (!pPandora)
-            continue;
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraInput::CreatePandoraMCLinks2D(const Settings &settings, const IdToHitMap &idToHitMap, const PandoraInstanceList &hitInstanceList,
+    const HitsToTrackIDEs &hitToParticleMap)
+{
+    mf::LogDebug("LArPandora") << " *** LArPandoraInput::CreatePandoraMCLinks(...) *** " << std::endl;
+
+    if (idToHitMap.size() != hitInstanceList.size())
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
+
+    for (IdToHitMap::const_iterator iterI = idToHitMap.begin(), iterEndI = idToHitMap.end(); iterI != iterEndI ; ++iterI)
+    {
+        const int hitID(iterI->first);
+        const art::Ptr<recob::Hit> hit(iterI->second);
+
+        // Set the links in the pandora instance that received this hit id, rather than routing the hit again
+        if ((hitID < 1) || (static_cast<size_t>(hitID) > hitInstanceList.size()))
+            throw pandora::StatusCodeException(pandora::STATUS_CODE_FAILURE);
+
+        const pandora::Pandora *const pPandora(hitInstanceList[hitID - 1]);
 
         // Get list of associated MC particles
         HitsToTrackIDEs::const_iterator iterJ = hitToParticleMap.find(hit);
@@ -669,7 +820,11 @@ void LArPandoraInput::GetTrueStartAndEndPoints(const Settings &settings, const i
         {
             try
             {
-                if (settings.m_pILArPandora->GetVolumeIdNumber(icstat, itpc) != volumeID)
+                std::vector<int> volumeIdNumbers;
+                settings.m_pILArPandora->GetVolumeIdNumbers(icstat, itpc, -std::numeric_limits<double>::max(),
+                    std::numeric_limits<double>::max(), volumeIdNumbers);
+
+                if (volumeIdNumbers.end() == std::find(volumeIdNumbers.begin(), volumeIdNumbers.end(), volumeID))
                     continue;
 
                 int thisfirstT(-1), thislastT(-1);
@@ -763,6 +918,78 @@ double LArPandoraInput::GetMips(const Settings &settings, const double hit_Charg
     return mips;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraInput::GetPandoraInstances(const Settings &settings, const geo::WireID &wireID, const double time,
+    PandoraInstanceList &pandoraInstanceList)
+{
+    art::ServiceHandle<geo::Geometry> theGeometry;
+    const geo::WireGeo &wire(theGeometry->Cryostat(wireID.Cryostat).TPC(wireID.TPC).Plane(wireID.Plane).Wire(wireID.Wire));
+
+    double startXYZ[3], endXYZ[3];
+    wire.GetStart(startXYZ);
+    wire.GetEnd(endXYZ);
+
+    LArPandoraInput::GetPandoraInstances(settings, wireID.Cryostat, wireID.TPC, std::min(startXYZ[2], endXYZ[2]), std::max(startXYZ[2], endXYZ[2]),
+        time, pandoraInstanceList);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraInput::GetPandoraInstances(const Settings &settings, const unsigned int cryostat, const unsigned int tpc, const double minZ,
+    const double maxZ, const double time, PandoraInstanceList &pandoraInstanceList)
+{
+    std::vector<int> volumeIdNumbers;
+
+    try
+    {
+        settings.m_pILArPandora->GetVolumeIdNumbers(cryostat, tpc, minZ, maxZ, time, volumeIdNumbers);
+    }
+    catch (pandora::StatusCodeException &)
+    {
+    }
+
+    LArPandoraInput::GetDaughterPandoraInstances(settings, volumeIdNumbers, pandoraInstanceList);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraInput::GetPandoraInstances(const Settings &settings, const unsigned int cryostat, const unsigned int tpc, const double minZ,
+    const double maxZ, PandoraInstanceList &pandoraInstanceList)
+{
+    std::vector<int> volumeIdNumbers;
+
+    try
+    {
+        settings.m_pILArPandora->GetVolumeIdNumbers(cryostat, tpc, minZ, maxZ, volumeIdNumbers);
+    }
+    catch (pandora::StatusCodeException &)
+    {
+    }
+
+    LArPandoraInput::GetDaughterPandoraInstances(settings, volumeIdNumbers, pandoraInstanceList);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraInput::GetDaughterPandoraInstances(const Settings &settings, const std::vector<int> &volumeIdNumbers,
+    PandoraInstanceList &pandoraInstanceList)
+{
+    for (const int volumeID : volumeIdNumbers)
+    {
+        try
+        {
+            const pandora::Pandora *const pPandora(MultiPandoraApi::GetDaughterPandoraInstance(settings.m_pPrimaryPandora, volumeID));
+
+            if (pPandora)
+                pandoraInstanceList.push_back(pPandora);
+        }
+        catch (pandora::StatusCodeException &)
+        {
+        }
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 //------------------------------------------------------------------------------------------------------------------------------------------
 
@@ -9,10 +9,15 @@
 
 #include "larpandora/LArPandoraInterface/ILArPandora.h"
 #include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
+#include "larpandora/LArPandoraInterface/LArPandoraHitSoA.h"
+
+#include "larpandoracontent/LArStitching/MultiPandoraApi.h"
 
 namespace lar_pandora
 {
 
+class HitInputSoA;
+
 /**
  *  @brief  LArPandoraInput class
  */
@@ -52,6 +57,51 @@ public:
      */
     static void CreatePandoraHits2D(const Settings &settings, const HitVector &hitVector, IdToHitMap &idToHitMap);
 
+    /**
+     *  @brief  Create the Pandora 2D hits from the ART hits, reading hit properties from a snapshot of the hit vector
+     *
+     *  @param  settings the settings
+     *  @param  hits the input list of ART hits for this event
+     *  @param  hitSoA the structure-of-arrays snapshot of the input hits
+     *  @param  idToHitMap to receive the mapping from Pandora hit ID to ART hit
+     */
+    static void CreatePandoraHits2D(const Settings &settings, const HitVector &hitVector, const HitSoA &hitSoA, IdToHitMap &idToHitMap);
+
+    /**
+     *  @brief  Create the Pandora 2D hits from the ART hits, also counting the hits passed to each pandora instance
+     *
+     *  @param  settings the settings
+     *  @param  hits the input list of ART hits for this event
+     *  @param  hitSoA the structure-of-arrays snapshot of the input hits
+     *  @param  idToHitMap to receive the mapping from Pandora hit ID to ART hit
+     *  @param  hitCountMap to receive the number of hits passed to each pandora instance
+     */
+    static void CreatePandoraHits2D(const Settings &settings, const HitVector &hitVector, const HitSoA &hitSoA, IdToHitMap &idToHitMap,
+        PandoraInstanceHitCountMap &hitCountMap);
+
+    /**
+     *  @brief  Create the Pandora 2D hits from the ART hits, using their previously evaluated geometry and calibration
+     *
+     *  @param  settings the settings
+     *  @param  hits the input list of ART hits for this event
+     *  @param  hitSoA the structure-of-arrays snapshot of the input hits
+     *  @param  hitInputSoA the geometry and calibration of the input hits
+     *  @param  idToHitMap to receive the mapping from Pandora hit ID to ART hit
+     *  @param  hitCountMap to receive the number of hits passed to each pandora instance
+     *  @param  hitInstanceList to receive the pandora instance holding each Pandora hit, indexed by Pandora hit ID - 1
+     */
+    static void CreatePandoraHits2D(const Settings &settings, const HitVector &hitVector, const HitSoA &hitSoA, const HitInputSoA &hitInputSoA,
+        IdToHitMap &idToHitMap, PandoraInstanceHitCountMap &hitCountMap, PandoraInstanceList &hitInstanceList);
+
+    /**
+     *  @brief  Evaluate the geometry and calibration of the ART hits, which are independent of the pandora instances receiving the hits
+     *
+     *  @param  settings the settings
+     *  @param  hitSoA the structure-of-arrays snapshot of the input hits
+     *  @param  hitInputSoA to receive the geometry and calibration of the input hits
+     */
+    static void FillHitInputs(const Settings &settings, const HitSoA &hitSoA, HitInputSoA &hitInputSoA);
+
     /**
      *  @brief  Create the Pandora 3D hits from the ART space points
      *
@@ -70,6 +120,14 @@ public:
      */
     static void CreatePandoraLineGaps(const Settings &settings);
 
+    /**
+     *  @brief  Create pandora line gaps to cover any (continuous regions of) bad channels, for a single pandora instance
+     *
+     *  @param  settings the settings
+     *  @param  pTargetPandora the address of the pandora instance to receive the line gaps, or nullptr for all instances
+     */
+    static void CreatePandoraLineGaps(const Settings &settings, const pandora::Pandora *const pTargetPandora);
+
     /**
      *  @brief  Create the Pandora MC particles from the MC particles
      *
@@ -92,12 +150,25 @@ public:
      *  @brief  Create links between the 2D hits and Pandora MC particles
      *
      *  @param  settings the settings
-     *  @param  hitMap mapping from Pandora hit addresses to ART hits
+     *  @param  idToHitMap mapping from Pandora hit addresses to ART hits
      *  @param  hitToParticleMap mapping from each ART hit to its underlying G4 track ID
      */
-    static void CreatePandoraMCLinks2D(const Settings &settings, const HitMap &hitMap, const HitsToTrackIDEs &hitToParticleMap);
+    static void CreatePandoraMCLinks2D(const Settings &settings, const IdToHitMap &idToHitMap, const HitsToTrackIDEs &hitToParticleMap);
+
+    /**
+     *  @brief  Create links between the 2D hits and Pandora MC particles, in the pandora instances that received the hits
+     *
+     *  @param  settings the settings
+     *  @param  idToHitMap mapping from Pandora hit addresses to ART hits
+     *  @param  hitInstanceList the pandora instance holding each Pandora hit, indexed by Pandora hit ID - 1
+     *  @param  hitToParticleMap mapping from each ART hit to its underlying G4 track ID
+     */
+    static void CreatePandoraMCLinks2D(const Settings &settings, const IdToHitMap &idToHitMap, const PandoraInstanceList &hitInstanceList,
+        const HitsToTrackIDEs &hitToParticleMap);
 
 private:
+    typedef std::map< std::pair<unsigned int, unsigned int>, PandoraInstanceList > TpcToPandoraInstancesMap;
+
     /**
      *  @brief  Loop over MC trajectory points and identify start and end points within the detector
      *
@@ -130,6 +201,55 @@ private:
      */
     static float GetTrueX0(const art::Ptr<simb::MCParticle> &particle, const int nT);
 
+    /**
+     *  @brief  Get the pandora instances receiving the hits on a given wire at a given drift time, according to the z extent of the wire
+     *
+     *  @param  settings the settings
+     *  @param  wireID the wire id
+     *  @param  time the drift time [ticks]
+     *  @param  pandoraInstanceList to receive the addresses of the pandora instances
+     */
+    static void GetPandoraInstances(const Settings &settings, const geo::WireID &wireID, const double time, PandoraInstanceList &pandoraInstanceList);
+
+    /**
+     *  @brief  Get the pandora instances receiving the input from a given cryostat and tpc, within a range of z coordinates and at a
+     *          given drift time
+     *
+     *  @param  settings the settings
+     *  @param  cryostat the cryostat number
+     *  @param  tpc the tpc number
+     *  @param  minZ the minimum z coordinate
+     *  @param  maxZ the maximum z coordinate
+     *  @param  time the drift time [ticks]
+     *  @param  pandoraInstanceList to receive the addresses of the pandora instances
+     */
+    static void GetPandoraInstances(const Settings &settings, const unsigned int cryostat, const unsigned int tpc, const double minZ,
+        const double maxZ, const double time, PandoraInstanceList &pandoraInstanceList);
+
+    /**
+     *  @brief  Get the pandora instances receiving the input from a given cryostat and tpc, within a range of z coordinates and at any
+     *          drift time
+     *
+     *  @param  settings the settings
+     *  @param  cryostat the cryostat number
+     *  @param  tpc the tpc number
+     *  @param  minZ the minimum z coordinate
+     *  @param  maxZ the maximum z coordinate
+     *  @param  pandoraInstanceList to receive the addresses of the pandora instances
+     */
+    static void GetPandoraInstances(const Settings &settings, const unsigned int cryostat, const unsigned int tpc, const double minZ,
+        const double maxZ, PandoraInstanceList &pandoraInstanceList);
+
+    /**
+     *  @brief  Get the existing daughter pandora instances for a list of volume id numbers
+     *
+     *  @param  settings the settings
+     *  @param  volumeIdNumbers the volume id numbers
+     *  @param  pandoraInstanceList to receive the addresses of the pandora instances
+     */
+    static void GetDaughterPandoraInstances(const Settings &settings, const std::vector<int> &volumeIdNumbers,
+        PandoraInstanceList &pandoraInstanceList);
+
     /**
      *  @brief  Convert charge in ADCs to approximate MIPs
      *
@@ -94,6 +94,9 @@ void LArPandoraOutput::ProduceArtOutput(const Settings &settings, const IdToHitM
     std::unique_ptr< art::Assns<recob::Cluster, recob::Hit> >           outputClustersToHits( new art::Assns<recob::Cluster, recob::Hit> );
     std::unique_ptr< art::Assns<recob::Seed, recob::Hit> >              outputSeedsToHits( new art::Assns<recob::Seed, recob::Hit> );
 
+    // Snapshot the hit properties once per event, for the cluster building
+    const OutputHits outputHits(idToHitMap);
+
     // prepare the algorithm to compute the cluster characteristics;
     // we use the "standard" one here; configuration would happen here,
     // but we are using the default configuration for that algorithm
@@ -229,58 +232,27 @@ void LArPandoraOutput::ProduceArtOutput(const Settings &settings, const IdToHitM
         }
 
         // Build 2D Clusters   
-        pandora::ClusterVector pandoraClusterVector(pPfo->GetClusterList().begin(), pPfo->GetClusterList().end());
-        std::sort(pandoraClusterVector.begin(), pandoraClusterVector.end(), lar_content::LArClusterHelper::SortByNHits);
         int iClusterCounter = clusterCounter;
         size_t iClusterHitAssnCounter = clusterHitAssnCounter;
 
-        for (const pandora::Cluster *const pCluster : pandoraClusterVector)
-        {
-            if (pandora::TPC_3D == lar_content::LArClusterHelper::GetClusterHitType(pCluster))
-                continue;
-
-            pandora::CaloHitList pandoraHitList2D;
-            pCluster->GetOrderedCaloHitList().FillCaloHitList(pandoraHitList2D);
-            pandoraHitList2D.insert(pandoraHitList2D.end(), pCluster->GetIsolatedCaloHitList().begin(), pCluster->GetIsolatedCaloHitList().end());
-
-            pandora::CaloHitVector pandoraHitVector2D(pandoraHitList2D.begin(), pandoraHitList2D.end());
-            std::sort(pandoraHitVector2D.begin(), pandoraHitVector2D.end(), lar_content::LArClusterHelper::SortHitsByPosition);
-
-            HitArray  hitArray;      // sort hits by drift volume
-            HitList   isolatedHits;  // select isolated hits
-
-            for (const pandora::CaloHit *const pCaloHit2D : pandoraHitVector2D)
-            {
-                const art::Ptr<recob::Hit> hit = LArPandoraOutput::GetHit(idToHitMap, pCaloHit2D);
-
-                const geo::WireID wireID(hit->WireID());
-                const unsigned int volID(100000 * wireID.Cryostat + wireID.TPC);
-
-                hitArray[volID].push_back(hit);
-
-                if (pCaloHit2D->IsIsolated())
-                    isolatedHits.insert(hit);
-            }
-
-            if (hitArray.empty())
-                throw pandora::StatusCodeException(pandora::STATUS_CODE_FAILURE);
-
-            for (const HitArray::value_type &hitArrayEntry : hitArray)
-            {
-                const HitVector &clusterHits(hitArrayEntry.second);
-                outputClusters->emplace_back(LArPandoraOutput::BuildCluster(clusterCounter++, clusterHits, isolatedHits, ClusterParamAlgo)); 
-                clusterHitAssnCounter += clusterHits.size();
-                
-                util::CreateAssn(*(settings.m_pProducer), evt, *(outputClusters.get()), clusterHits, *(outputClustersToHits.get()));
-                util::CreateAssn(*(settings.m_pProducer), evt, *(outputParticles.get()), *(outputClusters.get()), *(outputParticlesToClusters.get()),
-                    outputClusters->size() - 1, outputClusters->size());
-                
-                LOG_DEBUG("LArPandora") << "Stored cluster ID="
-                  << outputClusters->back().ID()
-                  << " (#" << (outputClusters->size() - 1)
-                  << ") with " << clusterHits.size() << " hits";
+        std::vector<recob::Cluster> pfoClusters;
+        std::vector<HitVector> pfoClusterHits;
+        LArPandoraOutput::BuildClusters(outputHits, pPfo->GetClusterList(), ClusterParamAlgo, clusterCounter, pfoClusters, pfoClusterHits);
 
-            }
+        for (size_t iCluster = 0; iCluster < pfoClusters.size(); ++iCluster)
+        {
+            const HitVector &clusterHits(pfoClusterHits[iCluster]);
+            outputClusters->push_back(std::move(pfoClusters[iCluster]));
+            clusterHitAssnCounter += clusterHits.size();
+
+            util::CreateAssn(*(settings.m_pProducer), evt, *(outputClusters.get()), clusterHits, *(outputClustersToHits.get()));
+            util::CreateAssn(*(settings.m_pProducer), evt, *(outputParticles.get()), *(outputClusters.get()), *(outputParticlesToClusters.get()),
+                outputClusters->size() - 1, outputClusters->size());
+
+            LOG_DEBUG("LArPandora") << "Stored cluster ID="
+              << outputClusters->back().ID()
+              << " (#" << (outputClusters->size() - 1)
+              << ") with " << clusterHits.size() << " hits";
         }
 
         // Associate Vertex and Build Seeds (and Tracks)
@@ -508,12 +480,156 @@ void LArPandoraOutput::ProduceArtOutput(const Settings &settings, const IdToHitM
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
- 
+
+void LArPandoraOutput::ProduceTwoDArtOutput(const Settings &settings, const IdToHitMap &idToHitMap, const PandoraInstanceList &pandoraInstanceList,
+    art::Event &evt)
+{
+    mf::LogDebug("LArPandora") << " *** LArPandora::ProduceTwoDArtOutput() *** " << std::endl;
+
+    if (!settings.m_pProducer)
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_INVALID_PARAMETER);
+
+    std::unique_ptr< std::vector<recob::Cluster> >           outputClusters( new std::vector<recob::Cluster> );
+    std::unique_ptr< art::Assns<recob::Cluster, recob::Hit> > outputClustersToHits( new art::Assns<recob::Cluster, recob::Hit> );
+
+    cluster::StandardClusterParamsAlg ClusterParamAlgo;
+    const OutputHits outputHits(idToHitMap);
+
+    // Read the 2D clusters from their named lists, so that the reduced settings need not build any pfos. The clusters of all instances
+    // are converted together, so that an ART hit passed to several instances is only written out once.
+    pandora::ClusterList clusterList;
+
+    for (const pandora::Pandora *const pPandora : pandoraInstanceList)
+    {
+        for (const std::string &clusterListName : settings.m_twoDClusterListNames)
+        {
+            const pandora::ClusterList *pClusterList(nullptr);
+
+            if (pandora::STATUS_CODE_SUCCESS != PandoraApi::GetClusterList(*pPandora, clusterListName, pClusterList))
+            {
+                throw cet::exception("LArPandora") << " LArPandoraOutput::ProduceTwoDArtOutput --- Missing 2D cluster list "
+                    << clusterListName << ", check the TwoDClusterListNames and the 2D-only settings ";
+            }
+
+            clusterList.insert(clusterList.end(), pClusterList->begin(), pClusterList->end());
+        }
+    }
+
+    int clusterCounter(0);
+    std::vector<recob::Cluster> clusters;
+    std::vector<HitVector> clusterHits;
+    LArPandoraOutput::BuildClusters(outputHits, clusterList, ClusterParamAlgo, clusterCounter, clusters, clusterHits);
+
+    for (size_t iCluster = 0; iCluster < clusters.size(); ++iCluster)
+    {
+        outputClusters->push_back(std::move(clusters[iCluster]));
+        util::CreateAssn(*(settings.m_pProducer), evt, *(outputClusters.get()), clusterHits[iCluster], *(outputClustersToHits.get()));
+    }
+
+    mf::LogDebug("LArPandora") << "   Number of new clusters: " << outputClusters->size() << std::endl;
+
+    evt.put(std::move(outputClusters));
+    evt.put(std::move(outputClustersToHits));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void LArPandoraOutput::BuildClusters(const OutputHits &outputHits, const pandora::ClusterList &clusterList, cluster::ClusterParamsAlgBase &algo,
+    int &clusterCounter, std::vector<recob::Cluster> &clusterVector, std::vector<HitVector> &clusterHitVectors)
+{
+    const HitVector &hitVector(outputHits.GetHitVector());
+    const std::vector<unsigned int> &hitCryostats(outputHits.GetHitSoA().GetCryostats());
+    const std::vector<unsigned int> &hitTpcs(outputHits.GetHitSoA().GetTpcs());
+
+    pandora::ClusterVector pandoraClusterVector(clusterList.begin(), clusterList.end());
+    std::sort(pandoraClusterVector.begin(), pandoraClusterVector.end(), lar_content::LArClusterHelper::SortByNHits);
+
+    // The clusters are visited largest first, so each copied ART hit is kept in the largest cluster containing a copy of it
+    std::vector<bool> isUsedHit(outputHits.HasCopiedHits() ? hitVector.size() : 0, false);
+
+    for (const pandora::Cluster *const pCluster : pandoraClusterVector)
+    {
+        if (pandora::TPC_3D == lar_content::LArClusterHelper::GetClusterHitType(pCluster))
+            continue;
+
+        pandora::CaloHitList pandoraHitList2D;
+        pCluster->GetOrderedCaloHitList().FillCaloHitList(pandoraHitList2D);
+        pandoraHitList2D.insert(pandoraHitList2D.end(), pCluster->GetIsolatedCaloHitList().begin(), pCluster->GetIsolatedCaloHitList().end());
+
+        pandora::CaloHitVector pandoraHitVector2D(pandoraHitList2D.begin(), pandoraHitList2D.end());
+        std::sort(pandoraHitVector2D.begin(), pandoraHitVector2D.end(), lar_content::LArClusterHelper::SortHitsByPosition);
+
+        if (pandoraHitVector2D.empty())
+            throw pandora::StatusCodeException(pandora::STATUS_CODE_FAILURE);
+
+        std::map<unsigned int, HitIndexVector> volumeHitIndices;  // sort hits by drift volume
+        HitIndexSet isolatedHitIndices;                            // select isolated hits
+
+        for (const pandora::CaloHit *const pCaloHit2D : pandoraHitVector2D)
+        {
+            const size_t index(outputHits.GetIndex(pCaloHit2D));
+
+            if (!isUsedHit.empty())
+            {
+                if (isUsedHit[index])
+                    continue;
+
+                isUsedHit[index] = true;
+            }
+
+            const unsigned int volID(100000 * hitCryostats[index] + hitTpcs[index]);
+
+            volumeHitIndices[volID].push_back(index);
+
+            if (pCaloHit2D->IsIsolated())
+                isolatedHitIndices.insert(index);
+        }
+
+        for (const std::map<unsigned int, HitIndexVector>::value_type &volumeEntry : volumeHitIndices)
+        {
+            const HitIndexVector &hitIndices(volumeEntry.second);
+            clusterVector.emplace_back(LArPandoraOutput::BuildCluster(clusterCounter++, outputHits, hitIndices, isolatedHitIndices, algo));
+
+            HitVector clusterHits;
+            clusterHits.reserve(hitIndices.size());
+
+            for (const size_t index : hitIndices)
+                clusterHits.push_back(hitVector[index]);
+
+            clusterHitVectors.push_back(std::move(clusterHits));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
 recob::Cluster LArPandoraOutput::BuildCluster(const int id, const HitVector &hitVector, const HitList &isolatedHits, cluster::ClusterParamsAlgBase &algo)
 {
-    mf::LogDebug("LArPandora") << "   Building Cluster [" << id << "], Number of hits = " << hitVector.size() << std::endl;
+    const OutputHits outputHits(hitVector);
 
-    if (hitVector.empty())
+    HitIndexVector hitIndices;
+    HitIndexSet isolatedHitIndices;
+    hitIndices.reserve(hitVector.size());
+
+    for (size_t index = 0; index < hitVector.size(); ++index)
+    {
+        hitIndices.push_back(index);
+
+        if (isolatedHits.count(hitVector[index]))
+            isolatedHitIndices.insert(index);
+    }
+
+    return LArPandoraOutput::BuildCluster(id, outputHits, hitIndices, isolatedHitIndices, algo);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+recob::Cluster LArPandoraOutput::BuildCluster(const int id, const OutputHits &outputHits, const HitIndexVector &hitIndices,
+    const HitIndexSet &isolatedHitIndices, cluster::ClusterParamsAlgBase &algo)
+{
+    mf::LogDebug("LArPandora") << "   Building Cluster [" << id << "], Number of hits = " << hitIndices.size() << std::endl;
+
+    if (hitIndices.empty())
         throw cet::exception("LArPandora") << " LArPandoraOutput::BuildCluster --- No input hits were provided ";
 
     // Fill list of cluster properties
@@ -526,16 +642,23 @@ recob::Cluster LArPandoraOutput::BuildCluster(const int id, const HitVector &hit
     double endTime(-std::numeric_limits<float>::max()), sigmaEndTime(0.0);
     
     std::vector<recob::Hit const*> hits_for_params;
-    hits_for_params.reserve(hitVector.size());
+    hits_for_params.reserve(hitIndices.size());
 
-    for (const art::Ptr<recob::Hit> &hit : hitVector)
+    const HitSoA &hitSoA(outputHits.GetHitSoA());
+    const std::vector<const recob::Hit*> &hitAddresses(outputHits.GetHitAddresses());
+    const std::vector<unsigned int> &hitWires(hitSoA.GetWires());
+    const std::vector<geo::View_t> &hitViews(hitSoA.GetViews());
+    const std::vector<float> &hitPeakTimes(hitSoA.GetPeakTimes());
+    const std::vector<float> &hitRMSs(hitSoA.GetRMSs());
+
+    for (const size_t index : hitIndices)
     {
-        const double thisWire(hit->WireID().Wire);
+        const double thisWire(hitWires[index]);
         const double thisWireSigma(0.5);
-        const double thisTime(hit->PeakTime());
-        const double thisTimeSigma(double(2.*hit->RMS()));
-        const geo::View_t thisView(hit->View());
-        const geo::PlaneID thisPlaneID(hit->WireID().planeID());
+        const double thisTime(hitPeakTimes[index]);
+        const double thisTimeSigma(double(2.*hitRMSs[index]));
+        const geo::View_t thisView(hitViews[index]);
+        const geo::PlaneID thisPlaneID(hitSoA.GetWireID(index).planeID());
 
         if (geo::kUnknown == view)
         {
@@ -548,9 +671,9 @@ recob::Cluster LArPandoraOutput::BuildCluster(const int id, const HitVector &hit
             throw cet::exception("LArPandora") << " LArPandoraOutput::BuildCluster --- Input hits have inconsistent plane IDs ";
         }
         
-        hits_for_params.push_back(&*hit);
+        hits_for_params.push_back(hitAddresses[index]);
         
-        if (isolatedHits.count(hit))
+        if (isolatedHitIndices.count(index))
             continue;
 
         if (thisWire < startWire || (thisWire == startWire && thisTime < startTime))
@@ -742,6 +865,83 @@ art::Ptr<recob::Hit> LArPandoraOutput::GetHit(const IdToHitMap &idToHitMap, cons
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
+LArPandoraOutput::OutputHits::OutputHits(const IdToHitMap &idToHitMap) :
+    m_hitVector(OutputHits::CollectHits(idToHitMap)),
+    m_hitSoA(m_hitVector)
+{
+    m_hitAddresses.reserve(m_hitVector.size());
+    m_idToIndexMap.reserve(idToHitMap.size());
+
+    for (const art::Ptr<recob::Hit> &hit : m_hitVector)
+        m_hitAddresses.push_back(hit.get());
+
+    // The copies of an ART hit passed to several pandora instances have consecutive ids, and share the index of the ART hit
+    const art::Ptr<recob::Hit> *pPreviousHit(nullptr);
+    size_t index(0);
+
+    for (const IdToHitMap::value_type &mapEntry : idToHitMap)
+    {
+        if (pPreviousHit && (*pPreviousHit != mapEntry.second))
+            ++index;
+
+        m_idToIndexMap.emplace(mapEntry.first, index);
+        pPreviousHit = &mapEntry.second;
+    }
+
+    m_hasCopiedHits = (m_hitVector.size() != idToHitMap.size());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+LArPandoraOutput::OutputHits::OutputHits(const HitVector &hitVector) :
+    m_hitVector(hitVector),
+    m_hitSoA(m_hitVector),
+    m_hasCopiedHits(false)
+{
+    m_hitAddresses.reserve(m_hitVector.size());
+    m_idToIndexMap.reserve(m_hitVector.size());
+
+    for (size_t index = 0; index < m_hitVector.size(); ++index)
+    {
+        m_hitAddresses.push_back(m_hitVector[index].get());
+        m_idToIndexMap.emplace(static_cast<int>(index + 1), index);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+size_t LArPandoraOutput::OutputHits::GetIndex(const pandora::CaloHit *const pCaloHit) const
+{
+    const void *const pHitAddress(pCaloHit->GetParentAddress());
+    const intptr_t hitID_temp((intptr_t)(pHitAddress));
+    const int hitID((int)(hitID_temp));
+
+    IdToIndexMap::const_iterator indexIter = m_idToIndexMap.find(hitID);
+
+    if (m_idToIndexMap.end() == indexIter)
+        throw pandora::StatusCodeException(pandora::STATUS_CODE_FAILURE);
+
+    return indexIter->second;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+HitVector LArPandoraOutput::OutputHits::CollectHits(const IdToHitMap &idToHitMap)
+{
+    HitVector hitVector;
+    hitVector.reserve(idToHitMap.size());
+
+    for (const IdToHitMap::value_type &mapEntry : idToHitMap)
+    {
+        if (hitVector.empty() || (hitVector.back() != mapEntry.second))
+            hitVector.push_back(mapEntry.second);
+    }
+
+    return hitVector;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
 LArPandoraOutput::Settings::Settings() :
     m_pPrimaryPandora(nullptr),
     m_pProducer(nullptr),
@@ -750,6 +950,7 @@ LArPandoraOutput::Settings::Settings() :
     m_buildShowers(true),
     m_buildStitchedParticles(false),
     m_buildSingleVolumeParticles(true),
+    m_twoDClusterListNames({"ClustersU", "ClustersV", "ClustersW"}),
     m_showerEnergyAlg(nullptr)
 {
 }
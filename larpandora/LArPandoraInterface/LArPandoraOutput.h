@@ -20,6 +20,12 @@
 
 #include "larpandora/LArPandoraInterface/ILArPandora.h"
 #include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
+#include "larpandora/LArPandoraInterface/LArPandoraHitSoA.h"
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace art {class EDProducer;}
 namespace pandora {class Pandora; class ParticleFlowObject;}
@@ -50,9 +56,78 @@ public:
         bool                    m_buildShowers;                 ///<
         bool                    m_buildStitchedParticles;       ///<
         bool                    m_buildSingleVolumeParticles;   ///<
+        std::vector<std::string> m_twoDClusterListNames;        ///< The names of the 2D cluster lists written in the 2D-only mode
         calo::LinearEnergyAlg const* m_showerEnergyAlg;         ///<
     };
 
+    /**
+     *  @brief  OutputHits class, holding the art hits of the event in pandora hit id order, with a snapshot of their properties taken
+     *          once per event, so that output objects can be built from hit indices
+     */
+    class OutputHits
+    {
+    public:
+        /**
+         *  @brief  Constructor
+         *
+         *  @param  idToHitMap the mapping from Pandora hit ID to ART hit
+         */
+        OutputHits(const IdToHitMap &idToHitMap);
+
+        /**
+         *  @brief  Constructor, from ART hits with Pandora hit IDs 1, 2, ... in vector order
+         *
+         *  @param  hitVector the ART hits
+         */
+        OutputHits(const HitVector &hitVector);
+
+        /**
+         *  @brief  Get the index of the ART hit corresponding to an input Pandora hit (2D)
+         *
+         *  @param  pCaloHit the input Pandora hit (2D)
+         */
+        size_t GetIndex(const pandora::CaloHit *const pCaloHit) const;
+
+        /**
+         *  @brief  Whether any ART hit was passed to several Pandora instances, so that several Pandora hits share its index
+         */
+        bool HasCopiedHits() const;
+
+        /**
+         *  @brief  Return the vector of ART hits
+         */
+        const HitVector &GetHitVector() const;
+
+        /**
+         *  @brief  Return the address of each ART hit
+         */
+        const std::vector<const recob::Hit*> &GetHitAddresses() const;
+
+        /**
+         *  @brief  Return the snapshot of the hit properties
+         */
+        const HitSoA &GetHitSoA() const;
+
+    private:
+        /**
+         *  @brief  Collect the ART hits in pandora hit id order, once each (the copies of an ART hit have consecutive pandora hit ids)
+         *
+         *  @param  idToHitMap the mapping from Pandora hit ID to ART hit
+         */
+        static HitVector CollectHits(const IdToHitMap &idToHitMap);
+
+        typedef std::unordered_map<int, size_t> IdToIndexMap;
+
+        HitVector                       m_hitVector;        ///< The ART hits, in pandora hit id order
+        HitSoA                          m_hitSoA;           ///< The snapshot of the hit properties
+        std::vector<const recob::Hit*>  m_hitAddresses;     ///< The address of each ART hit
+        IdToIndexMap                    m_idToIndexMap;     ///< The mapping from pandora hit id to hit index
+        bool                            m_hasCopiedHits;    ///< Whether any ART hit was passed to several Pandora instances
+    };
+
+    typedef std::vector<size_t> HitIndexVector;
+    typedef std::set<size_t> HitIndexSet;
+
     /**
      *  @brief  Convert the Pandora PFOs into ART clusters and write into ART event
      *
@@ -62,6 +137,32 @@ public:
      */
     static void ProduceArtOutput(const Settings &settings, const IdToHitMap &idToHitMap, art::Event &evt);
 
+    /**
+     *  @brief  Convert the named 2D cluster lists of the Pandora instances into ART clusters and write them into the ART event, skipping
+     *          all 3D products
+     *
+     *  @param  settings the settings
+     *  @param  idToHitMap the mapping from Pandora hit ID to ART hit
+     *  @param  pandoraInstanceList the Pandora instances holding the 2D cluster lists, i.e. those reconstructing input hits in this event
+     *  @param  evt the ART event
+     */
+    static void ProduceTwoDArtOutput(const Settings &settings, const IdToHitMap &idToHitMap, const PandoraInstanceList &pandoraInstanceList,
+        art::Event &evt);
+
+    /**
+     *  @brief Build the recob::Cluster objects for a list of 2D Pandora clusters, with one cluster per Pandora cluster and per TPC. An ART
+     *        hit passed to several Pandora instances is only kept in the largest of the clusters containing a copy of it.
+     *
+     *  @param outputHits the ART hits of the event
+     *  @param clusterList the input Pandora clusters (any 3D clusters are skipped)
+     *  @param algo Algorithm set to fill cluster members
+     *  @param clusterCounter the id code for the next cluster, incremented for each new cluster
+     *  @param clusterVector to receive the new clusters
+     *  @param clusterHitVectors to receive the hits of each new cluster
+     */
+    static void BuildClusters(const OutputHits &outputHits, const pandora::ClusterList &clusterList, cluster::ClusterParamsAlgBase &algo,
+        int &clusterCounter, std::vector<recob::Cluster> &clusterVector, std::vector<HitVector> &clusterHitVectors);
+
     /**
      *  @brief Build a recob::Cluster object from an input vector of recob::Hit objects
      *
@@ -71,10 +172,25 @@ public:
      *  @param algo Algorithm set to fill cluster members
      *  
      *  If you don't know which algorithm to pick, StandardClusterParamsAlg is a good default.
-     *  The hits that are isolated (that is, present in isolatedHits) are not fed to the cluster parameter algorithms.
+     *  The hits that are isolated (that is, present in isolatedHits) are not used to find the cluster start and end.
      */
     static recob::Cluster BuildCluster(const int id, const HitVector &hitVector, const HitList &isolatedHits, cluster::ClusterParamsAlgBase &algo);
 
+    /**
+     *  @brief Build a recob::Cluster object from the ART hits with the given indices
+     *
+     *  @param id the id code for the cluster
+     *  @param outputHits the ART hits of the event
+     *  @param hitIndices the indices of the cluster hits
+     *  @param isolatedHitIndices the indices of the isolated cluster hits
+     *  @param algo Algorithm set to fill cluster members
+     *  
+     *  If you don't know which algorithm to pick, StandardClusterParamsAlg is a good default.
+     *  The hits that are isolated (that is, present in isolatedHitIndices) are not used to find the cluster start and end.
+     */
+    static recob::Cluster BuildCluster(const int id, const OutputHits &outputHits, const HitIndexVector &hitIndices,
+        const HitIndexSet &isolatedHitIndices, cluster::ClusterParamsAlgBase &algo);
+
     /**
      *  @brief Check (valid) trajectory points is at least the minimum
      *
@@ -130,6 +246,34 @@ public:
 
 };
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline bool LArPandoraOutput::OutputHits::HasCopiedHits() const
+{
+    return m_hasCopiedHits;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const HitVector &LArPandoraOutput::OutputHits::GetHitVector() const
+{
+    return m_hitVector;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const std::vector<const recob::Hit*> &LArPandoraOutput::OutputHits::GetHitAddresses() const
+{
+    return m_hitAddresses;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline const HitSoA &LArPandoraOutput::OutputHits::GetHitSoA() const
+{
+    return m_hitSoA;
+}
+
 } // namespace lar_pandora
 
 #endif //  LAR_PANDORA_OUTPUT_H
@@ -0,0 +1,626 @@
+/**
+ *  @file   larpandora/LArPandoraInterface/LArPandoraSharedHitMatrix.h
+ *
+ *  @brief  Sparse matrix of the hits shared between reconstructed and true particles
+ */
+
+#ifndef LAR_PANDORA_SHARED_HIT_MATRIX_H
+#define LAR_PANDORA_SHARED_HIT_MATRIX_H 1
+
+#include "lardataobj/RecoBase/Hit.h"
+
+#include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace lar_pandora
+{
+
+/**
+ *  @brief  HitViewCounts class, the number of hits in total and in each view
+ */
+class HitViewCounts
+{
+public:
+    /**
+     *  @brief  Default constructor
+     */
+    HitViewCounts();
+
+    /**
+     *  @brief  Count a hit in a given view
+     *
+     *  @param  view the view of the hit
+     */
+    void AddHit(const geo::View_t view);
+
+    int     m_nHitsTotal;       ///< The total number of hits
+    int     m_nHitsU;           ///< The number of u hits
+    int     m_nHitsV;           ///< The number of v hits
+    int     m_nHitsW;           ///< The number of w hits
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  @brief  SharedHitMatrix class, holding the number of hits shared by each pair of reconstructed and true particles.
+ *
+ *  Only the pairs sharing at least one hit are stored. The cells are held row by row (one row per reconstructed particle, in the order
+ *  of the input map), with the cells of each row ordered by true particle. The true particles are indexed in art::Ptr order.
+ */
+template <typename T>
+class SharedHitMatrix
+{
+public:
+    typedef std::vector< art::Ptr<T> > TrueVector;
+    typedef std::map< art::Ptr<recob::Hit>, art::Ptr<T> > HitsToTrue;
+    typedef std::vector<size_t> IndexVector;
+
+    static const size_t NO_MATCH;   ///< The cell index denoting the absence of a match
+
+    /**
+     *  @brief  Constructor, building the matrix in a single pass over the hits of the reconstructed particles
+     *
+     *  @param  recoParticlesToHits the mapping from reconstructed particles to hits
+     *  @param  hitsToTrue the mapping from hits to true particles
+     *  @param  maxTasks the maximum number of concurrent tasks filling the rows (zero to use the hardware concurrency)
+     */
+    SharedHitMatrix(const PFParticlesToHits &recoParticlesToHits, const HitsToTrue &hitsToTrue, const unsigned int maxTasks = 1);
+
+    /**
+     *  @brief  Get the number of reconstructed particles (rows)
+     */
+    size_t GetNRecoParticles() const;
+
+    /**
+     *  @brief  Get the number of true particles (columns)
+     */
+    size_t GetNTrueParticles() const;
+
+    /**
+     *  @brief  Get the number of cells, i.e. pairs of particles sharing at least one hit
+     */
+    size_t GetNCells() const;
+
+    /**
+     *  @brief  Get the reconstructed particle for a given row
+     *
+     *  @param  recoIndex the row index
+     */
+    const art::Ptr<recob::PFParticle> &GetRecoParticle(const size_t recoIndex) const;
+
+    /**
+     *  @brief  Get the true particle for a given column
+     *
+     *  @param  trueIndex the column index
+     */
+    const art::Ptr<T> &GetTrueParticle(const size_t trueIndex) const;
+
+    /**
+     *  @brief  Find the column of a given true particle
+     *
+     *  @param  trueParticle the true particle
+     *  @param  trueIndex to receive the column index
+     *
+     *  @return whether the true particle has any hits
+     */
+    bool GetTrueIndex(const art::Ptr<T> &trueParticle, size_t &trueIndex) const;
+
+    /**
+     *  @brief  Get the number of hits of the reconstructed particle for a given row
+     *
+     *  @param  recoIndex the row index
+     */
+    const HitViewCounts &GetRecoHits(const size_t recoIndex) const;
+
+    /**
+     *  @brief  Get the number of hits of the true particle for a given column
+     *
+     *  @param  trueIndex the column index
+     */
+    const HitViewCounts &GetTrueHits(const size_t trueIndex) const;
+
+    /**
+     *  @brief  Get the index of the first cell of a row
+     *
+     *  @param  recoIndex the row index
+     */
+    size_t GetRowBegin(const size_t recoIndex) const;
+
+    /**
+     *  @brief  Get the index one past the last cell of a row
+     *
+     *  @param  recoIndex the row index
+     */
+    size_t GetRowEnd(const size_t recoIndex) const;
+
+    /**
+     *  @brief  Get the cells of a column, in row order
+     *
+     *  @param  trueIndex the column index
+     *  @param  cellIndices to receive the cell indices
+     */
+    void GetColumnCells(const size_t trueIndex, IndexVector &cellIndices) const;
+
+    /**
+     *  @brief  Get the number of cells in a column, i.e. the number of reconstructed particles sharing hits with a true particle
+     *
+     *  @param  trueIndex the column index
+     */
+    size_t GetNColumnCells(const size_t trueIndex) const;
+
+    /**
+     *  @brief  Get the row of a cell
+     *
+     *  @param  cellIndex the cell index
+     */
+    size_t GetCellRecoIndex(const size_t cellIndex) const;
+
+    /**
+     *  @brief  Get the column of a cell
+     *
+     *  @param  cellIndex the cell index
+     */
+    size_t GetCellTrueIndex(const size_t cellIndex) const;
+
+    /**
+     *  @brief  Get the number of hits shared by the particles of a cell
+     *
+     *  @param  cellIndex the cell index
+     */
+    const HitViewCounts &GetSharedHits(const size_t cellIndex) const;
+
+    /**
+     *  @brief  Get the completeness of a cell, the fraction of the hits of the true particle that are shared
+     *
+     *  @param  cellIndex the cell index
+     */
+    float GetCompleteness(const size_t cellIndex) const;
+
+    /**
+     *  @brief  Get the purity of a cell, the fraction of the hits of the reconstructed particle that are shared
+     *
+     *  @param  cellIndex the cell index
+     */
+    float GetPurity(const size_t cellIndex) const;
+
+    /**
+     *  @brief  Match true particles to the reconstructed particles with which they share most hits. Each unmatched reconstructed particle
+     *          proposes the unmatched true particle with which it shares most hits, and each true particle keeps the proposal with most
+     *          shared hits. The matched particles are then removed and, if recursive, the procedure is repeated until no new matches
+     *          are found.
+     *
+     *  @param  recursive whether to repeat the matching for the particles left unmatched
+     *  @param  matchedCells to receive the cell of the match for each column (NO_MATCH if the true particle is unmatched)
+     */
+    void GetBestMatches(const bool recursive, IndexVector &matchedCells) const;
+
+private:
+    /**
+     *  @brief  Cell class, the hits shared by a reconstructed and a true particle
+     */
+    class Cell
+    {
+    public:
+        size_t          m_trueIndex;        ///< The column index
+        HitViewCounts   m_sharedHits;       ///< The number of shared hits
+    };
+
+    typedef std::vector<Cell> CellVector;
+
+    /**
+     *  @brief  Fill the cells of a row, ordered by column, and count the hits of the reconstructed particle
+     *
+     *  @param  hitVector the hits of the reconstructed particle
+     *  @param  hitsToTrue the mapping from hits to true particles
+     *  @param  cellVector to receive the cells of the row
+     *  @param  recoHits to receive the number of hits of the reconstructed particle
+     */
+    void FillRow(const HitVector &hitVector, const HitsToTrue &hitsToTrue, CellVector &cellVector, HitViewCounts &recoHits) const;
+
+    /**
+     *  @brief  Calculate the completeness and purity of all cells
+     */
+    void CalculateCompletenessAndPurity();
+
+    PFParticleVector            m_recoParticles;        ///< The reconstructed particle for each row
+    TrueVector                  m_trueParticles;        ///< The true particle for each column, in art::Ptr order
+    std::vector<HitViewCounts>  m_recoHits;             ///< The number of hits of each reconstructed particle
+    std::vector<HitViewCounts>  m_trueHits;             ///< The number of hits of each true particle
+
+    IndexVector                 m_rowOffsets;           ///< The index of the first cell of each row, followed by the number of cells
+    IndexVector                 m_columnOffsets;        ///< The position of the first cell of each column in the column cell list
+    IndexVector                 m_columnCells;          ///< The cell indices, grouped by column and in row order within each column
+
+    IndexVector                 m_cellRecoIndices;      ///< The row of each cell
+    IndexVector                 m_cellTrueIndices;      ///< The column of each cell
+    std::vector<HitViewCounts>  m_cellSharedHits;       ///< The number of hits shared by the particles of each cell
+    std::vector<float>          m_cellCompleteness;     ///< The completeness of each cell
+    std::vector<float>          m_cellPurity;           ///< The purity of each cell
+};
+
+typedef SharedHitMatrix<simb::MCParticle>   MCParticleHitMatrix;
+typedef SharedHitMatrix<simb::MCTruth>      MCTruthHitMatrix;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline HitViewCounts::HitViewCounts() :
+    m_nHitsTotal(0),
+    m_nHitsU(0),
+    m_nHitsV(0),
+    m_nHitsW(0)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline void HitViewCounts::AddHit(const geo::View_t view)
+{
+    ++m_nHitsTotal;
+
+    if (geo::kU == view)
+        ++m_nHitsU;
+    else if (geo::kV == view)
+        ++m_nHitsV;
+    else if (geo::kW == view)
+        ++m_nHitsW;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+const size_t SharedHitMatrix<T>::NO_MATCH = std::numeric_limits<size_t>::max();
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+SharedHitMatrix<T>::SharedHitMatrix(const PFParticlesToHits &recoParticlesToHits, const HitsToTrue &hitsToTrue, const unsigned int maxTasks)
+{
+    // Index the true particles in art::Ptr order, so that the cells of each row follow the order of the true particle maps
+    std::set< art::Ptr<T> > trueParticleSet;
+
+    for (const typename HitsToTrue::value_type &mapEntry : hitsToTrue)
+        (void) trueParticleSet.insert(mapEntry.second);
+
+    m_trueParticles.assign(trueParticleSet.begin(), trueParticleSet.end());
+    m_trueHits.resize(m_trueParticles.size());
+
+    for (const typename HitsToTrue::value_type &mapEntry : hitsToTrue)
+    {
+        size_t trueIndex(0);
+        (void) this->GetTrueIndex(mapEntry.second, trueIndex);
+        m_trueHits[trueIndex].AddHit(mapEntry.first->View());
+    }
+
+    // Fill the rows concurrently, each task writing only to its own rows, then pack the cells
+    std::vector<const HitVector*> recoHitVectors;
+
+    for (const PFParticlesToHits::value_type &mapEntry : recoParticlesToHits)
+    {
+        m_recoParticles.push_back(mapEntry.first);
+        recoHitVectors.push_back(&mapEntry.second);
+    }
+
+    const size_t nRows(m_recoParticles.size());
+    std::vector<CellVector> rowCells(nRows);
+    m_recoHits.resize(nRows);
+
+    LArPandoraHelper::ProcessInParallel(nRows, 1, maxTasks, [&](const size_t begin, const size_t end)
+    {
+        for (size_t recoIndex = begin; recoIndex < end; ++recoIndex)
+            this->FillRow(*recoHitVectors[recoIndex], hitsToTrue, rowCells[recoIndex], m_recoHits[recoIndex]);
+    });
+
+    m_rowOffsets.reserve(nRows + 1);
+    m_rowOffsets.push_back(0);
+
+    for (size_t recoIndex = 0; recoIndex < nRows; ++recoIndex)
+        m_rowOffsets.push_back(m_rowOffsets.back() + rowCells[recoIndex].size());
+
+    const size_t nCells(m_rowOffsets.back());
+    m_cellRecoIndices.reserve(nCells);
+    m_cellTrueIndices.reserve(nCells);
+    m_cellSharedHits.reserve(nCells);
+
+    for (size_t recoIndex = 0; recoIndex < nRows; ++recoIndex)
+    {
+        for (const Cell &cell : rowCells[recoIndex])
+        {
+            m_cellRecoIndices.push_back(recoIndex);
+            m_cellTrueIndices.push_back(cell.m_trueIndex);
+            m_cellSharedHits.push_back(cell.m_sharedHits);
+        }
+    }
+
+    // Group the cells by column, keeping the row order within each column
+    m_columnOffsets.assign(m_trueParticles.size() + 1, 0);
+
+    for (const size_t trueIndex : m_cellTrueIndices)
+        ++m_columnOffsets[trueIndex + 1];
+
+    for (size_t trueIndex = 0; trueIndex < m_trueParticles.size(); ++trueIndex)
+        m_columnOffsets[trueIndex + 1] += m_columnOffsets[trueIndex];
+
+    IndexVector columnPositions(m_columnOffsets.begin(), m_columnOffsets.end() - 1);
+    m_columnCells.resize(nCells);
+
+    for (size_t cellIndex = 0; cellIndex < nCells; ++cellIndex)
+        m_columnCells[columnPositions[m_cellTrueIndices[cellIndex]]++] = cellIndex;
+
+    this->CalculateCompletenessAndPurity();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+void SharedHitMatrix<T>::FillRow(const HitVector &hitVector, const HitsToTrue &hitsToTrue, CellVector &cellVector, HitViewCounts &recoHits) const
+{
+    // ATTN A reconstructed particle shares hits with few true particles, so a linear search of the row is cheaper than a map
+    for (const art::Ptr<recob::Hit> &hit : hitVector)
+    {
+        const geo::View_t view(hit->View());
+        recoHits.AddHit(view);
+
+        typename HitsToTrue::const_iterator trueIter = hitsToTrue.find(hit);
+
+        if (hitsToTrue.end() == trueIter)
+            continue;
+
+        size_t trueIndex(0);
+        (void) this->GetTrueIndex(trueIter->second, trueIndex);
+
+        typename CellVector::iterator cellIter = cellVector.begin();
+
+        while ((cellVector.end() != cellIter) && (cellIter->m_trueIndex != trueIndex))
+            ++cellIter;
+
+        if (cellVector.end() == cellIter)
+        {
+            Cell cell;
+            cell.m_trueIndex = trueIndex;
+            cellIter = cellVector.insert(cellVector.end(), cell);
+        }
+
+        cellIter->m_sharedHits.AddHit(view);
+    }
+
+    std::sort(cellVector.begin(), cellVector.end(), [](const Cell &lhs, const Cell &rhs){return (lhs.m_trueIndex < rhs.m_trueIndex);});
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+void SharedHitMatrix<T>::CalculateCompletenessAndPurity()
+{
+    const size_t nCells(m_cellSharedHits.size());
+
+    std::vector<float> sharedHits(nCells), recoHits(nCells), trueHits(nCells);
+
+    for (size_t cellIndex = 0; cellIndex < nCells; ++cellIndex)
+    {
+        sharedHits[cellIndex] = static_cast<float>(m_cellSharedHits[cellIndex].m_nHitsTotal);
+        recoHits[cellIndex] = static_cast<float>(m_recoHits[m_cellRecoIndices[cellIndex]].m_nHitsTotal);
+        trueHits[cellIndex] = static_cast<float>(m_trueHits[m_cellTrueIndices[cellIndex]].m_nHitsTotal);
+    }
+
+    // ATTN Every cell holds at least one shared hit, so neither denominator can be zero
+    m_cellCompleteness.resize(nCells);
+    m_cellPurity.resize(nCells);
+
+    for (size_t cellIndex = 0; cellIndex < nCells; ++cellIndex)
+    {
+        m_cellCompleteness[cellIndex] = sharedHits[cellIndex] / trueHits[cellIndex];
+        m_cellPurity[cellIndex] = sharedHits[cellIndex] / recoHits[cellIndex];
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+void SharedHitMatrix<T>::GetBestMatches(const bool recursive, IndexVector &matchedCells) const
+{
+    const size_t nRows(m_recoParticles.size()), nColumns(m_trueParticles.size());
+
+    std::vector<bool> vetoReco(nRows, false), vetoTrue(nColumns, false);
+    matchedCells.assign(nColumns, NO_MATCH);
+
+    while (true)
+    {
+        bool foundMatches(false);
+
+        for (size_t recoIndex = 0; recoIndex < nRows; ++recoIndex)
+        {
+            if (vetoReco[recoIndex])
+                continue;
+
+            size_t bestCell(NO_MATCH);
+
+            for (size_t cellIndex = m_rowOffsets[recoIndex], cellEnd = m_rowOffsets[recoIndex + 1]; cellIndex < cellEnd; ++cellIndex)
+            {
+                if (vetoTrue[m_cellTrueIndices[cellIndex]])
+                    continue;
+
+                if ((NO_MATCH == bestCell) || (m_cellSharedHits[cellIndex].m_nHitsTotal > m_cellSharedHits[bestCell].m_nHitsTotal))
+                    bestCell = cellIndex;
+            }
+
+            if (NO_MATCH == bestCell)
+                continue;
+
+            size_t &matchedCell(matchedCells[m_cellTrueIndices[bestCell]]);
+
+            if ((NO_MATCH == matchedCell) || (m_cellSharedHits[bestCell].m_nHitsTotal > m_cellSharedHits[matchedCell].m_nHitsTotal))
+            {
+                matchedCell = bestCell;
+                foundMatches = true;
+            }
+        }
+
+        if (!foundMatches)
+            return;
+
+        for (size_t trueIndex = 0; trueIndex < nColumns; ++trueIndex)
+        {
+            if (NO_MATCH == matchedCells[trueIndex])
+                continue;
+
+            vetoTrue[trueIndex] = true;
+            vetoReco[m_cellRecoIndices[matchedCells[trueIndex]]] = true;
+        }
+
+        if (!recursive)
+            return;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline size_t SharedHitMatrix<T>::GetNRecoParticles() const
+{
+    return m_recoParticles.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline size_t SharedHitMatrix<T>::GetNTrueParticles() const
+{
+    return m_trueParticles.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline size_t SharedHitMatrix<T>::GetNCells() const
+{
+    return m_cellSharedHits.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline const art::Ptr<recob::PFParticle> &SharedHitMatrix<T>::GetRecoParticle(const size_t recoIndex) const
+{
+    return m_recoParticles.at(recoIndex);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline const art::Ptr<T> &SharedHitMatrix<T>::GetTrueParticle(const size_t trueIndex) const
+{
+    return m_trueParticles.at(trueIndex);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline bool SharedHitMatrix<T>::GetTrueIndex(const art::Ptr<T> &trueParticle, size_t &trueIndex) const
+{
+    typename TrueVector::const_iterator iter = std::lower_bound(m_trueParticles.begin(), m_trueParticles.end(), trueParticle);
+
+    if ((m_trueParticles.end() == iter) || (*iter != trueParticle))
+        return false;
+
+    trueIndex = iter - m_trueParticles.begin();
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline const HitViewCounts &SharedHitMatrix<T>::GetRecoHits(const size_t recoIndex) const
+{
+    return m_recoHits.at(recoIndex);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline const HitViewCounts &SharedHitMatrix<T>::GetTrueHits(const size_t trueIndex) const
+{
+    return m_trueHits.at(trueIndex);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline size_t SharedHitMatrix<T>::GetRowBegin(const size_t recoIndex) const
+{
+    return m_rowOffsets.at(recoIndex);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline size_t SharedHitMatrix<T>::GetRowEnd(const size_t recoIndex) const
+{
+    return m_rowOffsets.at(recoIndex + 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline void SharedHitMatrix<T>::GetColumnCells(const size_t trueIndex, IndexVector &cellIndices) const
+{
+    cellIndices.insert(cellIndices.end(), m_columnCells.begin() + m_columnOffsets.at(trueIndex), m_columnCells.begin() + m_columnOffsets.at(trueIndex + 1));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline size_t SharedHitMatrix<T>::GetNColumnCells(const size_t trueIndex) const
+{
+    return (m_columnOffsets.at(trueIndex + 1) - m_columnOffsets.at(trueIndex));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline size_t SharedHitMatrix<T>::GetCellRecoIndex(const size_t cellIndex) const
+{
+    return m_cellRecoIndices.at(cellIndex);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline size_t SharedHitMatrix<T>::GetCellTrueIndex(const size_t cellIndex) const
+{
+    return m_cellTrueIndices.at(cellIndex);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline const HitViewCounts &SharedHitMatrix<T>::GetSharedHits(const size_t cellIndex) const
+{
+    return m_cellSharedHits.at(cellIndex);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline float SharedHitMatrix<T>::GetCompleteness(const size_t cellIndex) const
+{
+    return m_cellCompleteness.at(cellIndex);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+inline float SharedHitMatrix<T>::GetPurity(const size_t cellIndex) const
+{
+    return m_cellPurity.at(cellIndex);
+}
+
+} // namespace lar_pandora
+
+#endif // #ifndef LAR_PANDORA_SHARED_HIT_MATRIX_H
@@ -9,7 +9,10 @@
 #include "larpandora/LArPandoraInterface/LArPandora.h"
 #include "larpandora/LArPandoraInterface/LArPandoraGeometry.h"
 
+#include <map>
+#include <set>
 #include <string>
+#include <vector>
 
 namespace lar_pandora
 {
@@ -29,16 +32,107 @@ public:
     StandardPandora(fhicl::ParameterSet const &pset);
 
 private:
+    typedef std::map<std::string, std::string> ConfigFileMap;
+    typedef std::map<unsigned int, unsigned int> VolumeIdleEventsMap;
+    typedef std::map<unsigned int, unsigned int> VolumeHitCountMap;
+    typedef std::set<unsigned int> VolumeIdSet;
+    typedef std::vector<unsigned int> UIntVector;
+    typedef std::vector<int> IntVector;
+    typedef std::vector<float> FloatVector;
+
     void CreatePandoraInstances();
+    void PreparePandoraInstances(const HitSoA &hitSoA, const HitInputSoA &hitInputSoA, PandoraInstanceList &newPandoraInstances);
     int GetVolumeIdNumber(const unsigned int cryostat, const unsigned int tpc) const;
+    void GetVolumeIdNumbers(const unsigned int cryostat, const unsigned int tpc, const double minZ, const double maxZ,
+        std::vector<int> &volumeIdNumbers) const;
+    void GetVolumeIdNumbers(const unsigned int cryostat, const unsigned int tpc, const double minZ, const double maxZ, const double time,
+        std::vector<int> &volumeIdNumbers) const;
+    bool IsFallbackPandoraInstance(const pandora::Pandora *const pPandora) const;
+    bool IsInputRoutedByTpc() const;
+
+    /**
+     *  @brief Get the indices in the drift volume list of the drift volumes (Z segments) containing a given TPC, within a range of z coordinates.
+     *         A z coordinate in the overlap between neighbouring Z segments belongs to both of them.
+     *
+     *  @param cryostat ID number
+     *  @param tpc ID number
+     *  @param minZ the minimum z coordinate
+     *  @param maxZ the maximum z coordinate
+     *  @param driftVolumeIndices to receive the drift volume indices
+     */
+    void GetDriftVolumeIndices(const unsigned int cryostat, const unsigned int tpc, const double minZ, const double maxZ,
+        UIntVector &driftVolumeIndices) const;
+
+    /**
+     *  @brief Get the number of time slices of a drift volume in this event
+     *
+     *  @param driftVolumeIndex the index in the drift volume list
+     */
+    unsigned int GetNTimeSlices(const unsigned int driftVolumeIndex) const;
+
+    /**
+     *  @brief Get the volume id number of a time slice of a drift volume (the first time slice uses the id of the drift volume itself)
+     *
+     *  @param driftVolumeIndex the index in the drift volume list
+     *  @param timeSliceIndex the time slice index
+     */
+    unsigned int GetTimeSliceVolumeId(const unsigned int driftVolumeIndex, const unsigned int timeSliceIndex) const;
+
+    /**
+     *  @brief Get the volume id number of the instance receiving the input for a volume (or time slice) in this event, which differs from
+     *         the volume id if the volume is reconstructed with the fallback settings
+     *
+     *  @param volumeId the volume id number
+     */
+    unsigned int GetInputVolumeId(const unsigned int volumeId) const;
+
+    /**
+     *  @brief Divide the hits in each drift volume into time slices, separated by the largest gaps in hit drift time
+     *
+     *  @param hitSoA the hits in the event
+     *  @param hitInputSoA the pandora 2D hit inputs of the hits in the event
+     */
+    void FillTimeSliceBoundaries(const HitSoA &hitSoA, const HitInputSoA &hitInputSoA);
+
+    /**
+     *  @brief Whether the reconstruction uses daughter instances, coordinated by a primary (stitching) instance
+     */
+    bool UseDaughterInstances() const;
+
+    /**
+     *  @brief Whether daughter instances are created on demand, once their volume (or time slice) receives hits
+     */
+    bool UseLazyDaughterInstances() const;
+
+    /**
+     *  @brief Whether volumes predicted to exceed the processing time budget are reconstructed by instances with the fallback settings
+     */
+    bool UseFallbackInstances() const;
+
+    /**
+     *  @brief Get the index in the drift volume index table of a given TPC
+     *
+     *  @param cryostat ID number
+     *  @param tpc ID number
+     *
+     *  @return the table index, or -1 if the TPC isn't in the table
+     */
+    int GetTableIndex(const unsigned int cryostat, const unsigned int tpc) const;
 
     /**
-     *  @brief Output a unique ID number for each TPC
+     *  @brief Get the index in the drift volume list of the (first) drift volume containing a given TPC
      *
      *  @param cryostat ID number
      *  @param tpc ID number
+     *
+     *  @return the drift volume index, or -1 if the TPC doesn't belong to a drift volume
+     */
+    int GetDriftVolumeIndex(const unsigned int cryostat, const unsigned int tpc) const;
+
+    /**
+     *  @brief Fill the (cryostat, TPC) to drift volume index table
      */
-    unsigned int GetTpcIdNumber(const unsigned int cryostat, const unsigned int tpc) const;
+    void FillDriftVolumeIndexTable();
 
     /**
      *  @brief Load the geometry information needed to run the Pandora reconstruction
@@ -56,15 +150,54 @@ private:
      *  @brief  Create daughter pandora instances
      *
      *  @param  configFileName the pandora settings config file name
+     *  @param  driftVolumeVector the drift volumes for which to create daughter instances
+     *  @param  volumeIdVector the volume id number of each new daughter instance
+     *  @param  pandoraInstanceList to receive the addresses of the new daughter instances
      */
-    void CreateDaughterPandoraInstances(const std::string &configFileName) const;
+    void CreateDaughterPandoraInstances(const std::string &configFileName, const std::vector<const LArDriftVolume*> &driftVolumeVector,
+        const UIntVector &volumeIdVector, PandoraInstanceList &pandoraInstanceList);
+
+    /**
+     *  @brief  Whether a daughter pandora instance should be created for a drift volume
+     *
+     *  @param  driftVolume the drift volume
+     */
+    bool IsDriftVolumeEnabled(const LArDriftVolume &driftVolume) const;
+
+    /**
+     *  @brief  Find the full path to a pandora settings config file, searching the FW search path once per distinct file name
+     *
+     *  @param  configFileName the pandora settings config file name
+     *
+     *  @return the full path to the config file
+     */
+    const std::string &FindConfigFile(const std::string &configFileName);
 
     LArDriftVolumeList  m_driftVolumeList;          ///< List of drift volumes for this geometry
-    LArDriftVolumeMap   m_driftVolumeMap;           ///< Mapping from tpcVolumeID to driftVolumeID
+    UIntVector          m_cryostatOffsets;          ///< Offset of the first TPC of each cryostat in the drift volume index table
+    IntVector           m_driftVolumeIndexTable;    ///< Index in the drift volume list of the volume containing each TPC, or -1
+    UIntVector          m_nDriftVolumesTable;       ///< Number of consecutive drift volumes (Z segments) containing each TPC
+    unsigned int        m_timeSliceIdStride;        ///< Offset between the volume ids of consecutive time slices of a drift volume
+    std::vector<FloatVector> m_timeSliceBoundaries; ///< Drift times [ticks] separating the time slices of each drift volume
+    unsigned int        m_fallbackIdOffset;         ///< Offset between the volume ids of the standard and fallback instances of a volume
+    VolumeIdSet         m_fallbackVolumeIdSet;      ///< The volume ids reconstructed with the fallback settings in this event
+    ConfigFileMap       m_configFileMap;            ///< Mapping from config file name to full config file path
+    VolumeIdleEventsMap m_volumeIdleEventsMap;      ///< Mapping from volumeID to number of consecutive events without hits
+    unsigned int        m_nEventsSinceEviction;     ///< Number of events since the idle lazy instances were last evicted
 
     bool                m_printGeometry;            ///< Whether to print collected geometry information
     bool                m_uniqueInstanceSettings;   ///< Whether to enable unique configuration of each Pandora instance
+    unsigned int        m_nInstanceThreads;         ///< Number of threads used to configure daughter instances (0: all cores)
     std::string         m_outputGeometryXmlFile;    ///< If provided, attempt to write collected geometry information to output xml file
+    std::string         m_geometryCacheFile;        ///< If provided, cache file for the drift volumes (regenerated if stale)
+    bool                m_lazyDaughterInstances;    ///< Whether to create daughter instances only when their volume has hits
+    unsigned int        m_maxIdleEvents;            ///< Number of events without hits in a lazy instance before its eviction (0: never)
+    double              m_segmentLengthZ;           ///< If positive, split drift volumes into Z segments of at most this length (2D-only)
+    double              m_segmentOverlapZ;          ///< The length in Z of the overlap between neighbouring Z segments
+    bool                m_enableTimeSlicing;        ///< Whether to reconstruct independent time slices of each drift volume separately
+    float               m_timeSliceGap;             ///< The minimum gap in hit drift time between time slices [ticks]
+    unsigned int        m_maxTimeSlices;            ///< The maximum number of time slices per drift volume
+    std::string         m_fallbackConfigFile;       ///< If provided, the lighter settings for volumes exceeding the processing time budget
 
     bool                m_useShortVolume;           ///< Historical DUNE 35t config parameter - use short drift volume (positive drift)
     bool                m_useLongVolume;            ///< Historical DUNE 35t config parameter - use long drift volume (negative drift)
@@ -80,6 +213,7 @@ DEFINE_ART_MODULE(StandardPandora)
 // implementation follows
 
 #include "cetlib/exception.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
 
 #include "larcore/Geometry/Geometry.h"
 
@@ -90,7 +224,11 @@ DEFINE_ART_MODULE(StandardPandora)
 #include "larpandoracontent/LArPlugins/LArRotationalTransformationPlugin.h"
 #include "larpandoracontent/LArStitching/MultiPandoraApi.h"
 
+#include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
+
+#include <algorithm>
 #include <iostream>
+#include <limits>
 
 namespace lar_pandora
 {
@@ -100,54 +238,357 @@ StandardPandora::StandardPandora(fhicl::ParameterSet const &pset) :
 {
     m_printGeometry = pset.get<bool>("PrintGeometry", false);
     m_uniqueInstanceSettings = pset.get<bool>("UniqueInstanceSettings", false);
+    m_nInstanceThreads = pset.get<unsigned int>("NInstanceThreads", 1);
     m_outputGeometryXmlFile = pset.get<std::string>("OutputGeometryXmlFile", "");
+    m_geometryCacheFile = pset.get<std::string>("GeometryCacheFile", "");
+    m_lazyDaughterInstances = pset.get<bool>("LazyDaughterInstances", false);
+    m_maxIdleEvents = pset.get<unsigned int>("MaxIdleEvents", 0);
+    m_segmentLengthZ = pset.get<double>("SegmentLengthZ", 0.);
+    m_segmentOverlapZ = pset.get<double>("SegmentOverlapZ", 10.);
+    m_enableTimeSlicing = pset.get<bool>("EnableTimeSlicing", false);
+    m_timeSliceGap = pset.get<float>("TimeSliceGap", 200.f);
+    m_maxTimeSlices = pset.get<unsigned int>("MaxTimeSlices", 8);
+    m_fallbackConfigFile = pset.get<std::string>("FallbackConfigFile", "");
     m_useShortVolume = pset.get<bool>("UseShortVolume", true);
     m_useLongVolume = pset.get<bool>("UseLongVolume", true);
     m_useLeftVolume = pset.get<bool>("UseLeftVolume", true);
     m_useRightVolume = pset.get<bool>("UseRightVolume", true);
+
+    m_timeSliceIdStride = 0;
+    m_fallbackIdOffset = 0;
+    m_nEventsSinceEviction = 0;
+
+    // The stitching algorithms only join particles across drift volume boundaries in x, so particles crossing the boundaries between
+    // Z segments could not be joined. Until they can, Z segmentation is limited to the 2D-only reconstruction, which builds no particles.
+    if ((m_segmentLengthZ > 0.) && !pset.get<bool>("EnableTwoDOnly", false))
+        throw cet::exception("LArPandora") << " Throwing exception - Z segmentation is only supported with EnableTwoDOnly ";
+
+    if (m_enableTimeSlicing && ((0 == m_maxTimeSlices) || (m_timeSliceGap < 0.f)))
+        throw cet::exception("LArPandora") << " Throwing exception - time slicing requires MaxTimeSlices > 0 and TimeSliceGap >= 0 ";
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline int StandardPandora::GetTableIndex(const unsigned int cryostat, const unsigned int tpc) const
+{
+    if (cryostat + 1 >= m_cryostatOffsets.size())
+        return -1;
+
+    const unsigned int tableIndex(m_cryostatOffsets[cryostat] + tpc);
+
+    if (tableIndex >= m_cryostatOffsets[cryostat + 1])
+        return -1;
+
+    return static_cast<int>(tableIndex);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline int StandardPandora::GetDriftVolumeIndex(const unsigned int cryostat, const unsigned int tpc) const
+{
+    const int tableIndex(this->GetTableIndex(cryostat, tpc));
+    return ((tableIndex < 0) ? -1 : m_driftVolumeIndexTable[tableIndex]);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
 int StandardPandora::GetVolumeIdNumber(const unsigned int cryostat, const unsigned int tpc) const
 {
-    LArDriftVolumeMap::const_iterator iter = m_driftVolumeMap.find(this->GetTpcIdNumber(cryostat, tpc));
+    const int driftVolumeIndex(this->GetDriftVolumeIndex(cryostat, tpc));
 
-    if (m_driftVolumeMap.end() == iter)
+    if (driftVolumeIndex < 0)
         throw cet::exception("LArPandora") << " Throwing exception - found a TPC that doesn't belong to a drift volume";
  
-    return iter->second.GetVolumeID();
+    return m_driftVolumeList[driftVolumeIndex].GetVolumeID();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-unsigned int StandardPandora::GetTpcIdNumber(const unsigned int cryostat, const unsigned int tpc) const
+void StandardPandora::GetVolumeIdNumbers(const unsigned int cryostat, const unsigned int tpc, const double minZ, const double maxZ,
+    std::vector<int> &volumeIdNumbers) const
 {
-    return 10000 * cryostat + tpc;
+    UIntVector driftVolumeIndices;
+    this->GetDriftVolumeIndices(cryostat, tpc, minZ, maxZ, driftVolumeIndices);
+
+    for (const unsigned int driftVolumeIndex : driftVolumeIndices)
+    {
+        for (unsigned int timeSliceIndex = 0, nTimeSlices = this->GetNTimeSlices(driftVolumeIndex); timeSliceIndex < nTimeSlices; ++timeSliceIndex)
+            volumeIdNumbers.push_back(this->GetInputVolumeId(this->GetTimeSliceVolumeId(driftVolumeIndex, timeSliceIndex)));
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void StandardPandora::GetVolumeIdNumbers(const unsigned int cryostat, const unsigned int tpc, const double minZ, const double maxZ,
+    const double time, std::vector<int> &volumeIdNumbers) const
+{
+    UIntVector driftVolumeIndices;
+    this->GetDriftVolumeIndices(cryostat, tpc, minZ, maxZ, driftVolumeIndices);
+
+    for (const unsigned int driftVolumeIndex : driftVolumeIndices)
+    {
+        unsigned int timeSliceIndex(0);
+
+        if (!m_timeSliceBoundaries.empty())
+        {
+            const FloatVector &boundaries(m_timeSliceBoundaries[driftVolumeIndex]);
+            timeSliceIndex = std::upper_bound(boundaries.begin(), boundaries.end(), static_cast<float>(time)) - boundaries.begin();
+        }
+
+        volumeIdNumbers.push_back(this->GetInputVolumeId(this->GetTimeSliceVolumeId(driftVolumeIndex, timeSliceIndex)));
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool StandardPandora::IsFallbackPandoraInstance(const pandora::Pandora *const pPandora) const
+{
+    return (this->UseFallbackInstances() && (MultiPandoraApi::GetVolumeInfo(pPandora).GetIdNumber() >= static_cast<int>(m_fallbackIdOffset)));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool StandardPandora::IsInputRoutedByTpc() const
+{
+    return ((m_segmentLengthZ <= 0.) && !m_enableTimeSlicing);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void StandardPandora::GetDriftVolumeIndices(const unsigned int cryostat, const unsigned int tpc, const double minZ, const double maxZ,
+    UIntVector &driftVolumeIndices) const
+{
+    const int tableIndex(this->GetTableIndex(cryostat, tpc));
+    const int driftVolumeIndex((tableIndex < 0) ? -1 : m_driftVolumeIndexTable[tableIndex]);
+
+    if (driftVolumeIndex < 0)
+        throw cet::exception("LArPandora") << " Throwing exception - found a TPC that doesn't belong to a drift volume";
+
+    const unsigned int nDriftVolumes(m_nDriftVolumesTable[tableIndex]);
+
+    if (1 == nDriftVolumes)
+    {
+        driftVolumeIndices.push_back(driftVolumeIndex);
+        return;
+    }
+
+    // Select the Z segments overlapping the requested range, with the outer segments extended to cover any input beyond the ends of the tpc
+    for (unsigned int index = driftVolumeIndex, indexEnd = driftVolumeIndex + nDriftVolumes; index < indexEnd; ++index)
+    {
+        const LArDriftVolume &driftVolume(m_driftVolumeList[index]);
+        const double segmentMinZ((index == driftVolumeIndex) ? -std::numeric_limits<double>::max() :
+            driftVolume.GetCenterZ() - 0.5 * driftVolume.GetWidthZ());
+        const double segmentMaxZ((index + 1 == indexEnd) ? std::numeric_limits<double>::max() :
+            driftVolume.GetCenterZ() + 0.5 * driftVolume.GetWidthZ());
+
+        if ((minZ <= segmentMaxZ) && (maxZ >= segmentMinZ))
+            driftVolumeIndices.push_back(index);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+unsigned int StandardPandora::GetNTimeSlices(const unsigned int driftVolumeIndex) const
+{
+    return (m_timeSliceBoundaries.empty() ? 1 : m_timeSliceBoundaries[driftVolumeIndex].size() + 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+unsigned int StandardPandora::GetTimeSliceVolumeId(const unsigned int driftVolumeIndex, const unsigned int timeSliceIndex) const
+{
+    return (m_driftVolumeList[driftVolumeIndex].GetVolumeID() + timeSliceIndex * m_timeSliceIdStride);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline unsigned int StandardPandora::GetInputVolumeId(const unsigned int volumeId) const
+{
+    if (m_fallbackVolumeIdSet.empty() || !m_fallbackVolumeIdSet.count(volumeId))
+        return volumeId;
+
+    return (volumeId + m_fallbackIdOffset);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void StandardPandora::FillTimeSliceBoundaries(const HitSoA &hitSoA, const HitInputSoA &hitInputSoA)
+{
+    // Collect the hit drift times in each drift volume, using the same z routing as the input hits
+    const std::vector<unsigned int> &hitCryostats(hitSoA.GetCryostats());
+    const std::vector<unsigned int> &hitTpcs(hitSoA.GetTpcs());
+    const std::vector<float> &hitPeakTimes(hitSoA.GetPeakTimes());
+    const std::vector<double> &hitWireMinZs(hitInputSoA.GetWireMinZs());
+    const std::vector<double> &hitWireMaxZs(hitInputSoA.GetWireMaxZs());
+
+    std::vector<FloatVector> hitTimes(m_driftVolumeList.size());
+    UIntVector driftVolumeIndices;
+
+    for (size_t index = 0, indexEnd = hitSoA.GetNHits(); index < indexEnd; ++index)
+    {
+        if (this->GetDriftVolumeIndex(hitCryostats[index], hitTpcs[index]) < 0)
+            continue;
+
+        driftVolumeIndices.clear();
+        this->GetDriftVolumeIndices(hitCryostats[index], hitTpcs[index], hitWireMinZs[index], hitWireMaxZs[index], driftVolumeIndices);
+
+        for (const unsigned int driftVolumeIndex : driftVolumeIndices)
+            hitTimes[driftVolumeIndex].push_back(hitPeakTimes[index]);
+    }
+
+    // Place a slice boundary in the middle of each sufficiently large gap in drift time, keeping only the largest gaps if there are too many
+    m_timeSliceBoundaries.assign(m_driftVolumeList.size(), FloatVector());
+
+    for (size_t driftVolumeIndex = 0; driftVolumeIndex < m_driftVolumeList.size(); ++driftVolumeIndex)
+    {
+        FloatVector &times(hitTimes[driftVolumeIndex]);
+        std::sort(times.begin(), times.end());
+
+        std::vector< std::pair<float, float> > gapVector;
+
+        for (size_t index = 1; index < times.size(); ++index)
+        {
+            const float gap(times[index] - times[index - 1]);
+
+            if (gap > m_timeSliceGap)
+                gapVector.push_back(std::pair<float, float>(gap, 0.5f * (times[index] + times[index - 1])));
+        }
+
+        if (gapVector.size() >= m_maxTimeSlices)
+        {
+            std::nth_element(gapVector.begin(), gapVector.begin() + (m_maxTimeSlices - 1), gapVector.end(),
+                [](const std::pair<float, float> &lhs, const std::pair<float, float> &rhs) {return (lhs.first > rhs.first);});
+            gapVector.resize(m_maxTimeSlices - 1);
+        }
+
+        FloatVector &boundaries(m_timeSliceBoundaries[driftVolumeIndex]);
+
+        for (const std::pair<float, float> &gap : gapVector)
+            boundaries.push_back(gap.second);
+
+        std::sort(boundaries.begin(), boundaries.end());
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool StandardPandora::UseDaughterInstances() const
+{
+    return ((m_driftVolumeList.size() > 1) || m_enableTimeSlicing);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool StandardPandora::UseLazyDaughterInstances() const
+{
+    return (m_lazyDaughterInstances || m_enableTimeSlicing);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool StandardPandora::UseFallbackInstances() const
+{
+    return (this->UseDaughterInstances() && !m_fallbackConfigFile.empty() && (m_volumeTimeBudget > 0.f));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void StandardPandora::FillDriftVolumeIndexTable()
+{
+    // Size the table from the drift volumes themselves, so that it can also be filled from a geometry cache
+    UIntVector nTpcsPerCryostat;
+
+    for (const LArDriftVolume &driftVolume : m_driftVolumeList)
+    {
+        for (const LArTpcVolume &tpcVolume : driftVolume.GetTpcVolumeList())
+        {
+            if (tpcVolume.GetCryostat() >= nTpcsPerCryostat.size())
+                nTpcsPerCryostat.resize(tpcVolume.GetCryostat() + 1, 0);
+
+            nTpcsPerCryostat[tpcVolume.GetCryostat()] = std::max(nTpcsPerCryostat[tpcVolume.GetCryostat()], tpcVolume.GetTpc() + 1);
+        }
+    }
+
+    m_cryostatOffsets.assign(1, 0);
+
+    for (const unsigned int nTpcs : nTpcsPerCryostat)
+        m_cryostatOffsets.push_back(m_cryostatOffsets.back() + nTpcs);
+
+    m_driftVolumeIndexTable.assign(m_cryostatOffsets.back(), -1);
+    m_nDriftVolumesTable.assign(m_cryostatOffsets.back(), 0);
+
+    for (size_t driftVolumeIndex = 0; driftVolumeIndex < m_driftVolumeList.size(); ++driftVolumeIndex)
+    {
+        for (const LArTpcVolume &tpcVolume : m_driftVolumeList[driftVolumeIndex].GetTpcVolumeList())
+        {
+            const unsigned int tableIndex(m_cryostatOffsets[tpcVolume.GetCryostat()] + tpcVolume.GetTpc());
+            int &tableEntry(m_driftVolumeIndexTable[tableIndex]);
+
+            // Keep the first drift volume containing a TPC, and count the consecutive Z segments that follow it
+            if (tableEntry < 0)
+                tableEntry = static_cast<int>(driftVolumeIndex);
+
+            if (driftVolumeIndex == static_cast<size_t>(tableEntry) + m_nDriftVolumesTable[tableIndex])
+                ++m_nDriftVolumesTable[tableIndex];
+        }
+    }
+
+    // Time slices of a drift volume use volume ids beyond those of all drift volumes
+    m_timeSliceIdStride = 0;
+
+    for (const LArDriftVolume &driftVolume : m_driftVolumeList)
+        m_timeSliceIdStride = std::max(m_timeSliceIdStride, driftVolume.GetVolumeID() + 1);
+
+    // Fallback instances use volume ids beyond those of all time slices
+    m_fallbackIdOffset = m_timeSliceIdStride * (m_enableTimeSlicing ? m_maxTimeSlices : 1);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
 void StandardPandora::LoadGeometry()
 {
-    if (!m_driftVolumeList.empty() || !m_driftVolumeMap.empty())
+    if (!m_driftVolumeList.empty() || !m_driftVolumeIndexTable.empty())
         throw cet::exception("LArPandora") << " Throwing exception - list of drift volumes already exists ";
 
-    LArPandoraGeometry::LoadGeometry(m_driftVolumeList);
+    uint64_t geometryHash(0);
+
+    if (m_geometryCacheFile.empty())
+    {
+        LArPandoraGeometry::LoadGeometry(m_driftVolumeList);
+    }
+    else if (!LArPandoraGeometry::GetGeometryHash(geometryHash))
+    {
+        mf::LogWarning("LArPandora") << " Geometry files not found, ignoring the geometry cache " << m_geometryCacheFile << std::endl;
+        LArPandoraGeometry::LoadGeometry(m_driftVolumeList);
+    }
+    else
+    {
+        if (!LArPandoraGeometry::ReadGeometry(m_geometryCacheFile, geometryHash, m_driftVolumeList))
+        {
+            mf::LogInfo("LArPandora") << " Geometry cache " << m_geometryCacheFile << " is missing or stale, regenerating it " << std::endl;
+            LArPandoraGeometry::LoadGeometry(m_driftVolumeList);
+
+            try
+            {
+                LArPandoraGeometry::WriteGeometryCache(m_geometryCacheFile, geometryHash, m_driftVolumeList);
+            }
+            catch (const cet::exception &e)
+            {
+                mf::LogWarning("LArPandora") << e.what() << std::endl;
+            }
+        }
+    }
  
+    if (m_segmentLengthZ > 0.)
+        LArPandoraGeometry::SplitDriftVolumes(m_segmentLengthZ, m_segmentOverlapZ, m_driftVolumeList);
+
     if (m_printGeometry)
         LArPandoraGeometry::PrintGeometry(m_driftVolumeList);
 
     if (!m_outputGeometryXmlFile.empty())
         LArPandoraGeometry::WriteGeometry(m_outputGeometryXmlFile, m_driftVolumeList);
 
-    for (const LArDriftVolume &driftVolume : m_driftVolumeList)
-    {
-        for (const LArTpcVolume &tpcVolume : driftVolume.GetTpcVolumeList())
-        {
-            (void) m_driftVolumeMap.insert(LArDriftVolumeMap::value_type(this->GetTpcIdNumber(tpcVolume.GetCryostat(), tpcVolume.GetTpc()), driftVolume));
-        }
-    }
+    this->FillDriftVolumeIndexTable();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -160,10 +601,29 @@ void StandardPandora::CreatePandoraInstances()
 
     // For multiple drift volumes, create a Pandora instance for each drift volume and an additional instance for stitching drift volumes.
     // For single drift volumes, just create a single Pandora instance
-    if (m_driftVolumeList.size() > 1)
+    // In lazy mode, the daughter instances are instead created once their drift volumes receive hits
+    // With time slicing, each time slice of each drift volume has its own daughter instance, again created once it receives hits
+    if (this->UseDaughterInstances())
     {
         this->CreatePrimaryPandoraInstance(m_stitchingConfigFile);
-        this->CreateDaughterPandoraInstances(m_configFile);
+
+        if (!this->UseLazyDaughterInstances())
+        {
+            std::vector<const LArDriftVolume*> driftVolumeVector;
+            UIntVector volumeIdVector;
+
+            for (const LArDriftVolume &driftVolume : m_driftVolumeList)
+            {
+                if (!this->IsDriftVolumeEnabled(driftVolume))
+                    continue;
+
+                driftVolumeVector.push_back(&driftVolume);
+                volumeIdVector.push_back(driftVolume.GetVolumeID());
+            }
+
+            PandoraInstanceList pandoraInstanceList;
+            this->CreateDaughterPandoraInstances(m_configFile, driftVolumeVector, volumeIdVector, pandoraInstanceList);
+        }
     }
     else
     {
@@ -173,6 +633,134 @@ void StandardPandora::CreatePandoraInstances()
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
+void StandardPandora::PreparePandoraInstances(const HitSoA &hitSoA, const HitInputSoA &hitInputSoA,
+    PandoraInstanceList &newPandoraInstances)
+{
+    m_fallbackVolumeIdSet.clear();
+
+    if (!this->UseDaughterInstances() || (!this->UseLazyDaughterInstances() && !this->UseFallbackInstances()))
+        return;
+
+    if (hitInputSoA.GetNHits() != hitSoA.GetNHits())
+        throw cet::exception("LArPandora") << " Throwing exception - hit inputs do not match the hits in the event ";
+
+    if (m_enableTimeSlicing)
+        this->FillTimeSliceBoundaries(hitSoA, hitInputSoA);
+
+    // Count the hits received by each drift volume (or time slice) in this event, routing each hit by the z extent of its wire, exactly
+    // as when the input hits are created, so that each hit is counted in every instance that will receive a copy of it
+    const std::vector<unsigned int> &hitCryostats(hitSoA.GetCryostats());
+    const std::vector<unsigned int> &hitTpcs(hitSoA.GetTpcs());
+    const std::vector<float> &hitPeakTimes(hitSoA.GetPeakTimes());
+    const std::vector<double> &hitWireMinZs(hitInputSoA.GetWireMinZs());
+    const std::vector<double> &hitWireMaxZs(hitInputSoA.GetWireMaxZs());
+
+    VolumeHitCountMap volumeHitCountMap;
+    IntVector volumeIdNumbers;
+
+    for (size_t index = 0, indexEnd = hitSoA.GetNHits(); index < indexEnd; ++index)
+    {
+        volumeIdNumbers.clear();
+        this->GetVolumeIdNumbers(hitCryostats[index], hitTpcs[index], hitWireMinZs[index], hitWireMaxZs[index], hitPeakTimes[index],
+            volumeIdNumbers);
+
+        for (const int volumeId : volumeIdNumbers)
+            ++volumeHitCountMap[volumeId];
+    }
+
+    // Volumes predicted to exceed the processing time budget are instead passed to instances using the lighter fallback settings
+    if (this->UseFallbackInstances())
+    {
+        for (const VolumeHitCountMap::value_type &mapEntry : volumeHitCountMap)
+        {
+            if (this->GetPredictedProcessingTime(mapEntry.second) > m_volumeTimeBudget)
+                (void) m_fallbackVolumeIdSet.insert(mapEntry.first);
+        }
+    }
+
+    VolumeIdSet activeVolumeIdSet;
+
+    for (const VolumeHitCountMap::value_type &mapEntry : volumeHitCountMap)
+        (void) activeVolumeIdSet.insert(this->GetInputVolumeId(mapEntry.first));
+
+    // Update the idle counters. MultiPandoraApi cannot remove individual daughter instances, and resetting an instance does not release
+    // its algorithms, so an idle instance is evicted by rebuilding the instance set. Instances are only filled after this point, so the
+    // rebuild loses no input: the instances active in this event are recreated below, and the idle ones are not. The rebuilds are limited
+    // to one per MaxIdleEvents events.
+    if (this->UseLazyDaughterInstances())
+    {
+        bool evictInstances(false);
+
+        for (VolumeIdleEventsMap::value_type &mapEntry : m_volumeIdleEventsMap)
+        {
+            mapEntry.second = (activeVolumeIdSet.count(mapEntry.first) ? 0 : mapEntry.second + 1);
+
+            if ((m_maxIdleEvents > 0) && (mapEntry.second >= m_maxIdleEvents))
+                evictInstances = true;
+        }
+
+        if (m_nEventsSinceEviction < std::numeric_limits<unsigned int>::max())
+            ++m_nEventsSinceEviction;
+
+        if (evictInstances && (m_nEventsSinceEviction >= m_maxIdleEvents))
+        {
+            mf::LogDebug("LArPandora") << " Evicting idle Pandora Daughter Instances, recreating the " << activeVolumeIdSet.size()
+                << " active instances " << std::endl;
+
+            this->DeletePandoraInstances();
+            m_pPrimaryPandora = nullptr;
+            m_volumeIdleEventsMap.clear();
+            m_nEventsSinceEviction = 0;
+
+            this->CreatePrimaryPandoraInstance(m_stitchingConfigFile);
+        }
+    }
+
+    // Create the missing daughter instances. Without lazy instances, the standard instances already exist and only fallback instances are needed
+    std::vector<const LArDriftVolume*> driftVolumeVector, fallbackDriftVolumeVector;
+    UIntVector volumeIdVector, fallbackVolumeIdVector;
+
+    for (size_t driftVolumeIndex = 0; driftVolumeIndex < m_driftVolumeList.size(); ++driftVolumeIndex)
+    {
+        const LArDriftVolume &driftVolume(m_driftVolumeList[driftVolumeIndex]);
+
+        if (!this->IsDriftVolumeEnabled(driftVolume))
+            continue;
+
+        for (unsigned int timeSliceIndex = 0, nTimeSlices = this->GetNTimeSlices(driftVolumeIndex); timeSliceIndex < nTimeSlices; ++timeSliceIndex)
+        {
+            const unsigned int volumeId(this->GetTimeSliceVolumeId(driftVolumeIndex, timeSliceIndex));
+            const unsigned int inputVolumeId(this->GetInputVolumeId(volumeId));
+            const bool isFallbackVolume(inputVolumeId != volumeId);
+
+            if (!volumeHitCountMap.count(volumeId) || m_volumeIdleEventsMap.count(inputVolumeId))
+                continue;
+
+            if (isFallbackVolume)
+            {
+                fallbackDriftVolumeVector.push_back(&driftVolume);
+                fallbackVolumeIdVector.push_back(inputVolumeId);
+            }
+            else if (this->UseLazyDaughterInstances())
+            {
+                driftVolumeVector.push_back(&driftVolume);
+                volumeIdVector.push_back(inputVolumeId);
+            }
+        }
+    }
+
+    this->CreateDaughterPandoraInstances(m_configFile, driftVolumeVector, volumeIdVector, newPandoraInstances);
+    this->CreateDaughterPandoraInstances(m_fallbackConfigFile, fallbackDriftVolumeVector, fallbackVolumeIdVector, newPandoraInstances);
+
+    for (const unsigned int volumeId : volumeIdVector)
+        m_volumeIdleEventsMap[volumeId] = 0;
+
+    for (const unsigned int volumeId : fallbackVolumeIdVector)
+        m_volumeIdleEventsMap[volumeId] = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
 void StandardPandora::CreatePrimaryPandoraInstance(const std::string &configFileName)
 {
     mf::LogDebug("LArPandora") << " *** StandardPandora::CreatePrimaryPandoraInstance(...) *** " << std::endl;
@@ -180,12 +768,7 @@ void StandardPandora::CreatePrimaryPandoraInstance(const std::string &configFile
     if (m_driftVolumeList.empty())
         throw cet::exception("LArPandora") << " Throwing exception - list of drift volumes is empty ";
 
-    cet::search_path sp("FW_SEARCH_PATH");
-    std::string fullConfigFileName;
-
-    if (!sp.find_file(configFileName, fullConfigFileName))
-        throw cet::exception("LArPandora") << " Failed to find xml configuration file " << configFileName << " in FW search path";
-
+    const std::string &fullConfigFileName(this->FindConfigFile(configFileName));
     const LArDriftVolume &driftVolume(m_driftVolumeList.front());
 
     m_pPrimaryPandora = this->CreateNewPandora();
@@ -195,7 +778,7 @@ void StandardPandora::CreatePrimaryPandoraInstance(const std::string &configFile
         new lar_content::LArPseudoLayerPlugin(driftVolume.GetWirePitchU(), driftVolume.GetWirePitchV(), driftVolume.GetWirePitchW())));
 
     // If only single drift volume, primary pandora instance will do all pattern recognition, rather than perform a particle stitching role
-    if (1 == m_driftVolumeList.size())
+    if (!this->UseDaughterInstances())
     {
         PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, LArContent::SetLArTransformationPlugin(*m_pPrimaryPandora,
             new lar_content::LArRotationalTransformationPlugin(driftVolume.GetWireAngleU(), driftVolume.GetWireAngleV(), driftVolume.GetSigmaUVZ())));
@@ -207,54 +790,100 @@ void StandardPandora::CreatePrimaryPandoraInstance(const std::string &configFile
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-void StandardPandora::CreateDaughterPandoraInstances(const std::string &configFileName) const
+void StandardPandora::CreateDaughterPandoraInstances(const std::string &configFileName, const std::vector<const LArDriftVolume*> &driftVolumeVector,
+    const UIntVector &volumeIdVector, PandoraInstanceList &pandoraInstanceList)
 {
     mf::LogDebug("LArPandora") << " *** StandardPandora::CreateDaughterPandoraInstance(...) *** " << std::endl;
 
     if (!m_pPrimaryPandora)
         throw cet::exception("LArPandora") << " Throwing exception - trying to create daughter Pandora instances in absence of primary instance ";
 
-    for (const LArDriftVolume &driftVolume : m_driftVolumeList)
+    if (volumeIdVector.size() != driftVolumeVector.size())
+        throw cet::exception("LArPandora") << " Throwing exception - inconsistent lists of drift volumes and volume ids ";
+
+    PandoraInstanceList pandoraVector;
+    std::vector<std::string> fullConfigFileNameVector;
+
+    // Create and register the instances serially, as MultiPandoraApi is not thread-safe
+    for (size_t i = 0; i < driftVolumeVector.size(); ++i)
     {
-        // Check historical DUNE config parameters
-        if ((2 == m_driftVolumeList.size()) && (
-            (driftVolume.IsPositiveDrift() && (!m_useShortVolume || !m_useRightVolume)) ||
-            (!driftVolume.IsPositiveDrift() && (!m_useLongVolume || !m_useLeftVolume)) ))
-        {
-            continue;
-        }
+        const LArDriftVolume &driftVolume(*driftVolumeVector[i]);
+        const unsigned int volumeId(volumeIdVector[i]);
 
-        mf::LogDebug("LArPandora") << " Creating Pandora Daughter Instance: [" << driftVolume.GetVolumeID() << "]" << std::endl;
+        mf::LogDebug("LArPandora") << " Creating Pandora Daughter Instance: [" << volumeId << "]" << std::endl;
 
-        std::ostringstream volumeIdString;
-        volumeIdString << driftVolume.GetVolumeID();
+        // Time slices share the settings of their drift volume, but are named after their own volume id
+        std::ostringstream volumeIdString, driftVolumeIdString;
+        volumeIdString << volumeId;
+        driftVolumeIdString << driftVolume.GetVolumeID();
 
         const pandora::Pandora *const pPandora = this->CreateNewPandora();
         MultiPandoraApi::AddDaughterPandoraInstance(m_pPrimaryPandora, pPandora);
-        MultiPandoraApi::SetVolumeInfo(pPandora, new VolumeInfo(driftVolume.GetVolumeID(), "driftVolume_" + volumeIdString.str(),
+        MultiPandoraApi::SetVolumeInfo(pPandora, new VolumeInfo(volumeId, "driftVolume_" + volumeIdString.str(),
             pandora::CartesianVector(driftVolume.GetCenterX(), driftVolume.GetCenterY(), driftVolume.GetCenterZ()), driftVolume.IsPositiveDrift()));
 
-        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, LArContent::SetLArPseudoLayerPlugin(*pPandora,
-            new lar_content::LArPseudoLayerPlugin(driftVolume.GetWirePitchU(), driftVolume.GetWirePitchV(), driftVolume.GetWirePitchW())));
-        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, LArContent::SetLArTransformationPlugin(*pPandora,
-            new lar_content::LArRotationalTransformationPlugin(driftVolume.GetWireAngleU(), driftVolume.GetWireAngleV(), driftVolume.GetSigmaUVZ())));
-
         std::string thisConfigFileName(configFileName);
 
         if (m_uniqueInstanceSettings)
         {
             const size_t insertPosition((thisConfigFileName.length() < 4) ? 0 : thisConfigFileName.length() - std::string(".xml").length());
-            thisConfigFileName = thisConfigFileName.insert(insertPosition, volumeIdString.str());
+            thisConfigFileName = thisConfigFileName.insert(insertPosition, driftVolumeIdString.str());
         }
 
-        cet::search_path sp("FW_SEARCH_PATH");
-        std::string thisFullConfigFileName;
+        pandoraVector.push_back(pPandora);
+        fullConfigFileNameVector.push_back(this->FindConfigFile(thisConfigFileName));
+    }
 
-        if (!sp.find_file(thisConfigFileName, thisFullConfigFileName))
-            throw cet::exception("LArPandora") << " Failed to find xml configuration file " << thisConfigFileName << " in FW search path";
+    // Reading the settings dominates the startup time, and each instance only touches its own algorithms and plugins
+    LArPandoraHelper::ProcessInParallel(pandoraVector.size(), 1, m_nInstanceThreads, [&](const size_t begin, const size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const LArDriftVolume &driftVolume(*driftVolumeVector[i]);
+            const pandora::Pandora *const pPandora(pandoraVector[i]);
+
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, LArContent::SetLArPseudoLayerPlugin(*pPandora,
+                new lar_content::LArPseudoLayerPlugin(driftVolume.GetWirePitchU(), driftVolume.GetWirePitchV(), driftVolume.GetWirePitchW())));
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, LArContent::SetLArTransformationPlugin(*pPandora,
+                new lar_content::LArRotationalTransformationPlugin(driftVolume.GetWireAngleU(), driftVolume.GetWireAngleV(), driftVolume.GetSigmaUVZ())));
+            PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::ReadSettings(*pPandora, fullConfigFileNameVector[i]));
+        }
+    });
+
+    pandoraInstanceList.insert(pandoraInstanceList.end(), pandoraVector.begin(), pandoraVector.end());
+}
 
-        PANDORA_THROW_RESULT_IF(pandora::STATUS_CODE_SUCCESS, !=, PandoraApi::ReadSettings(*pPandora, thisFullConfigFileName));
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+bool StandardPandora::IsDriftVolumeEnabled(const LArDriftVolume &driftVolume) const
+{
+    // Check historical DUNE config parameters
+    if ((2 == m_driftVolumeList.size()) && (
+        (driftVolume.IsPositiveDrift() && (!m_useShortVolume || !m_useRightVolume)) ||
+        (!driftVolume.IsPositiveDrift() && (!m_useLongVolume || !m_useLeftVolume)) ))
+    {
+        return false;
     }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+const std::string &StandardPandora::FindConfigFile(const std::string &configFileName)
+{
+    ConfigFileMap::const_iterator iter(m_configFileMap.find(configFileName));
+
+    if (m_configFileMap.end() != iter)
+        return iter->second;
+
+    cet::search_path sp("FW_SEARCH_PATH");
+    std::string fullConfigFileName;
+
+    if (!sp.find_file(configFileName, fullConfigFileName))
+        throw cet::exception("LArPandora") << " Failed to find xml configuration file " << configFileName << " in FW search path";
+
+    return m_configFileMap.insert(ConfigFileMap::value_type(configFileName, fullConfigFileName)).first->second;
 }
 
 } // namespace lar_pandora
@@ -17,7 +17,11 @@
 
 #include "larpandora/LArPandoraShowers/PCAShowerParticleBuildingAlgorithm.h"
 
-#include <Eigen/Dense>
+#include <numeric>
+
+#include <future>
+#include <sstream>
+#include <thread>
 
 using namespace pandora;
 using namespace lar_content;
@@ -25,9 +29,44 @@ using namespace lar_content;
 namespace lar_pandora_showers
 {
 
+std::atomic<unsigned int> PCAShowerParticleBuildingAlgorithm::m_nReservedThreads(0);
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
 PCAShowerParticleBuildingAlgorithm::PCAShowerParticleBuildingAlgorithm() :
     m_cosmicMode(false),
-    m_layerFitHalfWindow(20)
+    m_layerFitHalfWindow(20),
+    m_doublePrecisionPCA(false),
+    m_closedFormPCA(false),
+    m_batchPCA(false),
+    m_nShowerBuildingThreads(1),
+    m_hitWeighting(UNIT_WEIGHT),
+    m_trimmedPCAIterations(0),
+    m_trimmedPCANSigma(3.f),
+    m_trimmedPCAMinHits(10)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+PCAShowerParticleBuildingAlgorithm::ShowerPCA::ShowerPCA() :
+    m_statusCode(STATUS_CODE_NOT_INITIALIZED),
+    m_pThreeDCluster(nullptr),
+    m_centroid(0.f, 0.f, 0.f),
+    m_eigenValues(0.f, 0.f, 0.f)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+PCAShowerParticleBuildingAlgorithm::ShowerParameters::ShowerParameters() :
+    m_hasShowerLength(false),
+    m_showerLength(0.f, 0.f, 0.f),
+    m_hasOpeningAngle(false),
+    m_openingAngle(0.f),
+    m_hasLayerPositions(false),
+    m_minLayerPosition(0.f, 0.f, 0.f),
+    m_maxLayerPosition(0.f, 0.f, 0.f)
 {
 }
 
@@ -40,17 +79,8 @@ void PCAShowerParticleBuildingAlgorithm::CreatePfo(const ParticleFlowObject *con
         // Need an input vertex to provide a shower propagation direction
         const Vertex *const pInputVertex = LArPfoHelper::GetVertex(pInputPfo);
 
-        // In cosmic mode, build showers from all daughter pfos, otherwise require that pfo is shower-like
-        if (m_cosmicMode)
-        {
-            if (LArPfoHelper::IsFinalState(pInputPfo))
-                return;
-        }
-        else
-        {
-            if (!LArPfoHelper::IsShower(pInputPfo))
-                return;
-        }
+        if (!this->IsShowerCandidate(pInputPfo))
+            return;
 
         // Build a new pfo
         LArShowerPfoFactory pfoFactory;
@@ -67,42 +97,27 @@ void PCAShowerParticleBuildingAlgorithm::CreatePfo(const ParticleFlowObject *con
 
         if (!threeDClusterList.empty())
         {
-            CaloHitList threeDCaloHitList; // Might be able to get through LArPfoHelper instead
             const Cluster *const pThreeDCluster(threeDClusterList.front());
-            pThreeDCluster->GetOrderedCaloHitList().FillCaloHitList(threeDCaloHitList);
 
-            EigenVectors eigenVecs;
-            CartesianVector centroid(0.f, 0.f, 0.f), eigenValues(0.f, 0.f, 0.f);
-            this->RunPCA(threeDCaloHitList, centroid, eigenValues, eigenVecs);
+            const ShowerParameters showerParameters(this->GetShowerParameters(pInputPfo, pThreeDCluster));
+            const ShowerPCA &showerPCA(showerParameters.m_showerPCA);
 
-            try
-            {
-                pfoParameters.m_showerCentroid = centroid;
-                pfoParameters.m_showerDirection = eigenVecs.at(0);
-                pfoParameters.m_showerSecondaryVector = eigenVecs.at(1);
-                pfoParameters.m_showerTertiaryVector = eigenVecs.at(2);
-                pfoParameters.m_showerEigenValues = eigenValues;
-                pfoParameters.m_showerLength = this->ShowerLength(pfoParameters.m_showerEigenValues.Get());
-                pfoParameters.m_showerOpeningAngle = this->OpeningAngle(pfoParameters.m_showerDirection.Get(),
-                    pfoParameters.m_showerSecondaryVector.Get(), pfoParameters.m_showerEigenValues.Get());
-            }
-            catch (const StatusCodeException &statusCodeException)
-            {
-                if (STATUS_CODE_FAILURE == statusCodeException.GetStatusCode())
-                    throw statusCodeException;
-            }
+            pfoParameters.m_showerCentroid = showerPCA.m_centroid;
+            pfoParameters.m_showerDirection = showerPCA.m_eigenVecs.at(0);
+            pfoParameters.m_showerSecondaryVector = showerPCA.m_eigenVecs.at(1);
+            pfoParameters.m_showerTertiaryVector = showerPCA.m_eigenVecs.at(2);
+            pfoParameters.m_showerEigenValues = showerPCA.m_eigenValues;
 
-            try
-            {
-                const float layerPitch(LArGeometryHelper::GetWireZPitch(this->GetPandora()));
-                const ThreeDSlidingFitResult threeDFitResult(pThreeDCluster, m_layerFitHalfWindow, layerPitch);
-                pfoParameters.m_showerMinLayerPosition = threeDFitResult.GetGlobalMinLayerPosition();
-                pfoParameters.m_showerMaxLayerPosition = threeDFitResult.GetGlobalMaxLayerPosition();
-            }
-            catch (const StatusCodeException &statusCodeException)
+            if (showerParameters.m_hasShowerLength)
+                pfoParameters.m_showerLength = showerParameters.m_showerLength;
+
+            if (showerParameters.m_hasOpeningAngle)
+                pfoParameters.m_showerOpeningAngle = showerParameters.m_openingAngle;
+
+            if (showerParameters.m_hasLayerPositions)
             {
-                if (STATUS_CODE_FAILURE == statusCodeException.GetStatusCode())
-                    throw statusCodeException;
+                pfoParameters.m_showerMinLayerPosition = showerParameters.m_minLayerPosition;
+                pfoParameters.m_showerMaxLayerPosition = showerParameters.m_maxLayerPosition;
             }
         }
 
@@ -134,115 +149,449 @@ void PCAShowerParticleBuildingAlgorithm::CreatePfo(const ParticleFlowObject *con
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-void PCAShowerParticleBuildingAlgorithm::RunPCA(const pandora::CaloHitList &threeDCaloHitList, pandora::CartesianVector &centroid,
-    pandora::CartesianVector &outputEigenValues, EigenVectors &outputEigenVecs) const
+StatusCode PCAShowerParticleBuildingAlgorithm::Reset()
 {
-    // The steps are:
-    // 1) do a mean normalization of the input vec points
-    // 2) compute the covariance matrix
-    // 3) run the SVD
-    // 4) extract the eigen vectors and values
+    m_showerPCAMap.clear();
+    m_showerParametersMap.clear();
+    return STATUS_CODE_SUCCESS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
 
-    // Run through the CaloHitList and get the mean position of all the hits
-    double meanPosition[3] = {0., 0., 0.};
-    unsigned int nThreeDHits(0);
+bool PCAShowerParticleBuildingAlgorithm::IsShowerCandidate(const ParticleFlowObject *const pInputPfo) const
+{
+    // In cosmic mode, build showers from all daughter pfos, otherwise require that pfo is shower-like
+    if (m_cosmicMode)
+        return !LArPfoHelper::IsFinalState(pInputPfo);
+
+    return LArPfoHelper::IsShower(pInputPfo);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
 
-    for (const CaloHit *const pCaloHit3D : threeDCaloHitList)
+PCAShowerParticleBuildingAlgorithm::ShowerPCA PCAShowerParticleBuildingAlgorithm::GetShowerPCA(const ParticleFlowObject *const pInputPfo,
+    const Cluster *const pThreeDCluster) const
+{
+    if (m_batchPCA)
     {
-        meanPosition[0] += pCaloHit3D->GetPositionVector().GetX();
-        meanPosition[1] += pCaloHit3D->GetPositionVector().GetY();
-        meanPosition[2] += pCaloHit3D->GetPositionVector().GetZ();
-        ++nThreeDHits;
+        // The batch is run when the first shower candidate of an event is reached, or if the stored results are for a different cluster
+        ShowerPCAMap::const_iterator iter(m_showerPCAMap.find(pInputPfo));
+
+        if ((m_showerPCAMap.end() == iter) || (iter->second.m_pThreeDCluster != pThreeDCluster))
+        {
+            this->RunBatchPCA();
+            iter = m_showerPCAMap.find(pInputPfo);
+        }
+
+        if ((m_showerPCAMap.end() != iter) && (iter->second.m_pThreeDCluster == pThreeDCluster))
+        {
+            if (STATUS_CODE_SUCCESS != iter->second.m_statusCode)
+                throw StatusCodeException(iter->second.m_statusCode);
+
+            return iter->second;
+        }
     }
 
-    if (0 == nThreeDHits)
+    HitPositions hitPositions;
+    this->FillHitPositions(pThreeDCluster, hitPositions);
+
+    ShowerPCA showerPCA;
+    this->RunShowerPCA(hitPositions, 0, hitPositions.m_x.size(), pThreeDCluster, std::cout, showerPCA);
+
+    if (STATUS_CODE_SUCCESS != showerPCA.m_statusCode)
+        throw StatusCodeException(showerPCA.m_statusCode);
+
+    return showerPCA;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PCAShowerParticleBuildingAlgorithm::GetShowerCandidates(PfoVector &candidatePfos, ClusterVector &candidateClusters) const
+{
+    const PfoList *pInputPfoList(nullptr);
+    PANDORA_THROW_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_INITIALIZED, !=, PandoraContentApi::GetList(*this,
+        m_inputPfoListName, pInputPfoList));
+
+    if (!pInputPfoList)
+        return;
+
+    for (const ParticleFlowObject *const pInputPfo : *pInputPfoList)
     {
-        std::cout << "PCAShowerParticleBuildingAlgorithm::RunPCA - No three dimensional hit found!" << std::endl;
-        throw StatusCodeException(STATUS_CODE_NOT_FOUND);
+        if (!this->IsShowerCandidate(pInputPfo))
+            continue;
+
+        ClusterList threeDClusterList;
+        LArPfoHelper::GetThreeDClusterList(pInputPfo, threeDClusterList);
+
+        if (threeDClusterList.empty())
+            continue;
+
+        candidatePfos.push_back(pInputPfo);
+        candidateClusters.push_back(threeDClusterList.front());
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+PCAShowerParticleBuildingAlgorithm::ShowerParameters PCAShowerParticleBuildingAlgorithm::GetShowerParameters(
+    const ParticleFlowObject *const pInputPfo, const Cluster *const pThreeDCluster) const
+{
+    if (m_nShowerBuildingThreads > 1)
+    {
+        // The parameters of all candidates are calculated when the first shower candidate of an event is reached
+        ShowerParametersMap::const_iterator iter(m_showerParametersMap.find(pInputPfo));
+
+        if ((m_showerParametersMap.end() == iter) || (iter->second.m_showerPCA.m_pThreeDCluster != pThreeDCluster))
+        {
+            this->RunParallelShowerBuilding();
+            iter = m_showerParametersMap.find(pInputPfo);
+        }
+
+        if ((m_showerParametersMap.end() != iter) && (iter->second.m_showerPCA.m_pThreeDCluster == pThreeDCluster))
+        {
+            if (STATUS_CODE_SUCCESS != iter->second.m_showerPCA.m_statusCode)
+                throw StatusCodeException(iter->second.m_showerPCA.m_statusCode);
+
+            return iter->second;
+        }
     }
 
-    const double nThreeDHitsAsDouble(static_cast<double>(nThreeDHits));
-    meanPosition[0] /= nThreeDHitsAsDouble;
-    meanPosition[1] /= nThreeDHitsAsDouble;
-    meanPosition[2] /= nThreeDHitsAsDouble;
-    centroid = CartesianVector(meanPosition[0], meanPosition[1], meanPosition[2]);
+    ShowerParameters showerParameters;
+    showerParameters.m_showerPCA = this->GetShowerPCA(pInputPfo, pThreeDCluster);
+    this->FillShowerParameters(pThreeDCluster, LArGeometryHelper::GetWireZPitch(this->GetPandora()), std::cout, showerParameters);
 
-    // Define elements of our covariance matrix
-    double xi2(0.);
-    double xiyi(0.);
-    double xizi(0.);
-    double yi2(0.);
-    double yizi(0.);
-    double zi2(0.);
-    double weightSum(0.);
+    return showerParameters;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
 
-    for (const CaloHit *const pCaloHit3D : threeDCaloHitList)
+void PCAShowerParticleBuildingAlgorithm::RunParallelShowerBuilding() const
+{
+    m_showerParametersMap.clear();
+
+    PfoVector candidatePfos;
+    ClusterVector candidateClusters;
+    this->GetShowerCandidates(candidatePfos, candidateClusters);
+
+    if (candidatePfos.empty())
+        return;
+
+    if (m_batchPCA)
+        this->RunBatchPCA();
+
+    // The tasks only read the clusters and write to their own entries of the output vector; the pandora objects are created later, serially
+    const float layerPitch(LArGeometryHelper::GetWireZPitch(this->GetPandora()));
+    const size_t nCandidates(candidatePfos.size());
+    std::vector<ShowerParameters> showerParametersVector(nCandidates);
+
+    // The candidates are split into ranges, one per task. The messages of each task are collected and printed once all tasks have finished
+    const size_t nRanges(std::min(static_cast<size_t>(m_nShowerBuildingThreads), nCandidates));
+    const size_t candidatesPerRange((nCandidates + nRanges - 1) / nRanges);
+    std::vector<std::ostringstream> messageStreams(nRanges);
+
+    const auto processRange = [&](const size_t iRange)
     {
-        const double weight(1.);
-        const CartesianVector &hitPosition(pCaloHit3D->GetPositionVector());
-        const double x((hitPosition.GetX() - meanPosition[0]) * weight);
-        const double y((hitPosition.GetY() - meanPosition[1]) * weight);
-        const double z((hitPosition.GetZ() - meanPosition[2]) * weight);
+        std::ostream &messageStream(messageStreams.at(iRange));
+        const size_t begin(iRange * candidatesPerRange), end(std::min(nCandidates, begin + candidatesPerRange));
+
+        for (size_t iCandidate = begin; iCandidate < end; ++iCandidate)
+        {
+            const Cluster *const pThreeDCluster(candidateClusters.at(iCandidate));
+            ShowerParameters &showerParameters(showerParametersVector.at(iCandidate));
+            const ShowerPCAMap::const_iterator pcaIter(m_showerPCAMap.find(candidatePfos.at(iCandidate)));
+
+            if (m_batchPCA && (m_showerPCAMap.end() != pcaIter))
+            {
+                showerParameters.m_showerPCA = pcaIter->second;
+            }
+            else
+            {
+                HitPositions hitPositions;
+                this->FillHitPositions(pThreeDCluster, hitPositions);
+                this->RunShowerPCA(hitPositions, 0, hitPositions.m_x.size(), pThreeDCluster, messageStream, showerParameters.m_showerPCA);
+            }
+
+            if (STATUS_CODE_SUCCESS == showerParameters.m_showerPCA.m_statusCode)
+                this->FillShowerParameters(pThreeDCluster, layerPitch, messageStream, showerParameters);
+        }
+    };
 
-        xi2  += x * x;
-        xiyi += x * y;
-        xizi += x * z;
-        yi2  += y * y;
-        yizi += y * z;
-        zi2  += z * z;
-        weightSum += weight * weight;
+    // This algorithm may run in several pandora instances at once, so the extra threads are drawn from a budget shared by all instances.
+    // Ranges without a thread of their own are processed by the calling thread, when their (deferred) task is waited for
+    const unsigned int nExtraThreads(PCAShowerParticleBuildingAlgorithm::ReserveThreads(nRanges - 1));
+    std::vector< std::future<void> > taskVector;
+
+    for (size_t iRange = 0; iRange < nRanges; ++iRange)
+    {
+        const std::launch launchPolicy((iRange + nExtraThreads < nRanges) ? std::launch::deferred : std::launch::async);
+        taskVector.push_back(std::async(launchPolicy, processRange, iRange));
     }
 
-    // Using Eigen package
-    Eigen::Matrix3f sig;
+    // Wait for every task before propagating any exception, as the tasks reference local data
+    for (std::future<void> &task : taskVector)
+        task.wait();
+
+    PCAShowerParticleBuildingAlgorithm::ReleaseThreads(nExtraThreads);
+
+    for (const std::ostringstream &messageStream : messageStreams)
+        std::cout << messageStream.str();
+
+    for (std::future<void> &task : taskVector)
+        task.get();
+
+    for (size_t iCandidate = 0; iCandidate < nCandidates; ++iCandidate)
+        m_showerParametersMap[candidatePfos.at(iCandidate)] = showerParametersVector.at(iCandidate);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
 
-    sig <<  xi2, xiyi, xizi,
-           xiyi,  yi2, yizi,
-           xizi, yizi,  zi2;
+void PCAShowerParticleBuildingAlgorithm::FillShowerParameters(const Cluster *const pThreeDCluster, const float layerPitch,
+    std::ostream &messageStream, ShowerParameters &showerParameters) const
+{
+    const ShowerPCA &showerPCA(showerParameters.m_showerPCA);
 
-    if (std::fabs(weightSum) < std::numeric_limits<double>::epsilon())
+    try
     {
-        std::cout << "PCAShowerParticleBuildingAlgorithm::RunPCA - The total weight of three dimensional hits is 0!" << std::endl;
-        throw StatusCodeException(STATUS_CODE_INVALID_PARAMETER);
+        showerParameters.m_showerLength = this->ShowerLength(showerPCA.m_eigenValues, messageStream);
+        showerParameters.m_hasShowerLength = true;
+        showerParameters.m_openingAngle = this->OpeningAngle(showerPCA.m_eigenVecs.at(0), showerPCA.m_eigenVecs.at(1),
+            showerPCA.m_eigenValues, messageStream);
+        showerParameters.m_hasOpeningAngle = true;
+    }
+    catch (const StatusCodeException &statusCodeException)
+    {
+        if (STATUS_CODE_FAILURE == statusCodeException.GetStatusCode())
+            throw statusCodeException;
     }
 
-    sig *= 1. / weightSum;
+    try
+    {
+        const ThreeDSlidingFitResult threeDFitResult(pThreeDCluster, m_layerFitHalfWindow, layerPitch);
+        showerParameters.m_minLayerPosition = threeDFitResult.GetGlobalMinLayerPosition();
+        showerParameters.m_maxLayerPosition = threeDFitResult.GetGlobalMaxLayerPosition();
+        showerParameters.m_hasLayerPositions = true;
+    }
+    catch (const StatusCodeException &statusCodeException)
+    {
+        if (STATUS_CODE_FAILURE == statusCodeException.GetStatusCode())
+            throw statusCodeException;
+    }
+}
 
-    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3f> eigenMat(sig);
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PCAShowerParticleBuildingAlgorithm::RunBatchPCA() const
+{
+    m_showerPCAMap.clear();
+
+    PfoVector candidatePfos;
+    ClusterVector candidateClusters;
+    this->GetShowerCandidates(candidatePfos, candidateClusters);
 
-    if (eigenMat.info() != Eigen::ComputationInfo::Success)
+    // Gather the hits of all shower candidates into one buffer, with the hits of candidate i in the range [offsets[i], offsets[i+1])
+    OffsetVector offsets(1, 0);
+    HitPositions hitPositions;
+
+    for (const Cluster *const pThreeDCluster : candidateClusters)
     {
-        std::cout << "PCAShowerParticleBuildingAlgorithm::RunPCA - PCA decompose failure, number of three D hits = " << nThreeDHits << std::endl;
-        throw StatusCodeException(STATUS_CODE_INVALID_PARAMETER);
+        this->FillHitPositions(pThreeDCluster, hitPositions);
+        offsets.push_back(hitPositions.m_x.size());
+    }
+
+    // Accumulate the statistics of every candidate in a single sweep over the buffer, then diagonalise each covariance matrix in turn
+    const size_t nCandidates(candidatePfos.size());
+    std::vector<ShowerPCAAccumulator> accumulators(nCandidates);
+    std::vector<bool> useHitWeights(nCandidates, false);
+
+    for (size_t iCandidate = 0; iCandidate < nCandidates; ++iCandidate)
+    {
+        useHitWeights.at(iCandidate) = this->AccumulateHits(hitPositions, offsets.at(iCandidate), offsets.at(iCandidate + 1),
+            accumulators.at(iCandidate));
+    }
+
+    for (size_t iCandidate = 0; iCandidate < nCandidates; ++iCandidate)
+    {
+        this->SolveShowerPCA(hitPositions, offsets.at(iCandidate), offsets.at(iCandidate + 1), useHitWeights.at(iCandidate),
+            accumulators.at(iCandidate), candidateClusters.at(iCandidate), std::cout, m_showerPCAMap[candidatePfos.at(iCandidate)]);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PCAShowerParticleBuildingAlgorithm::RunShowerPCA(const HitPositions &hitPositions, const size_t begin, const size_t end,
+    const Cluster *const pThreeDCluster, std::ostream &messageStream, ShowerPCA &showerPCA) const
+{
+    ShowerPCAAccumulator accumulator;
+    const bool useHitWeights(this->AccumulateHits(hitPositions, begin, end, accumulator));
+    this->SolveShowerPCA(hitPositions, begin, end, useHitWeights, accumulator, pThreeDCluster, messageStream, showerPCA);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PCAShowerParticleBuildingAlgorithm::SolveShowerPCA(const HitPositions &hitPositions, const size_t begin, const size_t end,
+    const bool useHitWeights, ShowerPCAAccumulator &accumulator, const Cluster *const pThreeDCluster, std::ostream &messageStream,
+    ShowerPCA &showerPCA) const
+{
+    showerPCA.m_pThreeDCluster = pThreeDCluster;
+
+    try
+    {
+        this->RunPCA(hitPositions, begin, end, useHitWeights, accumulator, messageStream, showerPCA.m_centroid, showerPCA.m_eigenValues,
+            showerPCA.m_eigenVecs);
+        showerPCA.m_statusCode = STATUS_CODE_SUCCESS;
+    }
+    catch (const StatusCodeException &statusCodeException)
+    {
+        showerPCA.m_statusCode = statusCodeException.GetStatusCode();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PCAShowerParticleBuildingAlgorithm::FillHitPositions(const Cluster *const pCluster, HitPositions &hitPositions) const
+{
+    const size_t nHits(hitPositions.m_x.size() + pCluster->GetNCaloHits());
+    hitPositions.m_x.reserve(nHits);
+    hitPositions.m_y.reserve(nHits);
+    hitPositions.m_z.reserve(nHits);
+    hitPositions.m_weight.reserve(nHits);
+
+    for (const OrderedCaloHitList::value_type &layerEntry : pCluster->GetOrderedCaloHitList())
+    {
+        for (const CaloHit *const pCaloHit3D : *layerEntry.second)
+        {
+            const CartesianVector &hitPosition(pCaloHit3D->GetPositionVector());
+            hitPositions.m_x.push_back(hitPosition.GetX());
+            hitPositions.m_y.push_back(hitPosition.GetY());
+            hitPositions.m_z.push_back(hitPosition.GetZ());
+            hitPositions.m_weight.push_back(this->GetHitWeight(pCaloHit3D));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+float PCAShowerParticleBuildingAlgorithm::GetHitWeight(const CaloHit *const pCaloHit) const
+{
+    switch (m_hitWeighting)
+    {
+        case ENERGY_WEIGHT:
+            return pCaloHit->GetElectromagneticEnergy();
+        case MIP_WEIGHT:
+            return pCaloHit->GetMipEquivalentEnergy();
+        default:
+            return 1.f;
     }
+}
 
-    typedef std::pair<float,size_t> EigenValColPair;
-    typedef std::vector<EigenValColPair> EigenValColVector;
+//------------------------------------------------------------------------------------------------------------------------------------------
 
-    EigenValColVector eigenValColVector;
-    const auto &resultEigenMat(eigenMat.eigenvalues());
-    eigenValColVector.emplace_back(resultEigenMat(0), 0);
-    eigenValColVector.emplace_back(resultEigenMat(1), 1);
-    eigenValColVector.emplace_back(resultEigenMat(2), 2);
+bool PCAShowerParticleBuildingAlgorithm::AccumulateHits(const HitPositions &hitPositions, const size_t begin, const size_t end,
+    ShowerPCAAccumulator &accumulator) const
+{
+    // Fall back to unit weights if the hits carry no charge information
+    const bool useHitWeights((UNIT_WEIGHT != m_hitWeighting) &&
+        (std::accumulate(hitPositions.m_weight.begin() + begin, hitPositions.m_weight.begin() + end, 0.) > 0.));
 
-    std::sort(eigenValColVector.begin(), eigenValColVector.end(), [](const EigenValColPair &left, const EigenValColPair &right){return left.first > right.first;} );
+    if (useHitWeights)
+    {
+        accumulator.AddHits(hitPositions.m_x.data() + begin, hitPositions.m_y.data() + begin, hitPositions.m_z.data() + begin,
+            hitPositions.m_weight.data() + begin, end - begin);
+    }
+    else
+    {
+        accumulator.AddHits(hitPositions.m_x.data() + begin, hitPositions.m_y.data() + begin, hitPositions.m_z.data() + begin, end - begin);
+    }
 
-    // Now copy output
-    // Get the eigen values
-    outputEigenValues = CartesianVector(eigenValColVector.at(0).first, eigenValColVector.at(1).first, eigenValColVector.at(2).first);
+    return useHitWeights;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PCAShowerParticleBuildingAlgorithm::RunPCA(const HitPositions &hitPositions, const size_t begin, const size_t end,
+    const bool useHitWeights, ShowerPCAAccumulator &accumulator, std::ostream &messageStream, pandora::CartesianVector &centroid,
+    pandora::CartesianVector &outputEigenValues, EigenVectors &outputEigenVecs) const
+{
+    // The steps are:
+    // 1) take the mean position and the covariance matrix from the accumulator, filled in a single pass over the hits
+    // 2) run the eigen decomposition of the (symmetric) covariance matrix
+    // 3) extract the eigen vectors and values
+    if (0 == accumulator.GetNHits())
+    {
+        messageStream << "PCAShowerParticleBuildingAlgorithm::RunPCA - No three dimensional hit found!" << std::endl;
+        throw StatusCodeException(STATUS_CODE_NOT_FOUND);
+    }
+
+    centroid = accumulator.GetCentroid();
+    accumulator.Solve(m_doublePrecisionPCA, m_closedFormPCA, messageStream, outputEigenValues, outputEigenVecs);
+
+    if (m_trimmedPCAIterations > 0)
+        this->TrimOutliers(hitPositions, begin, end, useHitWeights, accumulator, messageStream, centroid, outputEigenValues,
+            outputEigenVecs);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
 
-    // Grab the principle axes
-    const Eigen::Matrix3f &eigenVecs(eigenMat.eigenvectors());
+void PCAShowerParticleBuildingAlgorithm::TrimOutliers(const HitPositions &hitPositions, const size_t begin, const size_t end,
+    const bool useHitWeights, ShowerPCAAccumulator &accumulator, std::ostream &messageStream, CartesianVector &centroid,
+    CartesianVector &outputEigenValues, EigenVectors &outputEigenVecs) const
+{
+    // Each iteration costs a single pass over the remaining hits, with the removed hits subtracted from the running sums
+    std::vector<bool> isRemoved(end - begin, false);
+    std::vector<size_t> outlierIndices;
 
-    for (const EigenValColPair &pair : eigenValColVector)
+    for (unsigned int iteration = 0; iteration < m_trimmedPCAIterations; ++iteration)
     {
-        outputEigenVecs.emplace_back(eigenVecs(0, pair.second), eigenVecs(1, pair.second), eigenVecs(2, pair.second));
+        const CartesianVector &secondaryAxis(outputEigenVecs.at(1)), &tertiaryAxis(outputEigenVecs.at(2));
+        // Axes without spread (e.g. for planar showers) cannot identify outliers
+        const float maxSecondary((outputEigenValues.GetY() > std::numeric_limits<float>::epsilon()) ?
+            m_trimmedPCANSigma * std::sqrt(outputEigenValues.GetY()) : std::numeric_limits<float>::max());
+        const float maxTertiary((outputEigenValues.GetZ() > std::numeric_limits<float>::epsilon()) ?
+            m_trimmedPCANSigma * std::sqrt(outputEigenValues.GetZ()) : std::numeric_limits<float>::max());
+
+        outlierIndices.clear();
+
+        for (size_t iHit = begin; iHit < end; ++iHit)
+        {
+            if (isRemoved.at(iHit - begin))
+                continue;
+
+            const float dx(hitPositions.m_x.at(iHit) - centroid.GetX());
+            const float dy(hitPositions.m_y.at(iHit) - centroid.GetY());
+            const float dz(hitPositions.m_z.at(iHit) - centroid.GetZ());
+            const float secondary(dx * secondaryAxis.GetX() + dy * secondaryAxis.GetY() + dz * secondaryAxis.GetZ());
+            const float tertiary(dx * tertiaryAxis.GetX() + dy * tertiaryAxis.GetY() + dz * tertiaryAxis.GetZ());
+
+            if ((std::fabs(secondary) > maxSecondary) || (std::fabs(tertiary) > maxTertiary))
+                outlierIndices.push_back(iHit);
+        }
+
+        if (outlierIndices.empty() || (accumulator.GetNHits() < m_trimmedPCAMinHits + outlierIndices.size()))
+            break;
+
+        for (const size_t iHit : outlierIndices)
+        {
+            const CartesianVector hitPosition(hitPositions.m_x.at(iHit), hitPositions.m_y.at(iHit), hitPositions.m_z.at(iHit));
+            accumulator.RemoveHit(hitPosition, useHitWeights ? hitPositions.m_weight.at(iHit) : 1.);
+            isRemoved.at(iHit - begin) = true;
+        }
+
+        if (accumulator.GetWeightSum() <= 0.)
+            throw StatusCodeException(STATUS_CODE_NOT_FOUND);
+
+        EigenVectors eigenVecs;
+        CartesianVector eigenValues(0.f, 0.f, 0.f);
+        accumulator.Solve(m_doublePrecisionPCA, m_closedFormPCA, messageStream, eigenValues, eigenVecs);
+
+        centroid = accumulator.GetCentroid();
+        outputEigenValues = eigenValues;
+        outputEigenVecs = eigenVecs;
     }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
-CartesianVector PCAShowerParticleBuildingAlgorithm::ShowerLength(const CartesianVector &eigenValues) const
+CartesianVector PCAShowerParticleBuildingAlgorithm::ShowerLength(const CartesianVector &eigenValues, std::ostream &messageStream) const
 {
     float sl[3] = {0.f, 0.f, 0.f};
 
@@ -252,7 +601,7 @@ CartesianVector PCAShowerParticleBuildingAlgorithm::ShowerLength(const Cartesian
     }
     else
     {
-        std::cout << "The principal eigenvalue is equal to or less than 0." << std::endl;
+        messageStream << "The principal eigenvalue is equal to or less than 0." << std::endl;
         throw StatusCodeException( STATUS_CODE_INVALID_PARAMETER );
     }
 
@@ -268,14 +617,14 @@ CartesianVector PCAShowerParticleBuildingAlgorithm::ShowerLength(const Cartesian
 //------------------------------------------------------------------------------------------------------------------------------------------
 
 float PCAShowerParticleBuildingAlgorithm::OpeningAngle(const CartesianVector &principal, const CartesianVector &secondary,
-    const CartesianVector &eigenValues) const
+    const CartesianVector &eigenValues, std::ostream &messageStream) const
 {
     const float principalMagnitude(principal.GetMagnitude());
     const float secondaryMagnitude(secondary.GetMagnitude());
 
     if (std::fabs(principalMagnitude) < std::numeric_limits<float>::epsilon())
     {
-        std::cout << "PCAShowerParticleBuildingAlgorithm::OpeningAngle - The principal eigenvector is 0." << std::endl;
+        messageStream << "PCAShowerParticleBuildingAlgorithm::OpeningAngle - The principal eigenvector is 0." << std::endl;
         throw StatusCodeException(STATUS_CODE_INVALID_PARAMETER);
     }
     else if (std::fabs(secondaryMagnitude) < std::numeric_limits<float>::epsilon())
@@ -287,7 +636,7 @@ float PCAShowerParticleBuildingAlgorithm::OpeningAngle(const CartesianVector &pr
 
     if (cosTheta > 1.f)
     {
-        std::cout << "PCAShowerParticleBuildingAlgorithm::OpeningAngle - cos(theta) reportedly greater than 1." << std::endl;
+        messageStream << "PCAShowerParticleBuildingAlgorithm::OpeningAngle - cos(theta) reportedly greater than 1." << std::endl;
         throw StatusCodeException(STATUS_CODE_INVALID_PARAMETER);
     }
 
@@ -295,7 +644,7 @@ float PCAShowerParticleBuildingAlgorithm::OpeningAngle(const CartesianVector &pr
 
     if (std::fabs(eigenValues.GetX()) < std::numeric_limits<float>::epsilon())
     {
-        std::cout << "PCAShowerParticleBuildingAlgorithm::OpeningAngle - principal eigenvalue less than or equal to 0." << std::endl;
+        messageStream << "PCAShowerParticleBuildingAlgorithm::OpeningAngle - principal eigenvalue less than or equal to 0." << std::endl;
         throw StatusCodeException( STATUS_CODE_INVALID_PARAMETER );
     }
     else if (std::fabs(eigenValues.GetY()) < std::numeric_limits<float>::epsilon())
@@ -308,6 +657,31 @@ float PCAShowerParticleBuildingAlgorithm::OpeningAngle(const CartesianVector &pr
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
+unsigned int PCAShowerParticleBuildingAlgorithm::ReserveThreads(const unsigned int nRequestedThreads)
+{
+    // The calling threads do their share of the work, so the extra threads of all instances are limited to one fewer than the cores
+    const unsigned int maxThreads(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    unsigned int nReservedThreads(m_nReservedThreads.load());
+    unsigned int nGrantedThreads(0);
+
+    do
+    {
+        nGrantedThreads = (nReservedThreads < maxThreads) ? std::min(nRequestedThreads, maxThreads - nReservedThreads) : 0;
+    }
+    while ((nGrantedThreads > 0) && !m_nReservedThreads.compare_exchange_weak(nReservedThreads, nReservedThreads + nGrantedThreads));
+
+    return nGrantedThreads;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void PCAShowerParticleBuildingAlgorithm::ReleaseThreads(const unsigned int nThreads)
+{
+    m_nReservedThreads -= nThreads;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
 StatusCode PCAShowerParticleBuildingAlgorithm::ReadSettings(const TiXmlHandle xmlHandle)
 {
     PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
@@ -316,6 +690,66 @@ StatusCode PCAShowerParticleBuildingAlgorithm::ReadSettings(const TiXmlHandle xm
     PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
         "LayerFitHalfWindow", m_layerFitHalfWindow));
 
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
+        "DoublePrecisionPCA", m_doublePrecisionPCA));
+
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
+        "ClosedFormPCA", m_closedFormPCA));
+
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
+        "BatchPCA", m_batchPCA));
+
+    // The input list name is also read by the base class, which requires it
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
+        "PfoListName", m_inputPfoListName));
+
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
+        "NShowerBuildingThreads", m_nShowerBuildingThreads));
+
+    std::string hitWeighting("None");
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
+        "HitWeighting", hitWeighting));
+
+    if ("None" == hitWeighting)
+    {
+        m_hitWeighting = UNIT_WEIGHT;
+    }
+    else if ("Energy" == hitWeighting)
+    {
+        m_hitWeighting = ENERGY_WEIGHT;
+    }
+    else if ("MipEquivalent" == hitWeighting)
+    {
+        m_hitWeighting = MIP_WEIGHT;
+    }
+    else
+    {
+        std::cout << "PCAShowerParticleBuildingAlgorithm::ReadSettings - Unknown HitWeighting " << hitWeighting
+                  << ", expected None, Energy or MipEquivalent" << std::endl;
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
+        "TrimmedPCAIterations", m_trimmedPCAIterations));
+
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
+        "TrimmedPCANSigma", m_trimmedPCANSigma));
+
+    PANDORA_RETURN_RESULT_IF_AND_IF(STATUS_CODE_SUCCESS, STATUS_CODE_NOT_FOUND, !=, XmlHelper::ReadValue(xmlHandle,
+        "TrimmedPCAMinHits", m_trimmedPCAMinHits));
+
+    if (m_trimmedPCANSigma <= 0.f)
+    {
+        std::cout << "PCAShowerParticleBuildingAlgorithm::ReadSettings - TrimmedPCANSigma must be positive" << std::endl;
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+
+    if (0 == m_nShowerBuildingThreads)
+    {
+        std::cout << "PCAShowerParticleBuildingAlgorithm::ReadSettings - NShowerBuildingThreads must be at least 1" << std::endl;
+        return STATUS_CODE_INVALID_PARAMETER;
+    }
+
     return CustomParticleCreationAlgorithm::ReadSettings(xmlHandle);
 }
 
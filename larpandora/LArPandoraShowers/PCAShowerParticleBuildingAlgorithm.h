@@ -12,6 +12,12 @@
 
 #include "larpandoracontent/LArCustomParticles/CustomParticleCreationAlgorithm.h"
 
+#include "larpandora/LArPandoraShowers/ShowerPCAAccumulator.h"
+
+#include <atomic>
+#include <iosfwd>
+#include <unordered_map>
+
 namespace lar_pandora_showers
 {
 
@@ -37,19 +43,267 @@ public:
 
 private:
     void CreatePfo(const pandora::ParticleFlowObject *const pInputPfo, const pandora::ParticleFlowObject *&pOutputPfo) const;
+    pandora::StatusCode Reset();
 
     typedef std::vector<pandora::CartesianVector> EigenVectors;
+    typedef std::vector<float> FloatVector;
+    typedef std::vector<size_t> OffsetVector;
+
+    /**
+     *  @brief  The weighting of the hits in the principal component analysis
+     */
+    enum HitWeighting
+    {
+        UNIT_WEIGHT,                                ///< Each hit has unit weight
+        ENERGY_WEIGHT,                              ///< Hits are weighted by their electromagnetic energy
+        MIP_WEIGHT                                  ///< Hits are weighted by their mip equivalent energy
+    };
+
+    /**
+     *  @brief  HitPositions class, a structure-of-arrays snapshot of the 3D hit positions
+     */
+    class HitPositions
+    {
+    public:
+        FloatVector     m_x;                        ///< The x coordinates
+        FloatVector     m_y;                        ///< The y coordinates
+        FloatVector     m_z;                        ///< The z coordinates
+        FloatVector     m_weight;                   ///< The hit weights
+    };
+
+    /**
+     *  @brief  ShowerPCA class, the principal component analysis of the 3D cluster of a shower candidate
+     */
+    class ShowerPCA
+    {
+    public:
+        /**
+         *  @brief  Default constructor
+         */
+        ShowerPCA();
+
+        pandora::StatusCode         m_statusCode;       ///< The outcome of the analysis
+        const pandora::Cluster     *m_pThreeDCluster;   ///< The address of the analysed 3D cluster
+        pandora::CartesianVector    m_centroid;         ///< The mean hit position
+        pandora::CartesianVector    m_eigenValues;      ///< The eigenvalues, in decreasing order
+        EigenVectors                m_eigenVecs;        ///< The corresponding eigenvectors
+    };
+
+    typedef std::unordered_map<const pandora::ParticleFlowObject*, ShowerPCA> ShowerPCAMap;
+
+    /**
+     *  @brief  ShowerParameters class, the shower properties derived from the 3D cluster of a shower candidate
+     */
+    class ShowerParameters
+    {
+    public:
+        /**
+         *  @brief  Default constructor
+         */
+        ShowerParameters();
+
+        ShowerPCA                   m_showerPCA;            ///< The principal component analysis
+        bool                        m_hasShowerLength;      ///< Whether the shower length could be calculated
+        pandora::CartesianVector    m_showerLength;         ///< The shower length along each principal axis
+        bool                        m_hasOpeningAngle;      ///< Whether the opening angle could be calculated
+        float                       m_openingAngle;         ///< The shower opening angle
+        bool                        m_hasLayerPositions;    ///< Whether the sliding fit could be calculated
+        pandora::CartesianVector    m_minLayerPosition;     ///< The position at the minimum layer of the sliding fit
+        pandora::CartesianVector    m_maxLayerPosition;     ///< The position at the maximum layer of the sliding fit
+    };
+
+    typedef std::unordered_map<const pandora::ParticleFlowObject*, ShowerParameters> ShowerParametersMap;
+
+    /**
+     *  @brief  Whether an input pfo should be used to build a shower
+     *
+     *  @param  pInputPfo the address of the input pfo
+     */
+    bool IsShowerCandidate(const pandora::ParticleFlowObject *const pInputPfo) const;
+
+    /**
+     *  @brief  Get the shower candidates in the input pfo list, together with their 3D clusters
+     *
+     *  @param  candidatePfos to receive the addresses of the candidate pfos, in input order
+     *  @param  candidateClusters to receive the addresses of the corresponding 3D clusters
+     */
+    void GetShowerCandidates(pandora::PfoVector &candidatePfos, pandora::ClusterVector &candidateClusters) const;
+
+    /**
+     *  @brief  Get the shower parameters of an input pfo, from the parallel results if enabled
+     *
+     *  @param  pInputPfo the address of the input pfo
+     *  @param  pThreeDCluster the address of the 3D cluster of the input pfo
+     *
+     *  @return the shower parameters, with a successful principal component analysis
+     */
+    ShowerParameters GetShowerParameters(const pandora::ParticleFlowObject *const pInputPfo, const pandora::Cluster *const pThreeDCluster) const;
+
+    /**
+     *  @brief  Calculate the shower parameters for all shower candidates in the input pfo list using concurrent tasks, storing the results
+     *          so that the pfos can then be created serially, in input order
+     */
+    void RunParallelShowerBuilding() const;
+
+    /**
+     *  @brief  Calculate the shower parameters that follow from a successful principal component analysis
+     *
+     *  @param  pThreeDCluster the address of the 3D cluster
+     *  @param  layerPitch the layer pitch for the sliding fit
+     *  @param  messageStream the stream to receive any messages
+     *  @param  showerParameters the shower parameters, holding the principal component analysis and to receive the derived parameters
+     */
+    void FillShowerParameters(const pandora::Cluster *const pThreeDCluster, const float layerPitch, std::ostream &messageStream,
+        ShowerParameters &showerParameters) const;
+
+    /**
+     *  @brief  Get the principal component analysis of the 3D cluster of an input pfo, from the batch results if enabled
+     *
+     *  @param  pInputPfo the address of the input pfo
+     *  @param  pThreeDCluster the address of the 3D cluster of the input pfo
+     *
+     *  @return the principal component analysis, with a successful status code
+     */
+    ShowerPCA GetShowerPCA(const pandora::ParticleFlowObject *const pInputPfo, const pandora::Cluster *const pThreeDCluster) const;
+
+    /**
+     *  @brief  Run the principal component analysis for all shower candidates in the input pfo list, gathering their hits into a single
+     *          buffer, accumulating the statistics of every candidate in one sweep over the buffer and storing the results in the batch map
+     */
+    void RunBatchPCA() const;
 
-    void RunPCA(const pandora::CaloHitList &threeDCaloHitList, pandora::CartesianVector &centroid, pandora::CartesianVector &outputEigenValues, EigenVectors &outputEigenVecs) const;
+    /**
+     *  @brief  Run the principal component analysis of a range of hit positions, recording the outcome rather than throwing
+     *
+     *  @param  hitPositions the hit positions
+     *  @param  begin the index of the first hit in the range
+     *  @param  end the index one past the last hit in the range
+     *  @param  pThreeDCluster the address of the 3D cluster providing the hits
+     *  @param  messageStream the stream to receive any messages
+     *  @param  showerPCA to receive the principal component analysis
+     */
+    void RunShowerPCA(const HitPositions &hitPositions, const size_t begin, const size_t end, const pandora::Cluster *const pThreeDCluster,
+        std::ostream &messageStream, ShowerPCA &showerPCA) const;
+
+    /**
+     *  @brief  Complete the principal component analysis of a range of hit positions, already added to an accumulator, recording the
+     *          outcome rather than throwing
+     *
+     *  @param  hitPositions the hit positions
+     *  @param  begin the index of the first hit in the range
+     *  @param  end the index one past the last hit in the range
+     *  @param  useHitWeights whether the hits were added to the accumulator with their weights, rather than unit weights
+     *  @param  accumulator the accumulator holding the hits
+     *  @param  pThreeDCluster the address of the 3D cluster providing the hits
+     *  @param  messageStream the stream to receive any messages
+     *  @param  showerPCA to receive the principal component analysis
+     */
+    void SolveShowerPCA(const HitPositions &hitPositions, const size_t begin, const size_t end, const bool useHitWeights,
+        ShowerPCAAccumulator &accumulator, const pandora::Cluster *const pThreeDCluster, std::ostream &messageStream,
+        ShowerPCA &showerPCA) const;
 
-    pandora::CartesianVector ShowerLength(const pandora::CartesianVector &eigenValues) const;
+    /**
+     *  @brief  Add a range of hit positions to an accumulator, using the hit weights unless the hits carry no charge information
+     *
+     *  @param  hitPositions the hit positions
+     *  @param  begin the index of the first hit in the range
+     *  @param  end the index one past the last hit in the range
+     *  @param  accumulator the accumulator to receive the hits
+     *
+     *  @return whether the hits were added with their weights, rather than unit weights
+     */
+    bool AccumulateHits(const HitPositions &hitPositions, const size_t begin, const size_t end, ShowerPCAAccumulator &accumulator) const;
 
-    float OpeningAngle(const pandora::CartesianVector &principal, const pandora::CartesianVector &secondary, const pandora::CartesianVector &eigenValues) const;
+    /**
+     *  @brief  Fill a contiguous snapshot of the positions of the (non-isolated) hits in a 3D cluster
+     *
+     *  @param  pCluster the address of the 3D cluster
+     *  @param  hitPositions to receive the hit positions
+     */
+    void FillHitPositions(const pandora::Cluster *const pCluster, HitPositions &hitPositions) const;
+
+    /**
+     *  @brief  Get the weight of a hit in the principal component analysis
+     *
+     *  @param  pCaloHit the address of the hit
+     */
+    float GetHitWeight(const pandora::CaloHit *const pCaloHit) const;
+
+    /**
+     *  @brief  Iteratively remove the hits lying beyond the configured number of standard deviations along the secondary and tertiary
+     *          axes, then recalculate the axes. Stops when no hits are removed, when too few hits would remain or after the maximum
+     *          number of iterations.
+     *
+     *  @param  hitPositions the hit positions
+     *  @param  begin the index of the first hit in the range
+     *  @param  end the index one past the last hit in the range
+     *  @param  useHitWeights whether the hits were added to the accumulator with their weights, rather than unit weights
+     *  @param  accumulator the accumulator holding the hits, to be updated as hits are removed
+     *  @param  messageStream the stream to receive any error messages
+     *  @param  centroid the mean hit position, to be updated
+     *  @param  outputEigenValues the eigenvalues, to be updated
+     *  @param  outputEigenVecs the eigenvectors, to be updated
+     */
+    void TrimOutliers(const HitPositions &hitPositions, const size_t begin, const size_t end, const bool useHitWeights,
+        ShowerPCAAccumulator &accumulator, std::ostream &messageStream, pandora::CartesianVector &centroid,
+        pandora::CartesianVector &outputEigenValues, EigenVectors &outputEigenVecs) const;
+
+    /**
+     *  @brief  Run the principal component analysis of a range of hit positions, already added to an accumulator
+     *
+     *  @param  hitPositions the hit positions
+     *  @param  begin the index of the first hit in the range
+     *  @param  end the index one past the last hit in the range
+     *  @param  useHitWeights whether the hits were added to the accumulator with their weights, rather than unit weights
+     *  @param  accumulator the accumulator holding the hits, to be updated if outliers are removed
+     *  @param  messageStream the stream to receive any messages
+     *  @param  centroid to receive the mean hit position
+     *  @param  outputEigenValues to receive the eigenvalues, in decreasing order
+     *  @param  outputEigenVecs to receive the corresponding eigenvectors
+     */
+    void RunPCA(const HitPositions &hitPositions, const size_t begin, const size_t end, const bool useHitWeights,
+        ShowerPCAAccumulator &accumulator, std::ostream &messageStream, pandora::CartesianVector &centroid,
+        pandora::CartesianVector &outputEigenValues, EigenVectors &outputEigenVecs) const;
+
+    pandora::CartesianVector ShowerLength(const pandora::CartesianVector &eigenValues, std::ostream &messageStream) const;
+
+    float OpeningAngle(const pandora::CartesianVector &principal, const pandora::CartesianVector &secondary, const pandora::CartesianVector &eigenValues,
+        std::ostream &messageStream) const;
+
+    /**
+     *  @brief  Reserve extra threads for the shower building tasks, from the budget shared by all instances of the algorithm
+     *
+     *  @param  nRequestedThreads the number of extra threads requested
+     *
+     *  @return the number of extra threads reserved, which may be fewer than requested
+     */
+    static unsigned int ReserveThreads(const unsigned int nRequestedThreads);
+
+    /**
+     *  @brief  Return extra threads to the budget shared by all instances of the algorithm
+     *
+     *  @param  nThreads the number of extra threads, as previously reserved
+     */
+    static void ReleaseThreads(const unsigned int nThreads);
 
     pandora::StatusCode ReadSettings(const pandora::TiXmlHandle xmlHandle);
 
     bool            m_cosmicMode;               ///<
     unsigned int    m_layerFitHalfWindow;       ///< 
+    bool            m_doublePrecisionPCA;       ///< Whether to diagonalise the covariance matrix in double, rather than float, precision
+    bool            m_closedFormPCA;            ///< Whether to diagonalise the covariance matrix with the closed-form 3x3 solver
+    bool            m_batchPCA;                 ///< Whether to run the analysis for all shower candidates at once, before creating the pfos
+    std::string     m_inputPfoListName;         ///< The name of the input pfo list, from which the batch of shower candidates is gathered
+    unsigned int    m_nShowerBuildingThreads;   ///< The number of concurrent tasks calculating the shower parameters (1: serial)
+    HitWeighting    m_hitWeighting;             ///< The weighting of the hits in the principal component analysis
+    unsigned int    m_trimmedPCAIterations;     ///< The maximum number of outlier removal iterations (0: no outlier removal)
+    float           m_trimmedPCANSigma;         ///< The number of standard deviations along the secondary axes beyond which hits are removed
+    unsigned int    m_trimmedPCAMinHits;        ///< The minimum number of hits to retain when removing outliers
+
+    mutable ShowerPCAMap        m_showerPCAMap;         ///< The batch results for the current event, keyed by input pfo
+    mutable ShowerParametersMap m_showerParametersMap;  ///< The parallel results for the current event, keyed by input pfo
+
+    static std::atomic<unsigned int> m_nReservedThreads;   ///< The number of extra threads in use by all instances of the algorithm
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------
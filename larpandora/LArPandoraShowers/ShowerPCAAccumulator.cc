@@ -0,0 +1,315 @@
+/**
+ *  @file   larpandora/LArPandoraShowers/ShowerPCAAccumulator.cc
+ *
+ *  @brief  Implementation of the shower principal component analysis accumulator class.
+ *
+ *  $Log: $
+ */
+
+#include "Pandora/StatusCodes.h"
+
+#include "larpandora/LArPandoraShowers/ShowerPCAAccumulator.h"
+
+#include <Eigen/Dense>
+
+#include <algorithm>
+
+using namespace pandora;
+
+namespace
+{
+
+/**
+ *  @brief  Diagonalise a covariance matrix, in the precision of the provided Eigen matrix type
+ *
+ *  @param  covariance the covariance matrix elements (xx, xy, xz, yy, yz, zz)
+ *  @param  closedForm whether to use the closed-form 3x3 solver, rather than the iterative solver
+ *  @param  nHits the number of hits, for error reporting
+ *  @param  messageStream the stream to receive any error messages
+ *  @param  outputEigenValues to receive the eigenvalues, in decreasing order
+ *  @param  outputEigenVecs to receive the corresponding eigenvectors
+ */
+template <typename MATRIX>
+void DiagonaliseCovariance(const double covariance[6], const bool closedForm, const unsigned int nHits, std::ostream &messageStream,
+    CartesianVector &outputEigenValues, lar_pandora_showers::ShowerPCAAccumulator::EigenVectors &outputEigenVecs)
+{
+    typedef typename MATRIX::Scalar Scalar;
+
+    // Using Eigen package
+    MATRIX sig;
+
+    sig << static_cast<Scalar>(covariance[0]), static_cast<Scalar>(covariance[1]), static_cast<Scalar>(covariance[2]),
+           static_cast<Scalar>(covariance[1]), static_cast<Scalar>(covariance[3]), static_cast<Scalar>(covariance[4]),
+           static_cast<Scalar>(covariance[2]), static_cast<Scalar>(covariance[4]), static_cast<Scalar>(covariance[5]);
+
+    Eigen::SelfAdjointEigenSolver<MATRIX> eigenMat;
+
+    if (closedForm)
+    {
+        eigenMat.computeDirect(sig);
+    }
+    else
+    {
+        eigenMat.compute(sig);
+    }
+
+    if (eigenMat.info() != Eigen::ComputationInfo::Success)
+    {
+        messageStream << "ShowerPCAAccumulator::Solve - PCA decompose failure, number of three D hits = " << nHits << std::endl;
+        throw StatusCodeException(STATUS_CODE_INVALID_PARAMETER);
+    }
+
+    typedef std::pair<float,size_t> EigenValColPair;
+    typedef std::vector<EigenValColPair> EigenValColVector;
+
+    EigenValColVector eigenValColVector;
+    const auto &resultEigenMat(eigenMat.eigenvalues());
+    eigenValColVector.emplace_back(resultEigenMat(0), 0);
+    eigenValColVector.emplace_back(resultEigenMat(1), 1);
+    eigenValColVector.emplace_back(resultEigenMat(2), 2);
+
+    std::sort(eigenValColVector.begin(), eigenValColVector.end(), [](const EigenValColPair &left, const EigenValColPair &right){return left.first > right.first;} );
+
+    // Now copy output
+    // Get the eigen values
+    outputEigenValues = CartesianVector(eigenValColVector.at(0).first, eigenValColVector.at(1).first, eigenValColVector.at(2).first);
+
+    // Grab the principle axes
+    const MATRIX &eigenVecs(eigenMat.eigenvectors());
+
+    for (const EigenValColPair &pair : eigenValColVector)
+    {
+        outputEigenVecs.emplace_back(eigenVecs(0, pair.second), eigenVecs(1, pair.second), eigenVecs(2, pair.second));
+    }
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+namespace lar_pandora_showers
+{
+
+ShowerPCAAccumulator::ShowerPCAAccumulator()
+{
+    this->Reset();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ShowerPCAAccumulator::AddHit(const CartesianVector &position, const double weight)
+{
+    const double x[3] = {position.GetX(), position.GetY(), position.GetZ()};
+    const double weightSum(m_weightSum + weight);
+    const double delta[3] = {x[0] - m_mean[0], x[1] - m_mean[1], x[2] - m_mean[2]};
+
+    for (unsigned int iAxis = 0; iAxis < 3; ++iAxis)
+        m_mean[iAxis] += delta[iAxis] * weight / weightSum;
+
+    // Welford update, using the deviations from the old and the new mean
+    const double newDelta[3] = {x[0] - m_mean[0], x[1] - m_mean[1], x[2] - m_mean[2]};
+    m_deviationSums[0] += weight * delta[0] * newDelta[0];
+    m_deviationSums[1] += weight * delta[0] * newDelta[1];
+    m_deviationSums[2] += weight * delta[0] * newDelta[2];
+    m_deviationSums[3] += weight * delta[1] * newDelta[1];
+    m_deviationSums[4] += weight * delta[1] * newDelta[2];
+    m_deviationSums[5] += weight * delta[2] * newDelta[2];
+
+    m_weightSum = weightSum;
+    ++m_nHits;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ShowerPCAAccumulator::RemoveHit(const CartesianVector &position, const double weight)
+{
+    if (0 == m_nHits)
+        throw StatusCodeException(STATUS_CODE_NOT_FOUND);
+
+    const double weightSum(m_weightSum - weight);
+
+    if ((1 == m_nHits) || (weightSum <= 0.))
+    {
+        this->Reset();
+        return;
+    }
+
+    // Inverse of the Welford update in AddHit
+    const double x[3] = {position.GetX(), position.GetY(), position.GetZ()};
+    const double oldDelta[3] = {x[0] - m_mean[0], x[1] - m_mean[1], x[2] - m_mean[2]};
+
+    for (unsigned int iAxis = 0; iAxis < 3; ++iAxis)
+        m_mean[iAxis] -= oldDelta[iAxis] * weight / weightSum;
+
+    const double delta[3] = {x[0] - m_mean[0], x[1] - m_mean[1], x[2] - m_mean[2]};
+    m_deviationSums[0] -= weight * delta[0] * oldDelta[0];
+    m_deviationSums[1] -= weight * delta[0] * oldDelta[1];
+    m_deviationSums[2] -= weight * delta[0] * oldDelta[2];
+    m_deviationSums[3] -= weight * delta[1] * oldDelta[1];
+    m_deviationSums[4] -= weight * delta[1] * oldDelta[2];
+    m_deviationSums[5] -= weight * delta[2] * oldDelta[2];
+
+    m_weightSum = weightSum;
+    --m_nHits;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ShowerPCAAccumulator::AddHits(const float *const pX, const float *const pY, const float *const pZ, const size_t nHits)
+{
+    // The hits are processed in blocks. Within a block, sums are taken relative to the first hit of the block, using independent lanes that
+    // the compiler can map onto vector registers. The block statistics are then merged into the running totals, which keeps the result
+    // stable for large, distant showers
+    static const size_t blockSize(256);
+    static const size_t nLanes(4);
+
+    for (size_t blockBegin = 0; blockBegin < nHits; blockBegin += blockSize)
+    {
+        const size_t blockEnd(std::min(blockBegin + blockSize, nHits));
+        const double refX(pX[blockBegin]), refY(pY[blockBegin]), refZ(pZ[blockBegin]);
+
+        double sx[nLanes] = {0.}, sy[nLanes] = {0.}, sz[nLanes] = {0.};
+        double sxx[nLanes] = {0.}, sxy[nLanes] = {0.}, sxz[nLanes] = {0.}, syy[nLanes] = {0.}, syz[nLanes] = {0.}, szz[nLanes] = {0.};
+
+        size_t iHit(blockBegin);
+
+        for (; iHit + nLanes <= blockEnd; iHit += nLanes)
+        {
+            for (size_t iLane = 0; iLane < nLanes; ++iLane)
+            {
+                const double x(pX[iHit + iLane] - refX), y(pY[iHit + iLane] - refY), z(pZ[iHit + iLane] - refZ);
+                sx[iLane] += x; sy[iLane] += y; sz[iLane] += z;
+                sxx[iLane] += x * x; sxy[iLane] += x * y; sxz[iLane] += x * z;
+                syy[iLane] += y * y; syz[iLane] += y * z; szz[iLane] += z * z;
+            }
+        }
+
+        for (; iHit < blockEnd; ++iHit)
+        {
+            const double x(pX[iHit] - refX), y(pY[iHit] - refY), z(pZ[iHit] - refZ);
+            sx[0] += x; sy[0] += y; sz[0] += z;
+            sxx[0] += x * x; sxy[0] += x * y; sxz[0] += x * z;
+            syy[0] += y * y; syz[0] += y * z; szz[0] += z * z;
+        }
+
+        for (size_t iLane = 1; iLane < nLanes; ++iLane)
+        {
+            sx[0] += sx[iLane]; sy[0] += sy[iLane]; sz[0] += sz[iLane];
+            sxx[0] += sxx[iLane]; sxy[0] += sxy[iLane]; sxz[0] += sxz[iLane];
+            syy[0] += syy[iLane]; syz[0] += syz[iLane]; szz[0] += szz[iLane];
+        }
+
+        // Block mean and sums of products of deviations from the block mean
+        const double nBlock(static_cast<double>(blockEnd - blockBegin));
+        const double blockMean[3] = {refX + sx[0] / nBlock, refY + sy[0] / nBlock, refZ + sz[0] / nBlock};
+        const double blockSums[6] = {sxx[0] - sx[0] * sx[0] / nBlock, sxy[0] - sx[0] * sy[0] / nBlock, sxz[0] - sx[0] * sz[0] / nBlock,
+            syy[0] - sy[0] * sy[0] / nBlock, syz[0] - sy[0] * sz[0] / nBlock, szz[0] - sz[0] * sz[0] / nBlock};
+
+        this->MergeStatistics(blockEnd - blockBegin, nBlock, blockMean, blockSums);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ShowerPCAAccumulator::AddHits(const float *const pX, const float *const pY, const float *const pZ, const float *const pWeight,
+    const size_t nHits)
+{
+    // As for unit weights, with sums of weighted deviations from the first hit of each block
+    static const size_t blockSize(256);
+
+    for (size_t blockBegin = 0; blockBegin < nHits; blockBegin += blockSize)
+    {
+        const size_t blockEnd(std::min(blockBegin + blockSize, nHits));
+        const double refX(pX[blockBegin]), refY(pY[blockBegin]), refZ(pZ[blockBegin]);
+
+        double sw(0.), sx(0.), sy(0.), sz(0.), sxx(0.), sxy(0.), sxz(0.), syy(0.), syz(0.), szz(0.);
+
+        for (size_t iHit = blockBegin; iHit < blockEnd; ++iHit)
+        {
+            const double w(pWeight[iHit]), x(pX[iHit] - refX), y(pY[iHit] - refY), z(pZ[iHit] - refZ);
+            sw += w;
+            sx += w * x; sy += w * y; sz += w * z;
+            sxx += w * x * x; sxy += w * x * y; sxz += w * x * z;
+            syy += w * y * y; syz += w * y * z; szz += w * z * z;
+        }
+
+        if (sw <= 0.)
+            continue;
+
+        const double blockMean[3] = {refX + sx / sw, refY + sy / sw, refZ + sz / sw};
+        const double blockSums[6] = {sxx - sx * sx / sw, sxy - sx * sy / sw, sxz - sx * sz / sw, syy - sy * sy / sw, syz - sy * sz / sw,
+            szz - sz * sz / sw};
+
+        this->MergeStatistics(blockEnd - blockBegin, sw, blockMean, blockSums);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ShowerPCAAccumulator::Merge(const ShowerPCAAccumulator &other)
+{
+    this->MergeStatistics(other.m_nHits, other.m_weightSum, other.m_mean, other.m_deviationSums);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ShowerPCAAccumulator::Reset()
+{
+    m_nHits = 0;
+    m_weightSum = 0.;
+    std::fill(m_mean, m_mean + 3, 0.);
+    std::fill(m_deviationSums, m_deviationSums + 6, 0.);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ShowerPCAAccumulator::Solve(const bool doublePrecision, const bool closedForm, std::ostream &messageStream,
+    CartesianVector &outputEigenValues, EigenVectors &outputEigenVecs) const
+{
+    if (m_weightSum <= 0.)
+    {
+        messageStream << "ShowerPCAAccumulator::Solve - No three dimensional hit found!" << std::endl;
+        throw StatusCodeException(STATUS_CODE_NOT_FOUND);
+    }
+
+    double covariance[6];
+
+    for (unsigned int iElement = 0; iElement < 6; ++iElement)
+        covariance[iElement] = m_deviationSums[iElement] / m_weightSum;
+
+    if (doublePrecision)
+    {
+        DiagonaliseCovariance<Eigen::Matrix3d>(covariance, closedForm, m_nHits, messageStream, outputEigenValues, outputEigenVecs);
+    }
+    else
+    {
+        DiagonaliseCovariance<Eigen::Matrix3f>(covariance, closedForm, m_nHits, messageStream, outputEigenValues, outputEigenVecs);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+void ShowerPCAAccumulator::MergeStatistics(const unsigned int nHits, const double weightSum, const double mean[3], const double deviationSums[6])
+{
+    if (weightSum <= 0.)
+        return;
+
+    const double totalWeightSum(m_weightSum + weightSum);
+    const double delta[3] = {mean[0] - m_mean[0], mean[1] - m_mean[1], mean[2] - m_mean[2]};
+    const double scale(m_weightSum * weightSum / totalWeightSum);
+
+    for (unsigned int iAxis = 0; iAxis < 3; ++iAxis)
+        m_mean[iAxis] += delta[iAxis] * weightSum / totalWeightSum;
+
+    m_deviationSums[0] += deviationSums[0] + delta[0] * delta[0] * scale;
+    m_deviationSums[1] += deviationSums[1] + delta[0] * delta[1] * scale;
+    m_deviationSums[2] += deviationSums[2] + delta[0] * delta[2] * scale;
+    m_deviationSums[3] += deviationSums[3] + delta[1] * delta[1] * scale;
+    m_deviationSums[4] += deviationSums[4] + delta[1] * delta[2] * scale;
+    m_deviationSums[5] += deviationSums[5] + delta[2] * delta[2] * scale;
+
+    m_weightSum = totalWeightSum;
+    m_nHits += nHits;
+}
+
+} // namespace lar_pandora_showers
@@ -0,0 +1,149 @@
+/**
+ *  @file   larpandora/LArPandoraShowers/ShowerPCAAccumulator.h
+ *
+ *  @brief  Header file for the shower principal component analysis accumulator class.
+ *
+ *  $Log: $
+ */
+#ifndef LAR_SHOWER_PCA_ACCUMULATOR_H
+#define LAR_SHOWER_PCA_ACCUMULATOR_H 1
+
+#include "Objects/CartesianVector.h"
+
+#include <ostream>
+#include <vector>
+
+namespace lar_pandora_showers
+{
+
+/**
+ *  @brief  ShowerPCAAccumulator class, holding the running weighted mean and covariance of a set of 3D hit positions, so that the principal
+ *          axes can be updated as hits are added or removed without revisiting the remaining hits
+ */
+class ShowerPCAAccumulator
+{
+public:
+    typedef std::vector<pandora::CartesianVector> EigenVectors;
+
+    /**
+     *  @brief  Default constructor
+     */
+    ShowerPCAAccumulator();
+
+    /**
+     *  @brief  Add a hit
+     *
+     *  @param  position the hit position
+     *  @param  weight the hit weight
+     */
+    void AddHit(const pandora::CartesianVector &position, const double weight = 1.);
+
+    /**
+     *  @brief  Remove a hit, previously added with the same position and weight
+     *
+     *  @param  position the hit position
+     *  @param  weight the hit weight
+     */
+    void RemoveHit(const pandora::CartesianVector &position, const double weight = 1.);
+
+    /**
+     *  @brief  Add a contiguous range of hits, each with unit weight, in a single numerically stable pass
+     *
+     *  @param  pX the address of the first x coordinate
+     *  @param  pY the address of the first y coordinate
+     *  @param  pZ the address of the first z coordinate
+     *  @param  nHits the number of hits
+     */
+    void AddHits(const float *const pX, const float *const pY, const float *const pZ, const size_t nHits);
+
+    /**
+     *  @brief  Add a contiguous range of weighted hits in a single numerically stable pass
+     *
+     *  @param  pX the address of the first x coordinate
+     *  @param  pY the address of the first y coordinate
+     *  @param  pZ the address of the first z coordinate
+     *  @param  pWeight the address of the first hit weight
+     *  @param  nHits the number of hits
+     */
+    void AddHits(const float *const pX, const float *const pY, const float *const pZ, const float *const pWeight, const size_t nHits);
+
+    /**
+     *  @brief  Merge the hits of another accumulator into this one
+     *
+     *  @param  other the other accumulator
+     */
+    void Merge(const ShowerPCAAccumulator &other);
+
+    /**
+     *  @brief  Remove all hits
+     */
+    void Reset();
+
+    /**
+     *  @brief  Get the number of hits
+     */
+    unsigned int GetNHits() const;
+
+    /**
+     *  @brief  Get the sum of the hit weights
+     */
+    double GetWeightSum() const;
+
+    /**
+     *  @brief  Get the weighted mean hit position
+     */
+    pandora::CartesianVector GetCentroid() const;
+
+    /**
+     *  @brief  Diagonalise the weighted covariance matrix of the hits
+     *
+     *  @param  doublePrecision whether to diagonalise in double, rather than float, precision
+     *  @param  closedForm whether to use the closed-form 3x3 solver, rather than the iterative solver
+     *  @param  messageStream the stream to receive any error messages
+     *  @param  outputEigenValues to receive the eigenvalues, in decreasing order
+     *  @param  outputEigenVecs to receive the corresponding eigenvectors
+     */
+    void Solve(const bool doublePrecision, const bool closedForm, std::ostream &messageStream, pandora::CartesianVector &outputEigenValues,
+        EigenVectors &outputEigenVecs) const;
+
+private:
+    /**
+     *  @brief  Merge the statistics of a set of hits into the running totals, using the pairwise update of Chan et al.
+     *
+     *  @param  nHits the number of hits in the set
+     *  @param  weightSum the sum of the hit weights in the set
+     *  @param  mean the weighted mean position of the set
+     *  @param  deviationSums the weighted sums of products of deviations from the mean of the set (xx, xy, xz, yy, yz, zz)
+     */
+    void MergeStatistics(const unsigned int nHits, const double weightSum, const double mean[3], const double deviationSums[6]);
+
+    unsigned int    m_nHits;                ///< The number of hits
+    double          m_weightSum;            ///< The sum of the hit weights
+    double          m_mean[3];              ///< The weighted mean position
+    double          m_deviationSums[6];     ///< The weighted sums of products of deviations from the mean (xx, xy, xz, yy, yz, zz)
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline unsigned int ShowerPCAAccumulator::GetNHits() const
+{
+    return m_nHits;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline double ShowerPCAAccumulator::GetWeightSum() const
+{
+    return m_weightSum;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+inline pandora::CartesianVector ShowerPCAAccumulator::GetCentroid() const
+{
+    return pandora::CartesianVector(m_mean[0], m_mean[1], m_mean[2]);
+}
+
+} // namespace lar_pandora_showers
+
+#endif // #ifndef LAR_SHOWER_PCA_ACCUMULATOR_H